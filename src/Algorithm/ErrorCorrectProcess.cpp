@@ -213,9 +213,6 @@ ErrorCorrectResult ErrorCorrectProcess::kmerCorrection(const SequenceWorkItem& w
 
     ErrorCorrectResult result;
 
-    typedef std::map<std::string, int> KmerCountMap;
-    KmerCountMap kmerCache;
-
     SeqRecord currRead = workItem.read;
     std::string readSequence = workItem.read.seq.toString();
 
@@ -256,43 +253,38 @@ ErrorCorrectResult ErrorCorrectProcess::kmerCorrection(const SequenceWorkItem& w
         minPhredVector[i] = minPhred;
     }
 
+    // The k-mer counts across the read. After a correction only
+    // the counts of the k-mers covering the corrected base are updated.
+    int k = m_params.kmerLength;
+    std::vector<size_t> countVector = BWTAlgorithms::countKmerProfile(readSequence, k, m_params.indices);
+    int correctedIdx = -1;
+
     while(!done && nk > 0)
     {
-        // Compute the kmer counts across the read
-        // and determine the positions in the read that are not covered by any solid kmers
+        if(correctedIdx >= 0)
+        {
+            int first = std::max(0, correctedIdx - k + 1);
+            int last = std::min(correctedIdx, nk - 1);
+            std::vector<size_t> counts = BWTAlgorithms::countKmerProfile(readSequence.substr(first, last - first + k), k, m_params.indices);
+            std::copy(counts.begin(), counts.end(), countVector.begin() + first);
+        }
+
+        // Determine the positions in the read that are not covered by any solid kmers
         // These are the candidate incorrect bases
-        std::vector<int> countVector(nk, 0);
         std::vector<int> solidVector(n, 0);
 
         for(int i = 0; i < nk; ++i)
         {
-            std::string kmer = readSequence.substr(i, m_params.kmerLength);
-
-            // First check if this kmer is in the cache
-            // If its not, find its count from the fm-index and cache it
-            int count = 0;
-            KmerCountMap::iterator iter = kmerCache.find(kmer);
-
-            if(iter != kmerCache.end())
-            {
-                count = iter->second;
-            }
-            else
-            {
-                count = BWTAlgorithms::countSequenceOccurrences(kmer, m_params.indices);
-                kmerCache.insert(std::make_pair(kmer, count));
-            }
-
             // Get the phred score for the last base of the kmer
             int phred = minPhredVector[i];
-            countVector[i] = count;
+            int count = countVector[i];
 //            std::cout << i << "\t" << phred << "\t" << count << "\n";
 
             // Determine whether the base is solid or not based on phred scores
             int threshold = CorrectionThresholds::Instance().getRequiredSupport(phred);
             if(count >= threshold)
             {
-                for(int j = i; j < i + m_params.kmerLength; ++j)
+                for(int j = i; j < i + k; ++j)
                     solidVector[j] = 1;
             }
         }
@@ -326,15 +318,21 @@ ErrorCorrectResult ErrorCorrectProcess::kmerCorrection(const SequenceWorkItem& w
                 int threshold = CorrectionThresholds::Instance().getRequiredSupport(phred);
 
                 int left_k_idx = (i + 1 >= m_params.kmerLength ? i + 1 - m_params.kmerLength : 0);
-                corrected = attemptKmerCorrection(i, left_k_idx, std::max(countVector[left_k_idx], threshold), readSequence);
+                corrected = attemptKmerCorrection(i, left_k_idx, std::max((int)countVector[left_k_idx], threshold), readSequence);
                 if(corrected)
+                {
+                    correctedIdx = i;
                     break;
+                }
 
                 // base was not corrected, try using the rightmost covering kmer
                 size_t right_k_idx = std::min(i, n - m_params.kmerLength);
-                corrected = attemptKmerCorrection(i, right_k_idx, std::max(countVector[right_k_idx], threshold), readSequence);
+                corrected = attemptKmerCorrection(i, right_k_idx, std::max((int)countVector[right_k_idx], threshold), readSequence);
                 if(corrected)
+                {
+                    correctedIdx = i;
                     break;
+                }
             }
         }
 
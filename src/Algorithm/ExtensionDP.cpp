@@ -22,16 +22,12 @@
 static const int MINUS_INF = -1073741823;
 static const int POSITIVE_INF = 1073741823;
 
-// Return the largest of the 3 values
-inline int max3(int a, int b, int c)
-{
-    return std::max(std::max(a,b), c);
-}
+static const int WORD_BITS = 64;
 
-// Return the smalleset of the 3 values
-inline int min3(int a, int b, int c)
+// Returns a word with the low n bits set, 0 <= n <= 64
+inline uint64_t lowBits(int n)
 {
-    return std::min(std::min(a,b), c);
+    return n >= WORD_BITS ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
 }
 
 // Constructor
@@ -45,7 +41,9 @@ BandedDPColumn::BandedDPColumn(int ci, int maxRows, int bandwidth, const BandedD
     m_maxRows = maxRows;
     assert(m_rowStartIdx <= m_rowEndIdx);
     int numRows = m_rowEndIdx - m_rowStartIdx + 1;
-    m_cells.resize(numRows);
+    m_numWords = (numRows + WORD_BITS - 1) / WORD_BITS;
+    m_words.resize(NUM_MASKS * m_numWords, 0);
+    m_startScore = 0;
 
     m_pPrevColumn = prevColumn;
 }
@@ -53,34 +51,53 @@ BandedDPColumn::BandedDPColumn(int ci, int maxRows, int bandwidth, const BandedD
 // Get the score for row
 int BandedDPColumn::getRowScore(int row) const
 {
-    int vec_idx = getVectorIndex(row);
-    if(vec_idx == -1)
+    if(row < m_rowStartIdx || row > m_rowEndIdx)
         return POSITIVE_INF;
-    else
-        return m_cells[vec_idx].score;
+
+    // Sum the vertical differences from the first row of the band to the requested row
+    int k = row - m_rowStartIdx;
+    int lastWord = k / WORD_BITS;
+    const uint64_t* pPv = getWords(PV_MASK);
+    const uint64_t* pMv = getWords(MV_MASK);
+    int score = m_startScore;
+    for(int w = 0; w < lastWord; ++w)
+        score += __builtin_popcountll(pPv[w]) - __builtin_popcountll(pMv[w]);
+    uint64_t mask = lowBits(k % WORD_BITS + 1);
+    return score + __builtin_popcountll(pPv[lastWord] & mask) - __builtin_popcountll(pMv[lastWord] & mask);
 }
 
 // Get the type of the row
 char BandedDPColumn::getRowType(int row) const
 {
-    int vec_idx = getVectorIndex(row);
-    if(vec_idx == -1)
+    if(row < m_rowStartIdx || row > m_rowEndIdx)
+        return FROM_M;
+
+    int k = row - m_rowStartIdx;
+    uint64_t bit = (uint64_t)1 << (k % WORD_BITS);
+    if(getWords(FROM_M_MASK)[k / WORD_BITS] & bit)
         return FROM_M;
+    else if(getWords(FROM_D_MASK)[k / WORD_BITS] & bit)
+        return FROM_D;
     else
-        return m_cells[vec_idx].ctype;
+        return FROM_I;
 }
 
 // Return the index of the best-scoring row
 int BandedDPColumn::getBestRowIndex() const
 {
-    int bestScore = POSITIVE_INF;
-    int bestIdx = -1;
-    for(int i = m_rowStartIdx; i <= m_rowEndIdx; ++i)
+    const uint64_t* pPv = getWords(PV_MASK);
+    const uint64_t* pMv = getWords(MV_MASK);
+
+    int score = m_startScore;
+    int bestScore = score;
+    int bestIdx = m_rowStartIdx;
+    for(int i = m_rowStartIdx + 1; i <= m_rowEndIdx; ++i)
     {
-        int s = getRowScore(i);
-        if(s < bestScore)
+        int k = i - m_rowStartIdx;
+        score += (int)((pPv[k / WORD_BITS] >> (k % WORD_BITS)) & 1) - (int)((pMv[k / WORD_BITS] >> (k % WORD_BITS)) & 1);
+        if(score < bestScore)
         {
-            bestScore = s;
+            bestScore = score;
             bestIdx = i;
         }
     }
@@ -94,72 +111,150 @@ const BandedDPColumn* BandedDPColumn::getPreviousColumn() const
     return m_pPrevColumn;
 }
 
-// Set the score and type for row 
-void BandedDPColumn::setRowScore(int row, int score, char ctype)
+//
+void BandedDPColumn::fillInitialColumn()
 {
-    int vec_idx = getVectorIndex(row);
-    if(vec_idx != -1)
-    {
-        m_cells[vec_idx].score = score;
-        m_cells[vec_idx].ctype = ctype;
-    }
+    assert(m_pPrevColumn == NULL && m_colIdx == 0 && m_rowStartIdx == 0);
+    m_startScore = 0;
+
+    // Every row is one greater than the row above 
+    int numRows = m_rowEndIdx - m_rowStartIdx + 1;
+    uint64_t* pPv = getWords(PV_MASK);
+    for(int w = 0; w < m_numWords; ++w)
+        pPv[w] = lowBits(numRows - w * WORD_BITS);
+    pPv[0] &= ~(uint64_t)1;
+
+    // The first row is a match, the rest are insertions
+    getWords(FROM_M_MASK)[0] = 1;
 }
 
-// Return the score for the requested cell
-int BandedDPColumn::getCellScore(int colIdx, int rowIdx) const
+// 
+uint64_t BandedDPColumn::getAlignedPrevWord(int mask, int w) const
 {
-    // If accessing the col/row with negative index, return
-    // the initial gap penalties. For now, we allow free gaps
-    // for the first row
-    if(colIdx == -1 || rowIdx == -1)
-        return 0;
-
-    const BandedDPColumn* pColumn;
-    if(colIdx < m_colIdx)
-        pColumn = m_pPrevColumn;
-    else
-        pColumn = this;
-    assert(pColumn != NULL);
-    
-    return pColumn->getRowScore(rowIdx);   
+    // The band moves down by at most one row per column
+    int shift = m_rowStartIdx - m_pPrevColumn->m_rowStartIdx;
+    const uint64_t* pPrev = m_pPrevColumn->getWords(mask);
+    int prevWords = m_pPrevColumn->m_numWords;
+
+    uint64_t word = w < prevWords ? pPrev[w] >> shift : 0;
+    if(shift > 0 && w + 1 < prevWords)
+        word |= pPrev[w + 1] << (WORD_BITS - shift);
+    return word;
 }
 
-// Calculate the score for the given row in the column using an edit distance scheme
-void BandedDPColumn::fillRowEditDistance(int rowIdx, int matchScore)
+// Fill in the column using the bit-parallel algorithm of Myers, 1999, 
+// computing a word of rows at a time (Hyyro, 2003). Cells outside of the band 
+// have infinite score. Rather than special-casing the first and last row of the band, 
+// we give the cell above the first row and the cell left of the last row scores that 
+// can never be on a best path. This gives exactly the scores of the row-by-row recurrence
+// score = min(diagonal + mismatch, above + 1, left + 1) restricted to the band.
+void BandedDPColumn::fillEditDistance(char b, const std::string& fixed)
 {
-    int vec_idx = getVectorIndex(rowIdx);
-    if(vec_idx == -1)
-        return; // out of band, ignore
+    assert(m_pPrevColumn != NULL && m_colIdx == m_pPrevColumn->m_colIdx + 1);
+    const BandedDPColumn* pPrev = m_pPrevColumn;
+    assert(m_rowStartIdx - pPrev->m_rowStartIdx <= 1);
+    assert(m_rowEndIdx >= pPrev->m_rowEndIdx);
 
-    // Get the scores for the cell above, to the left and diagonal
-    int above = getCellScore(m_colIdx, rowIdx - 1) + 1;
-    int diag = getCellScore(m_colIdx - 1, rowIdx - 1) + matchScore;
+    int numRows = m_rowEndIdx - m_rowStartIdx + 1;
     
-    // Give free insertions if the last row
-    // JS Apr/12 do not give free insertions in the last row
-    //int insert_score = rowIdx < (m_maxRows - 1) ? 1 : 0;
-    int insert_score = 1;
-    int left = getCellScore(m_colIdx - 1, rowIdx) + insert_score;
-    int score = min3(above, left, diag);
-
-    char ctype;
-    if(score == diag)
-        ctype = FROM_M;
-    else if(score == above)
-        ctype = FROM_D;
-    else
-        ctype = FROM_I;
-//    printf("Cell(%d, %d) a: %d d: %d l: %d s: %d t: %d\n", m_colIdx, rowIdx, above, diag, left, score, ctype);
-    setRowScore(rowIdx, score, ctype);
-}
+    // If the band grew, the first new row has no cell to its left. 
+    // Setting the vertical difference of the previous column to +1 
+    // in this row makes the left cell too expensive to be used.
+    // The band grows by more than one row when the query is longer
+    // than the query of the previous column. Any further new rows
+    // can only be reached from above, they are filled in below.
+    int extendedBit = m_rowEndIdx > pPrev->m_rowEndIdx ? pPrev->m_rowEndIdx + 1 - m_rowStartIdx : -1;
+
+    // The horizontal difference into the row above the band. When the band starts at
+    // row zero the previous column has the same first row, so we use a vertical difference 
+    // of zero above it (bit 0 of the previous column is never set) and no match. This gives the
+    // first row a score of colIdx, as required.
+    int hin = 1;
+    for(int w = 0; w < m_numWords; ++w)
+    {
+        // Build the match mask for this word
+        uint64_t eq = 0;
+        int firstBit = w * WORD_BITS;
+        int lastBit = std::min(numRows, firstBit + WORD_BITS);
+        for(int k = firstBit; k < lastBit; ++k)
+        {
+            int row = m_rowStartIdx + k;
+            if(row > 0 && fixed[row - 1] == b)
+                eq |= (uint64_t)1 << (k - firstBit);
+        }
 
-// Transform a row index into an index in the scores vector
-int BandedDPColumn::getVectorIndex(int rowIdx) const
-{
-    if(rowIdx < m_rowStartIdx || rowIdx > m_rowEndIdx)
-        return -1;
-    else
-        return rowIdx - m_rowStartIdx;
+        uint64_t pv = getAlignedPrevWord(PV_MASK, w);
+        uint64_t mv = getAlignedPrevWord(MV_MASK, w);
+        if(extendedBit >= firstBit && extendedBit < lastBit)
+        {
+            uint64_t bit = (uint64_t)1 << (extendedBit - firstBit);
+            pv |= bit;
+            mv &= ~bit;
+        }
+
+        // Compute the horizontal differences between the columns
+        uint64_t xv = eq | mv;
+        uint64_t xeq = hin < 0 ? eq | 1 : eq;
+        uint64_t xh = (((xeq & pv) + pv) ^ pv) | xeq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        int hout = (ph >> (WORD_BITS - 1)) ? 1 : ((mh >> (WORD_BITS - 1)) ? -1 : 0);
+
+        // A cell comes from the diagonal when the horizontal difference plus the 
+        // previous column's vertical difference equals the mismatch score
+        uint64_t pvs = pv & ~mv;
+        uint64_t zv = ~(pv | mv);
+        uint64_t zh = ~(ph | mh);
+        uint64_t sum0 = (ph & mv) | (mh & pvs) | (zh & zv);
+        uint64_t sum1 = (ph & zv) | (pvs & zh);
+        uint64_t from_m = (eq & sum0) | (~eq & sum1);
+
+        // Compute the vertical differences of this column
+        uint64_t phs = (ph << 1) | (hin > 0 ? 1 : 0);
+        uint64_t mhs = (mh << 1) | (hin < 0 ? 1 : 0);
+        uint64_t new_pv = mhs | ~(xv | phs);
+        uint64_t new_mv = phs & xv;
+
+        uint64_t valid = lowBits(lastBit - firstBit);
+        getWords(PV_MASK)[w] = new_pv & valid;
+        getWords(MV_MASK)[w] = new_mv & valid;
+        getWords(FROM_M_MASK)[w] = from_m & valid;
+
+        // A cell comes from above when it is one greater than the cell above, and not from the diagonal
+        getWords(FROM_D_MASK)[w] = new_pv & ~from_m & valid;
+        hin = hout;
+    }
+
+    if(extendedBit != -1)
+    {
+        for(int k = extendedBit + 1; k < numRows; ++k)
+        {
+            uint64_t bit = (uint64_t)1 << (k % WORD_BITS);
+            int w = k / WORD_BITS;
+            getWords(PV_MASK)[w] |= bit;
+            getWords(MV_MASK)[w] &= ~bit;
+            getWords(FROM_M_MASK)[w] &= ~bit;
+            getWords(FROM_D_MASK)[w] |= bit;
+        }
+    }
+
+    // The first row of the band is one greater than the row above the
+    // band in the previous column, plus its vertical difference
+    uint64_t* pPv = getWords(PV_MASK);
+    uint64_t* pMv = getWords(MV_MASK);
+    m_startScore = pPrev->m_startScore + 1 + (int)(pPv[0] & 1) - (int)(pMv[0] & 1);
+    pPv[0] &= ~(uint64_t)1;
+    pMv[0] &= ~(uint64_t)1;
+
+    // The first row has no cell above it
+    getWords(FROM_D_MASK)[0] &= ~(uint64_t)1;
+    if(m_rowStartIdx == 0)
+    {
+        // The first row of the matrix is a deletion
+        assert(m_startScore == m_colIdx);
+        getWords(FROM_M_MASK)[0] &= ~(uint64_t)1;
+        getWords(FROM_D_MASK)[0] |= 1;
+    }
 }
 
 // Initialize the extension DP by computing a global alignment between extendable and fixed
@@ -174,9 +269,7 @@ void ExtensionDP::createInitialAlignment(const std::string& extendable, const st
 
     // Set the score of column zero 
     BandedDPColumn* pZeroCol = new BandedDPColumn(0, numRows, bandwidth, NULL);
-    pZeroCol->setRowScore(0, 0, FROM_M);
-    for(size_t i = 1; i < numRows; ++i)
-        pZeroCol->setRowScore(i, i, FROM_I);
+    pZeroCol->fillInitialColumn();
 
     outPtrVec.push_back(pZeroCol);
     BandedDPColumn* pPrevCol = outPtrVec.back();
@@ -194,17 +287,7 @@ BandedDPColumn* ExtensionDP::createNewColumn(char b, const std::string& fixed, c
     int numRows = fixed.size() + 1;
     int colIdx = pPrevColumn->getColIdx() + 1;
     BandedDPColumn* pCurrCol = new BandedDPColumn(colIdx, numRows, pPrevColumn->getBandwidth(), pPrevColumn);
-
-    // Set the first row score
-    pCurrCol->setRowScore(0, colIdx, FROM_D);
-    
-    // Fill in the rest of the rows
-    int startRow = std::max(1, pCurrCol->getMinRow());
-    for(int rowIdx = startRow; rowIdx <= pCurrCol->getMaxRow(); ++rowIdx)
-    {
-        int match_score = b == fixed[rowIdx - 1] ? 0 : 1;
-        pCurrCol->fillRowEditDistance(rowIdx, match_score);
-    }
+    pCurrCol->fillEditDistance(b, fixed);
     return pCurrCol;
 }
 
@@ -17,18 +17,9 @@
 #define EXTENSION_DP_H
 
 #include <vector>
+#include <stdint.h>
 #include "StdAlnTools.h"
 
-// Structure holding the score for a single cell
-// of the DP matrix
-struct DPCell
-{
-    DPCell() : score(0), ctype('\0') {}
-    int score;
-    char ctype;
-};
-typedef std::vector<DPCell> CellVector;
-
 // Result object providing the coordinates
 // of the endpoints of the alignment
 struct ExtensionDPAlignment
@@ -38,7 +29,11 @@ struct ExtensionDPAlignment
 };
 
 // Core class providing a single column of the dynamic
-// programming matrix
+// programming matrix. The column is stored as a bit-parallel
+// edit distance vector (Myers, 1999). The score of the first row
+// of the band is stored explicitly and the remaining scores are encoded
+// by the +1/-1 differences between vertically adjacent cells. The
+// backtracking direction of each cell is stored as a pair of bit masks.
 class BandedDPColumn
 {
     public:
@@ -54,38 +49,57 @@ class BandedDPColumn
 
         int getRowScore(int row) const;
         char getRowType(int row) const;
-        int getCellScore(int colIdx, int rowIdx) const;
         int getMinRow() const { return m_rowStartIdx; }   
         int getMaxRow() const { return m_rowEndIdx; }
         int getQueryRows() const { return m_maxRows; }
 
         const BandedDPColumn* getPreviousColumn() const;
 
-        // Set the cell information for a given row in the column
-        void setRowScore(int row, int score, char ctype);
-        
         // Returns the row index of the best scoring cell
         int getBestRowIndex() const;
 
-        // Calculate and set the score for the row
-        void fillRowEditDistance(int rowIdx, int matchScore);
+        // Initialize the column as the first column of the matrix,
+        // the score of each row is its index
+        void fillInitialColumn();
+
+        // Calculate the edit distance scores of the column from the 
+        // previous column, aligning base b against the fixed string
+        void fillEditDistance(char b, const std::string& fixed);
 
     private:
         
         //
         // Functions
         //
-        int getVectorIndex(int rowIdx) const;
+        
+        // Returns the word of the bit vector for the given mask
+        uint64_t* getWords(int mask) { return &m_words[mask * m_numWords]; }
+        const uint64_t* getWords(int mask) const { return &m_words[mask * m_numWords]; }
+
+        // Returns word w of the previous column's mask, shifted
+        // so that bit k corresponds to row m_rowStartIdx + k of this column
+        uint64_t getAlignedPrevWord(int mask, int w) const;
 
         //
         // Data
         //
+        enum BitMask
+        {
+            PV_MASK = 0, // the score of the row is one greater than the row above
+            MV_MASK, // the score of the row is one less than the row above
+            FROM_M_MASK, // the best path into the cell comes from the diagonal
+            FROM_D_MASK, // the best path into the cell comes from above
+            NUM_MASKS
+        };
+
         int m_colIdx;
         int m_maxRows;
         int m_rowStartIdx;
         int m_rowEndIdx;
         int m_bandwidth;
-        CellVector m_cells;
+        int m_startScore; // the score of the first row in the band
+        int m_numWords; // the number of words per bit mask
+        std::vector<uint64_t> m_words;
         const BandedDPColumn* m_pPrevColumn;
 };
 typedef std::vector<BandedDPColumn*> BandedDPColumnPtrVector;
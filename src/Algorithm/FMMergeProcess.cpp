@@ -11,10 +11,12 @@
 #include "SGVisitors.h"
 
 //
-FMMergeProcess::FMMergeProcess(const OverlapAlgorithm* pOverlapper, int minOverlap, BitVector* pMarkedReads) : 
+FMMergeProcess::FMMergeProcess(const OverlapAlgorithm* pOverlapper, int minOverlap, 
+                               BitVector* pMarkedReads, BitVector* pClaimedReads) : 
                                      m_pOverlapper(pOverlapper), 
                                      m_minOverlap(minOverlap), 
-                                     m_pMarkedReads(pMarkedReads)
+                                     m_pMarkedReads(pMarkedReads),
+                                     m_pClaimedReads(pClaimedReads)
 {
 
 }
@@ -53,7 +55,14 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
         }
     }
 
+    // Claim the read by atomically setting the claim bit of the first index of its interval.
+    // If the bit is already set another thread is building the unipath containing
+    // the read, and that thread or its deferred read will output it.
+    if(!used && m_pClaimedReads != NULL && !m_pClaimedReads->updateCAS(readInterval.lower, false, true))
+        used = true;
+
     FMMergeResult result;
+    result.isDeferred = false;
 
     if(!used)
     {
@@ -68,6 +77,8 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
 
         // Add the root vertex to the result structure
         result.usedIntervals.push_back(readInterval);
+        std::set<int64_t> claimedIndices;
+        claimedIndices.insert(readInterval.lower);
 
         // Enqueue the read for overlap detection in both directions
         FMMergeQueue queue;
@@ -101,6 +112,15 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
             removeContainmentBlocks(currCandidate.pVertex->getSeqLen(), &candidateBlockList);
 
             bool validMergeNode = checkCandidate(currCandidate, &candidateBlockList);
+            if(validMergeNode && !claimInterval(currCandidate.interval, claimedIndices))
+            {
+                // Another thread is building this unipath. The claims are kept
+                // so that no other thread starts on this part of the unipath again
+                // and the read is deferred until the parallel computation is done.
+                result.isDeferred = true;
+                break;
+            }
+
             if(validMergeNode)
             {
                 addCandidates(pGraph, currCandidate.pVertex, currCandidate.pEdge, &candidateBlockList, queue);
@@ -113,6 +133,14 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
             }
         }
         
+        if(result.isDeferred)
+        {
+            result.usedIntervals.clear();
+            result.isMerged = false;
+            delete pGraph;
+            return result;
+        }
+
         // The graph has now been constructed. Remove all the nodes that are marked invalid for merging
         pGraph->sweepVertices(GC_RED);
 
@@ -202,6 +230,20 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
     return result;
 }
 
+// Claim the interval for the unipath being built. Returns false if another thread
+// has claimed it. claimedIndices holds the intervals already claimed for this unipath,
+// which can be reached again if the graph has a cycle.
+bool FMMergeProcess::claimInterval(const BWTInterval& interval, std::set<int64_t>& claimedIndices)
+{
+    if(m_pClaimedReads == NULL || claimedIndices.find(interval.lower) != claimedIndices.end())
+        return true;
+
+    if(!m_pClaimedReads->updateCAS(interval.lower, false, true))
+        return false;
+    claimedIndices.insert(interval.lower);
+    return true;
+}
+
 // Check if the candidate node can be merged with the node it is linked to. Returns true if so
 bool FMMergeProcess::checkCandidate(const FMMergeCandidate& candidate, const OverlapBlockList* pBlockList) const
 {
@@ -307,7 +349,12 @@ FMMergePostProcess::~FMMergePostProcess()
 //
 void FMMergePostProcess::process(const SequenceWorkItem& item, const FMMergeResult& result)
 {
-    (void)item;
+    if(result.isDeferred)
+    {
+        m_deferredItems.push_back(item);
+        return;
+    }
+
     m_numTotal += 1;
 
     if(result.isMerged)
@@ -9,6 +9,7 @@
 #ifndef FMMERGEPROCESS_H
 #define FMMERGEPROCESS_H
 
+#include <set>
 #include "Util.h"
 #include "OverlapAlgorithm.h"
 #include "SequenceProcessFramework.h"
@@ -21,6 +22,10 @@ struct FMMergeResult
     std::vector<std::string> mergedSequences;
     std::vector<BWTInterval> usedIntervals;
     bool isMerged;
+
+    // The merge was abandoned because another thread claimed part of
+    // the unipath. The read must be processed again.
+    bool isDeferred;
 };
 
 // A merge candidate is a read that is a unique extension
@@ -42,8 +47,12 @@ typedef std::queue<FMMergeCandidate> FMMergeQueue;
 class FMMergeProcess
 {
     public:
+        // pMarkedReads holds the reads that have been merged. When several threads
+        // merge reads at once, each claims the reads of the unipath it builds in
+        // pClaimedReads. If pClaimedReads is NULL there must only be a single thread.
         FMMergeProcess(const OverlapAlgorithm* pOverlapper, 
-                       int minOverlap, BitVector* pMarkedReads);
+                       int minOverlap, BitVector* pMarkedReads,
+                       BitVector* pClaimedReads);
 
         ~FMMergeProcess();
 
@@ -58,6 +67,9 @@ class FMMergeProcess
                            const OverlapBlockList* pBlockList, 
                            FMMergeQueue& candidateQueue);
 
+        // Claim the interval for the unipath being built
+        bool claimInterval(const BWTInterval& interval, std::set<int64_t>& claimedIndices);
+
         // Check whether the candidate can be merged into the current graph
         bool checkCandidate(const FMMergeCandidate& candidate, 
                             const OverlapBlockList* pBlockList) const;
@@ -68,6 +80,7 @@ class FMMergeProcess
         const OverlapAlgorithm* m_pOverlapper;
         const int m_minOverlap;
         BitVector* m_pMarkedReads;
+        BitVector* m_pClaimedReads;
 };
 
 // Write the results from the overlap step to an ASQG file
@@ -79,6 +92,11 @@ class FMMergePostProcess
         
         void process(const SequenceWorkItem& item, const FMMergeResult& result);
 
+        // The reads whose merge was abandoned. These must be processed
+        // again once the parallel computation is finished.
+        const std::vector<SequenceWorkItem>& getDeferredItems() const { return m_deferredItems; }
+        void clearDeferredItems() { m_deferredItems.clear(); }
+
     private:
         size_t m_numMerged;
         size_t m_numTotal;
@@ -86,6 +104,7 @@ class FMMergePostProcess
 
         std::ostream* m_pWriter;
         BitVector* m_pMarkedReads;
+        std::vector<SequenceWorkItem> m_deferredItems;
 };
 
 #endif
@@ -14,6 +14,14 @@
 #include "StdAlnTools.h"
 #include "HaplotypeBuilder.h"
 #include "MultiAlignment.h"
+#include "config.h"
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
+// The maximum distance from the gap that an anchor is searched for
+static const int64_t ANCHOR_MAX_DISTANCE = 50;
 
 //
 GapFillStats::GapFillStats()
@@ -52,11 +60,91 @@ GapFillProcess::~GapFillProcess()
 
 // Process the given scaffold, filling in any gaps found
 GapFillResult GapFillProcess::processScaffold(const std::string& scaffold) const
+{
+    StringVector scaffolds(1, scaffold);
+    GapFillResultVector results;
+    processScaffolds(scaffolds, results);
+    return results.front();
+}
+
+// The gaps are filled in two stages. First, every gap is attempted in parallel
+// using the sequence of the input scaffold before the gap as the left context.
+// Then the output scaffolds are built in order, accepting the result of a gap if the
+// output scaffold built so far ends with the same context. Otherwise, which can only
+// happen when the previous gap was filled nearby, the gap is attempted again.
+void GapFillProcess::processScaffolds(const StringVector& scaffolds, GapFillResultVector& results) const
+{
+    GapFillJobVector jobs;
+    for(size_t i = 0; i < scaffolds.size(); ++i)
+        findGaps(i, scaffolds[i], jobs);
+
+    size_t contextLength = getLeftContextLength();
+
+#if HAVE_OPENMP
+    omp_set_num_threads(m_parameters.numThreads);
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for(int64_t i = 0; i < (int64_t)jobs.size(); ++i)
+    {
+        GapFillJob& job = jobs[i];
+        const std::string& scaffold = scaffolds[job.scaffoldIdx];
+        size_t contextStart = job.gapStart > contextLength ? job.gapStart - contextLength : 0;
+        std::string leftContext = scaffold.substr(contextStart, job.gapStart - contextStart);
+        fillGap(leftContext, scaffold, job);
+    }
+
+    results.clear();
+    results.reserve(scaffolds.size());
+    GapFillJobVector::iterator jobIter = jobs.begin();
+    for(size_t i = 0; i < scaffolds.size(); ++i)
+    {
+        GapFillJobVector::iterator jobEnd = jobIter;
+        while(jobEnd != jobs.end() && jobEnd->scaffoldIdx == i)
+            ++jobEnd;
+        results.push_back(buildScaffold(scaffolds[i], jobIter, jobEnd));
+        jobIter = jobEnd;
+    }
+}
+
+// Find the runs of Ns in the scaffold
+void GapFillProcess::findGaps(size_t scaffoldIdx, const std::string& scaffold, GapFillJobVector& jobs) const
+{
+    size_t len = scaffold.length();
+    size_t currIdx = 0;
+    while(currIdx < len)
+    {
+        if(scaffold[currIdx] != 'N')
+        {
+            currIdx += 1;
+            continue;
+        }
+
+        GapFillJob job;
+        job.scaffoldIdx = scaffoldIdx;
+        job.gapStart = currIdx;
+        job.gapLength = 0;
+        while(currIdx < len && scaffold[currIdx] == 'N')
+        {
+            job.gapLength += 1;
+            currIdx += 1;
+        }
+        job.code = GFRC_UNKNOWN;
+        job.trimLength = 0;
+        job.nextIdx = currIdx;
+        jobs.push_back(job);
+    }
+}
+
+//
+GapFillResult GapFillProcess::buildScaffold(const std::string& scaffold, 
+                                            GapFillJobVector::iterator jobIter, 
+                                            GapFillJobVector::iterator jobEnd) const
 {
     if(m_parameters.verbose > 0)
         std::cout << "Processing scaffold of length " << scaffold.length() << "\n";
     
     GapFillResult result;
+    size_t contextLength = getLeftContextLength();
 
     size_t len = scaffold.length();
     size_t currIdx = 0;
@@ -72,57 +160,42 @@ GapFillResult GapFillProcess::processScaffold(const std::string& scaffold) const
         }
         else
         {
-            // Found the start of a gap
-            size_t gapLength = 0;
-            while(scaffold[currIdx + gapLength] == 'N')
-                gapLength += 1;
+            // Found the start of a gap. Gaps before this position may have been 
+            // skipped if a right anchor was found past them.
+            while(jobIter != jobEnd && jobIter->gapStart < currIdx)
+                ++jobIter;
+            assert(jobIter != jobEnd && jobIter->gapStart == currIdx);
+            GapFillJob& job = *jobIter;
 
             if(m_parameters.verbose >= 1)
-                printf("Constructing gap at position %zu GapLength: %zu\n", currIdx, gapLength);
-            
-            GapFillReturnCode code = GFRC_UNKNOWN;
-
-            // Attempt to fill this gap starting with a long kmer, then relaxing the process
-            for(size_t k = m_parameters.startKmer; k >= m_parameters.endKmer; k -= m_parameters.stride)
+                printf("Constructing gap at position %zu GapLength: %zu\n", currIdx, job.gapLength);
+
+            // Check that the gap was attempted with the same left context as the
+            // output scaffold has now
+            size_t outLength = result.scaffold.length();
+            size_t usedLength = std::min(job.gapStart, contextLength);
+            size_t currLength = std::min(outLength, contextLength);
+            if(usedLength != currLength || result.scaffold.compare(outLength - currLength, currLength, 
+                                                                   scaffold, job.gapStart - usedLength, usedLength) != 0)
             {
-                // Calculate the left-anchor using the sequence of the scaffold already appended
-                AnchorSequence leftAnchor = findAnchor(k, result.scaffold, result.scaffold.length() - k, true);
-
-                // Calculate the right anchor using the sequence of the input scaffold
-                AnchorSequence rightAnchor = findAnchor(k, scaffold, currIdx + gapLength, false);
-
-                // Estimate the size of the assembled sequence, including the flanking anchors
-                int leftFlanking = result.scaffold.length() - leftAnchor.position;
-                int rightFlankingPlusGap = rightAnchor.position + k - currIdx;
-                int estimatedSize = leftFlanking + rightFlankingPlusGap;
-
-                // Attempt to build the gap sequence
-                std::string gapSequence;
-                code = processGap(k, estimatedSize, leftAnchor, rightAnchor, gapSequence);
-
-                if(code == GFRC_OK)
-                {
-                    // Successfully resolved the gap. Calculate the amount of the anchor sequence
-                    // that is already present in the scaffold and must be removed. We remove this amount
-                    // of sequence from the current scaffold, not the gapSequence, to account
-                    // for the case that the gap sequence is significantly different than the sequence
-                    // after the left anchor. 
-                    size_t trimLength = result.scaffold.length() - leftAnchor.position;
-                    result.scaffold.replace(leftAnchor.position, trimLength, gapSequence);
-                        
-                    // We need to update currIdx to point to the next base in the 
-                    // input scaffold that is not already assembled. This is given
-                    // by the position of the rightAnchor, plus a kmer
-                    currIdx = rightAnchor.position + k;
-                    m_stats.numGapsFilled += 1;
-                    break; 
-                }
+                fillGap(result.scaffold.substr(outLength - currLength), scaffold, job);
             }
 
-            if(code != GFRC_OK)
+            if(job.code == GFRC_OK)
+            {
+                // Successfully resolved the gap. Remove the part of the anchor sequence
+                // that is already present in the scaffold and append the gap sequence.
+                // We remove this amount of sequence from the current scaffold, not the gapSequence, 
+                // to account for the case that the gap sequence is significantly different than the 
+                // sequence after the left anchor. 
+                result.scaffold.replace(outLength - job.trimLength, job.trimLength, job.sequence);
+                currIdx = job.nextIdx;
+                m_stats.numGapsFilled += 1;
+            }
+            else
             {
                 // Failed to resolve the gap. Append the gap into the growing scaffold
-                m_stats.numFails[code] += 1;
+                m_stats.numFails[job.code] += 1;
 
                 while(scaffold[currIdx] == 'N')
                 {
@@ -139,6 +212,49 @@ GapFillResult GapFillProcess::processScaffold(const std::string& scaffold) const
     return result;
 }
 
+// The left anchor is searched for in the final ANCHOR_MAX_DISTANCE + k bases
+// before the gap, so only this many bases of the output scaffold affect the result
+size_t GapFillProcess::getLeftContextLength() const
+{
+    return m_parameters.startKmer + ANCHOR_MAX_DISTANCE;
+}
+
+//
+void GapFillProcess::fillGap(const std::string& leftContext, const std::string& scaffold, GapFillJob& job) const
+{
+    job.code = GFRC_UNKNOWN;
+    job.sequence.clear();
+
+    // Attempt to fill this gap starting with a long kmer, then relaxing the process
+    for(size_t k = m_parameters.startKmer; k >= m_parameters.endKmer; k -= m_parameters.stride)
+    {
+        // Calculate the left-anchor using the sequence of the scaffold already appended
+        AnchorSequence leftAnchor = findAnchor(k, leftContext, leftContext.length() - k, true);
+
+        // Calculate the right anchor using the sequence of the input scaffold
+        AnchorSequence rightAnchor = findAnchor(k, scaffold, job.gapStart + job.gapLength, false);
+
+        // Estimate the size of the assembled sequence, including the flanking anchors
+        int leftFlanking = leftContext.length() - leftAnchor.position;
+        int rightFlankingPlusGap = rightAnchor.position + k - job.gapStart;
+        int estimatedSize = leftFlanking + rightFlankingPlusGap;
+
+        // Attempt to build the gap sequence
+        job.code = processGap(k, estimatedSize, leftAnchor, rightAnchor, job.sequence);
+
+        if(job.code == GFRC_OK)
+        {
+            // Calculate the amount of the anchor sequence that is already present in the scaffold.
+            // We need to update currIdx to point to the next base in the 
+            // input scaffold that is not already assembled. This is given
+            // by the position of the rightAnchor, plus a kmer
+            job.trimLength = leftContext.length() - leftAnchor.position;
+            job.nextIdx = rightAnchor.position + k;
+            break; 
+        }
+    }
+}
+
 // Fill in the specified gap
 GapFillReturnCode GapFillProcess::processGap(size_t k, int estimatedSize, const AnchorSequence& startAnchor, const AnchorSequence& endAnchor, std::string& outSequence) const
 {
@@ -191,8 +307,7 @@ AnchorSequence GapFillProcess::findAnchor(size_t k, const std::string& scaffold,
 {
     AnchorSequence anchor;
     int64_t stride = upstream ? -1 : 1;
-    int MAX_DISTANCE = 50;
-    int64_t stop = upstream ? position - MAX_DISTANCE : position + MAX_DISTANCE;
+    int64_t stop = upstream ? position - ANCHOR_MAX_DISTANCE : position + ANCHOR_MAX_DISTANCE;
 
     // Cap the travel distance to avoid out of bounds
     if(stop < 0)
@@ -233,7 +348,7 @@ GapFillReturnCode GapFillProcess::selectGapSequence(int estimatedSize, const Str
 
     for(size_t i = 0; i < sequences.size(); ++i)
     {
-        int diff = abs(sequences[i].size() - estimatedSize);
+        int diff = abs((int)sequences[i].size() - estimatedSize);
         //printf("ES: %d S: %zu D: %d\n", estimatedSize, sequences[i].size(), diff);
 
         if(diff < selectedSizeDiff)
@@ -39,6 +39,7 @@ struct GapFillParameters
     size_t stride;
     size_t kmerThreshold;
 
+    int numThreads;
     int verbose;
 };
 
@@ -47,6 +48,7 @@ struct GapFillResult
 {
     std::string scaffold;
 };
+typedef std::vector<GapFillResult> GapFillResultVector;
 
 enum GapFillReturnCode
 {
@@ -75,6 +77,22 @@ struct GapFillStats
     void print() const;
 };
 
+// The attempt to fill a single gap, the run of Ns at [gapStart, gapStart + gapLength)
+// of the input scaffold. If successful, the last trimLength bases of the output scaffold
+// are replaced by sequence and the input scaffold resumes at nextIdx.
+struct GapFillJob
+{
+    size_t scaffoldIdx;
+    size_t gapStart;
+    size_t gapLength;
+
+    GapFillReturnCode code;
+    size_t trimLength;
+    size_t nextIdx;
+    std::string sequence;
+};
+typedef std::vector<GapFillJob> GapFillJobVector;
+
 //
 //
 //
@@ -91,12 +109,34 @@ class GapFillProcess
         // Generate haplotypes from chromosome refName, position [start, end]
         GapFillResult processScaffold(const std::string& scaffold) const;
 
+        // Fill in the gaps of a batch of scaffolds. The gaps of all the scaffolds
+        // are attempted in parallel using numThreads threads. The results are the
+        // same as calling processScaffold on each scaffold in turn.
+        void processScaffolds(const StringVector& scaffolds, GapFillResultVector& results) const;
+
     private:
         
         //
         // Functions
         //
         
+        // Find the gaps of the scaffold, appending a job for each to the vector
+        void findGaps(size_t scaffoldIdx, const std::string& scaffold, GapFillJobVector& jobs) const;
+
+        // Attempt to fill in the gap of the job, trying each k from startKmer to endKmer. 
+        // leftContext is the end of the output scaffold built up to the gap, 
+        // at most getLeftContextLength() bases.
+        void fillGap(const std::string& leftContext, const std::string& scaffold, GapFillJob& job) const;
+
+        // Build the output scaffold from the results of the gap jobs, which are sorted by position.
+        // Jobs that were computed from a left context that differs from the output scaffold
+        // are recomputed.
+        GapFillResult buildScaffold(const std::string& scaffold, GapFillJobVector::iterator jobIter, 
+                                    GapFillJobVector::iterator jobEnd) const;
+
+        // Returns the number of bases before the gap that are used to find the left anchor
+        size_t getLeftContextLength() const;
+
         // Attempt to fill in the sequence between the two anchors
         GapFillReturnCode processGap(size_t k, 
                                      int estimatedSize,
@@ -0,0 +1,262 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// OverlapHitStore - Compact storage of the overlap
+// blocks found for each read.
+// See OverlapHitStore.h
+//
+#include <iostream>
+#include <zlib.h>
+#include <unistd.h>
+#include "OverlapHitStore.h"
+
+// The alignment flags are packed below the number of differences
+static const int FLAG_BITS = 3;
+static const uint64_t QUERYREV_FLAG = 1;
+static const uint64_t TARGETREV_FLAG = 2;
+static const uint64_t QUERYCOMP_FLAG = 4;
+
+// Map signed values to unsigned ones so that small
+// magnitudes give short varints
+static uint64_t zigzagEncode(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t zigzagDecode(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+//
+OverlapHitStore::OverlapHitStore(const std::string& spillFilename, size_t memoryBudget) : m_spillFilename(spillFilename),
+                                                                                          m_memoryBudget(memoryBudget),
+                                                                                          m_readPos(0),
+                                                                                          m_isReading(false),
+                                                                                          m_memoryBytes(0),
+                                                                                          m_pSpillFile(NULL),
+                                                                                          m_numRecords(0),
+                                                                                          m_rawBytes(0),
+                                                                                          m_compressedBytes(0),
+                                                                                          m_spilledBytes(0)
+{
+    m_buffer.reserve(OVERLAP_HIT_BLOCK_SIZE);
+}
+
+//
+OverlapHitStore::~OverlapHitStore()
+{
+    if(m_pSpillFile != NULL)
+    {
+        fclose(m_pSpillFile);
+        unlink(m_spillFilename.c_str());
+    }
+}
+
+// The interval sizes are stored rather than the upper
+// coordinates as they are much smaller
+void OverlapHitStore::addHits(size_t readIdx, bool isSubstring, const OverlapBlockList* pList)
+{
+    assert(!m_isReading);
+    writeVarint(readIdx);
+    writeVarint(((uint64_t)pList->size() << 1) | (isSubstring ? 1 : 0));
+
+    for(OverlapBlockList::const_iterator iter = pList->begin(); iter != pList->end(); ++iter)
+    {
+        for(int i = 0; i < 2; ++i)
+        {
+            const BWTInterval& interval = iter->ranges.interval[i];
+            writeVarint(zigzagEncode(interval.lower));
+            writeVarint(zigzagEncode(interval.upper - interval.lower));
+        }
+
+        assert(iter->overlapLen >= 0 && iter->numDiff >= 0);
+        uint64_t flags = (iter->flags.isQueryRev() ? QUERYREV_FLAG : 0) |
+                         (iter->flags.isTargetRev() ? TARGETREV_FLAG : 0) |
+                         (iter->flags.isQueryComp() ? QUERYCOMP_FLAG : 0);
+        writeVarint(iter->overlapLen);
+        writeVarint(((uint64_t)iter->numDiff << FLAG_BITS) | flags);
+    }
+
+    m_numRecords += 1;
+    if(m_buffer.size() >= OVERLAP_HIT_BLOCK_SIZE)
+        flushBlock();
+}
+
+//
+bool OverlapHitStore::readHits(size_t& readIdx, bool& isSubstring, OverlapBlockList& outList)
+{
+    if(!m_isReading)
+    {
+        flushBlock();
+        if(m_pSpillFile != NULL)
+            rewind(m_pSpillFile);
+        m_isReading = true;
+        m_buffer.clear();
+        m_readPos = 0;
+    }
+
+    if(m_readPos == m_buffer.size() && !loadNextBlock())
+        return false;
+
+    readIdx = readVarint();
+    uint64_t header = readVarint();
+    isSubstring = header & 1;
+    size_t numBlocks = header >> 1;
+
+    outList.clear();
+    for(size_t i = 0; i < numBlocks; ++i)
+    {
+        OverlapBlock block;
+        for(int j = 0; j < 2; ++j)
+        {
+            BWTInterval& interval = block.ranges.interval[j];
+            interval.lower = zigzagDecode(readVarint());
+            interval.upper = interval.lower + zigzagDecode(readVarint());
+        }
+
+        block.overlapLen = readVarint();
+        uint64_t packed = readVarint();
+        block.numDiff = packed >> FLAG_BITS;
+        block.flags = AlignFlags(packed & QUERYREV_FLAG, packed & TARGETREV_FLAG, packed & QUERYCOMP_FLAG);
+        block.isEliminated = false;
+        outList.push_back(block);
+    }
+    return true;
+}
+
+//
+void OverlapHitStore::flushBlock()
+{
+    if(m_buffer.empty())
+        return;
+
+    uLongf compressedSize = compressBound(m_buffer.size());
+    m_blocks.push_back(CompressedBlock());
+    CompressedBlock& block = m_blocks.back();
+    block.rawSize = m_buffer.size();
+    block.data.resize(compressedSize);
+
+    // The records are already compact so the fastest level is used
+    int ret = compress2(&block.data[0], &compressedSize, &m_buffer[0], m_buffer.size(), Z_BEST_SPEED);
+    if(ret != Z_OK)
+    {
+        std::cerr << "Error: could not compress overlap hits (zlib error " << ret << ")\n";
+        exit(EXIT_FAILURE);
+    }
+    block.data.resize(compressedSize);
+
+    m_rawBytes += m_buffer.size();
+    m_compressedBytes += compressedSize;
+    m_memoryBytes += compressedSize;
+    m_buffer.clear();
+
+    if(m_memoryBytes > m_memoryBudget)
+        spillBlocks();
+}
+
+// Each block is written as its uncompressed size and its
+// compressed size followed by the compressed data
+void OverlapHitStore::spillBlocks()
+{
+    if(m_pSpillFile == NULL)
+    {
+        m_pSpillFile = fopen(m_spillFilename.c_str(), "w+b");
+        if(m_pSpillFile == NULL)
+        {
+            std::cerr << "Error: could not open " << m_spillFilename << " to write overlap hits\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(CompressedBlockList::iterator iter = m_blocks.begin(); iter != m_blocks.end(); ++iter)
+    {
+        uint32_t header[2] = { iter->rawSize, (uint32_t)iter->data.size() };
+        if(fwrite(header, sizeof(header), 1, m_pSpillFile) != 1 ||
+           fwrite(&iter->data[0], iter->data.size(), 1, m_pSpillFile) != 1)
+        {
+            std::cerr << "Error: could not write overlap hits to " << m_spillFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        m_spilledBytes += iter->data.size();
+    }
+
+    m_blocks.clear();
+    m_memoryBytes = 0;
+}
+
+// The spilled blocks were added before the ones held
+// in memory so they are read first
+bool OverlapHitStore::loadNextBlock()
+{
+    CompressedBlock block;
+    uint32_t header[2];
+    if(m_pSpillFile != NULL && fread(header, sizeof(header), 1, m_pSpillFile) == 1)
+    {
+        block.rawSize = header[0];
+        block.data.resize(header[1]);
+        if(fread(&block.data[0], header[1], 1, m_pSpillFile) != 1)
+        {
+            std::cerr << "Error: truncated overlap hits file " << m_spillFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if(!m_blocks.empty())
+    {
+        block.rawSize = m_blocks.front().rawSize;
+        block.data.swap(m_blocks.front().data);
+        m_blocks.pop_front();
+    }
+    else
+    {
+        return false;
+    }
+
+    uLongf rawSize = block.rawSize;
+    m_buffer.resize(rawSize);
+    int ret = uncompress(&m_buffer[0], &rawSize, &block.data[0], block.data.size());
+    if(ret != Z_OK || rawSize != block.rawSize)
+    {
+        std::cerr << "Error: could not decompress overlap hits (zlib error " << ret << ")\n";
+        exit(EXIT_FAILURE);
+    }
+    m_readPos = 0;
+    return true;
+}
+
+//
+void OverlapHitStore::writeVarint(uint64_t v)
+{
+    while(v >= 0x80)
+    {
+        m_buffer.push_back((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    m_buffer.push_back(v);
+}
+
+//
+uint64_t OverlapHitStore::readVarint()
+{
+    uint64_t v = 0;
+    int shift = 0;
+    uint8_t byte;
+    do
+    {
+        assert(m_readPos < m_buffer.size());
+        byte = m_buffer[m_readPos++];
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while(byte & 0x80);
+    return v;
+}
+
+//
+void OverlapHitStore::printStats(const std::string& name) const
+{
+    double mb = 1024 * 1024;
+    printf("[%s] %zu hit records, %.2lf MB encoded, %.2lf MB compressed, %.2lf MB spilled to disk\n",
+           name.c_str(), m_numRecords, m_rawBytes / mb, m_compressedBytes / mb, m_spilledBytes / mb);
+}
@@ -0,0 +1,99 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// OverlapHitStore - Compact storage of the overlap
+// blocks found for each read during the overlap
+// computation.
+//
+// Each read is stored as a binary record of varints
+// holding the read index, the substring flag and,
+// for every block, its interval pair, overlap length,
+// number of differences and alignment flags. Records
+// are collected into blocks which are compressed with
+// zlib when full. The compressed blocks are kept in
+// memory until they exceed the memory budget of the
+// store, at which point they are appended to a spill
+// file on disk. The records are read back once, in
+// the order they were added.
+//
+// A store is written by a single thread.
+//
+#ifndef OVERLAPHITSTORE_H
+#define OVERLAPHITSTORE_H
+
+#include <stdio.h>
+#include "Util.h"
+#include "OverlapBlock.h"
+
+// The uncompressed size at which a block of records is compressed
+#define OVERLAP_HIT_BLOCK_SIZE (1024 * 1024)
+
+class OverlapHitStore
+{
+    public:
+
+        // Compressed blocks that do not fit in memoryBudget bytes
+        // are written to spillFilename.
+        OverlapHitStore(const std::string& spillFilename, size_t memoryBudget);
+        ~OverlapHitStore();
+
+        // Add the blocks of a read to the store
+        void addHits(size_t readIdx, bool isSubstring, const OverlapBlockList* pList);
+
+        // Read the next record. Only the fields used to construct
+        // overlaps are restored in the blocks.
+        // Returns false when all the records have been read.
+        bool readHits(size_t& readIdx, bool& isSubstring, OverlapBlockList& outList);
+
+        // Write the sizes of the stored data to stdout
+        void printStats(const std::string& name) const;
+
+    private:
+
+        // Not copyable
+        OverlapHitStore(const OverlapHitStore&);
+        OverlapHitStore& operator=(const OverlapHitStore&);
+
+        struct CompressedBlock
+        {
+            uint32_t rawSize;
+            std::vector<uint8_t> data;
+        };
+        typedef std::list<CompressedBlock> CompressedBlockList;
+
+        // Compress the pending records into a new block
+        void flushBlock();
+
+        // Write the blocks held in memory to the spill file
+        void spillBlocks();
+
+        // Load and decompress the next block into m_buffer
+        bool loadNextBlock();
+
+        // Varint encoding
+        void writeVarint(uint64_t v);
+        uint64_t readVarint();
+
+        std::string m_spillFilename;
+        size_t m_memoryBudget;
+
+        // Uncompressed records not yet in a block when
+        // writing, the decompressed block when reading
+        std::vector<uint8_t> m_buffer;
+        size_t m_readPos;
+        bool m_isReading;
+
+        CompressedBlockList m_blocks;
+        size_t m_memoryBytes;
+        FILE* m_pSpillFile;
+
+        // Statistics
+        size_t m_numRecords;
+        size_t m_rawBytes;
+        size_t m_compressedBytes;
+        size_t m_spilledBytes;
+};
+
+#endif
@@ -212,7 +212,7 @@ void StringGraphGenerator::resetContainmentFlags(Vertex* pVertex)
         return;
     pVertex->setContained(false);
     // Set the containment flag for all the vertices that have containment edges with this vertex
-    EdgePtrVec edges = pVertex->getEdges();
+    EdgePtrRange edges = pVertex->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
     {
         Edge* pEdge = edges[i];
@@ -173,7 +173,7 @@ void Bigraph::merge(Vertex* pV1, Edge* pEdge)
     assert(pV2->hasEdge(pTwin));
 
     // Get the edge set opposite of the twin edge (which will be the new edges in this direction for V1)
-    EdgePtrVec transEdges = pV2->getEdges(!pTwin->getDir());
+    EdgePtrVec transEdges = pV2->getEdges(!pTwin->getDir()).toVector();
 
     // Move the edges from pV2 to pV1
     for(EdgePtrVecIter iter = transEdges.begin(); iter != transEdges.end(); ++iter)
@@ -259,7 +259,7 @@ void Bigraph::simplify(EdgeDir dir)
         while(iter != m_vertices.end())
         {
             // Get the edges for this direction
-            EdgePtrVec edges = iter->second->getEdges(dir);
+            EdgePtrRange edges = iter->second->getEdges(dir);
 
             // If there is a single edge in this direction, merge the vertices
             // Don't merge singular self edges though
@@ -443,7 +443,7 @@ Path Bigraph::constructLinearPath(VertexID id)
 void Bigraph::followLinear(VertexID id, EdgeDir dir, Path& outPath)
 {
     Vertex* pVertex = getVertex(id);
-    EdgePtrVec edges = pVertex->getEdges(dir);
+    EdgePtrRange edges = pVertex->getEdges(dir);
 
     // Color the vertex
     pVertex->setColor(GC_BLACK);
@@ -657,8 +657,8 @@ void Bigraph::printMemSize() const
         ++numVerts;
         vertMem += iter->second->getMemSize();
 
-        EdgePtrVec edges = iter->second->getEdges();
-        for(EdgePtrVecIter edgeIter = edges.begin(); edgeIter != edges.end(); ++edgeIter)
+        EdgePtrRange edges = iter->second->getEdges();
+        for(EdgePtrRangeIter edgeIter = edges.begin(); edgeIter != edges.end(); ++edgeIter)
         {
             ++numEdges;
             edgeMem += (*edgeIter)->getMemSize();
@@ -723,8 +723,8 @@ void Bigraph::writeASQG(const std::string& filename) const
     // Edges
     for(iter = m_vertices.begin(); iter != m_vertices.end(); ++iter)
     {
-        EdgePtrVec edges = iter->second->getEdges();
-        for(EdgePtrVecIter edgeIter = edges.begin(); edgeIter != edges.end(); ++edgeIter)
+        EdgePtrRange edges = iter->second->getEdges();
+        for(EdgePtrRangeIter edgeIter = edges.begin(); edgeIter != edges.end(); ++edgeIter)
         {
             // We write one record for every bidirectional edge so only write edges
             // that are in canonical form (where id1 < id2)
@@ -74,6 +74,9 @@ void Vertex::merge(Edge* pEdge)
 
 void Vertex::validate() const
 {
+    for(size_t i = 0; i < m_edges.size(); ++i)
+        assert(m_edges[i]->getDir() == (i < getNumSenseEdges() ? ED_SENSE : ED_ANTISENSE));
+
     for(EdgePtrVecConstIter iter = m_edges.begin(); iter != m_edges.end(); ++iter)
     {
         (*iter)->validate();
@@ -96,17 +99,21 @@ void Vertex::validate() const
     }
 }
 
-//
+// The edges of each direction are sorted separately
 void Vertex::sortAdjListByID()
 {
     EdgeIDComp comp;
-    std::sort(m_edges.begin(), m_edges.end(), comp);
+    EdgePtrVecIter senseEnd = m_edges.begin() + getNumSenseEdges();
+    std::sort(m_edges.begin(), senseEnd, comp);
+    std::sort(senseEnd, m_edges.end(), comp);
 }
 
 void Vertex::sortAdjListByLen()
 {
     EdgeLenComp comp;
-    std::sort(m_edges.begin(), m_edges.end(), comp);
+    EdgePtrVecIter senseEnd = m_edges.begin() + getNumSenseEdges();
+    std::sort(m_edges.begin(), senseEnd, comp);
+    std::sort(senseEnd, m_edges.end(), comp);
 }
 
 // Mark duplicate edges with dupColor
@@ -124,27 +131,25 @@ bool Vertex::markDuplicateEdges(GraphColor dupColor)
 // Mark duplicate edges in the specified direction
 bool Vertex::markDuplicateEdges(EdgeDir dir, GraphColor dupColor)
 {
-    for(EdgePtrVecIter iter = m_edges.begin(); iter != m_edges.end(); ++iter)
+    EdgePtrRange edges = getEdges(dir);
+    for(EdgePtrRangeIter iter = edges.begin(); iter != edges.end(); ++iter)
     {
         Edge* pEdge = *iter;
-        if(pEdge->getDir() == dir)
+        Vertex* pY = pEdge->getEnd();
+        if(pY->getColor() == GC_BLACK)
         {
-            Vertex* pY = pEdge->getEnd();
-            if(pY->getColor() == GC_BLACK)
-            {
-                //std::cerr << getID() << " has a duplicate edge to " << pEdge->getEndID() << " in direction " << dir << "\n";
+            //std::cerr << getID() << " has a duplicate edge to " << pEdge->getEndID() << " in direction " << dir << "\n";
 
-                // This vertex is the endpoint of some other (potentially longer) edge
-                // Delete the edge
-                Edge* pTwin = pEdge->getTwin();
-                pTwin->setColor(dupColor);
-                pEdge->setColor(dupColor);
-            }
-            else
-            {
-                assert(pY->getColor() == GC_WHITE);
-                pY->setColor(GC_BLACK);
-            }
+            // This vertex is the endpoint of some other (potentially longer) edge
+            // Delete the edge
+            Edge* pTwin = pEdge->getTwin();
+            pTwin->setColor(dupColor);
+            pEdge->setColor(dupColor);
+        }
+        else
+        {
+            assert(pY->getColor() == GC_WHITE);
+            pY->setColor(GC_BLACK);
         }
     }
 
@@ -183,7 +188,16 @@ void Vertex::addEdge(Edge* ep)
         }
     }
 #endif
-    m_edges.push_back(ep);
+    if(ep->getDir() == ED_SENSE)
+    {
+        size_t numSense = getNumSenseEdges();
+        m_edges.insert(m_edges.begin() + numSense, ep);
+        setNumSenseEdges(numSense + 1);
+    }
+    else
+    {
+        m_edges.push_back(ep);
+    }
 }
 
 // Remove an edge from the edge list of the vertex
@@ -206,7 +220,7 @@ void Vertex::removeEdge(Edge* pEdge)
         ++iter;
     }
     assert(iter != m_edges.end());
-    m_edges.erase(iter);    
+    eraseEdge(iter);
 }
 
 //
@@ -218,7 +232,33 @@ void Vertex::removeEdge(const EdgeDesc& ed)
         std::cout << "EDGE NOT FOUND: " << ed << "\n";
     }
     assert(iter != m_edges.end());
-    m_edges.erase(iter);
+    eraseEdge(iter);
+}
+
+//
+EdgePtrVecIter Vertex::eraseEdge(EdgePtrVecIter iter)
+{
+    size_t numSense = getNumSenseEdges();
+    if((size_t)(iter - m_edges.begin()) < numSense)
+        setNumSenseEdges(numSense - 1);
+    return m_edges.erase(iter);
+}
+
+// The edges are partitioned by direction so the
+// first antisense edge can be found by binary search
+size_t Vertex::findNumSenseEdges() const
+{
+    size_t lower = 0;
+    size_t upper = m_edges.size();
+    while(lower < upper)
+    {
+        size_t mid = (lower + upper) / 2;
+        if(m_edges[mid]->getDir() == ED_SENSE)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+    return lower;
 }
 
 // Delete all the edges, and their twins, from this vertex
@@ -238,6 +278,7 @@ void Vertex::deleteEdges()
         *iter = NULL;
     }
     m_edges.clear();
+    m_numSenseEdges = 0;
 }
 
 // Delete edges that are marked
@@ -253,7 +294,7 @@ int Vertex::sweepEdges(GraphColor c)
         {
             delete pEdge;
             pEdge = NULL;
-            iter = m_edges.erase(iter);
+            iter = eraseEdge(iter);
             ++numRemoved;
         }
         else
@@ -263,9 +304,11 @@ int Vertex::sweepEdges(GraphColor c)
 }
 
 // Return the iterator to the edge matching edgedesc
+// Only the edges in the direction of the description are searched
 EdgePtrVecIter Vertex::findEdge(const EdgeDesc& ed)
 {
-    for(EdgePtrVecIter iter = m_edges.begin(); iter != m_edges.end(); ++iter)
+    EdgePtrVecIter end = m_edges.begin() + getEdgesEnd(ed.dir);
+    for(EdgePtrVecIter iter = m_edges.begin() + getEdgesBegin(ed.dir); iter != end; ++iter)
     {
         if((*iter)->getDesc() == ed)
             return iter;
@@ -276,7 +319,8 @@ EdgePtrVecIter Vertex::findEdge(const EdgeDesc& ed)
 //
 EdgePtrVecConstIter Vertex::findEdge(const EdgeDesc& ed) const
 {
-    for(EdgePtrVecConstIter iter = m_edges.begin(); iter != m_edges.end(); ++iter)
+    EdgePtrVecConstIter end = m_edges.begin() + getEdgesEnd(ed.dir);
+    for(EdgePtrVecConstIter iter = m_edges.begin() + getEdgesBegin(ed.dir); iter != end; ++iter)
     {
         if((*iter)->getDesc() == ed)
             return iter;
@@ -335,12 +379,9 @@ Edge* Vertex::getLongestOverlapEdge(EdgeDir dir) const
 {
     Edge* pOut = NULL;
     int maxOL = 0;
-    EdgePtrVecConstIter iter = m_edges.begin();
-    for(; iter != m_edges.end(); ++iter)
+    EdgePtrRange edges = getEdges(dir);
+    for(EdgePtrRangeIter iter = edges.begin(); iter != edges.end(); ++iter)
     {
-        if((*iter)->getDir() != dir)
-            continue;
-
         int currOL = (*iter)->getMatchLength();
         if(currOL > maxOL)
         {
@@ -356,24 +397,22 @@ Edge* Vertex::getLongestOverlapEdge(EdgeDir dir) const
 // Get the edges in a particular direction
 // This preserves the ordering of the edges
 //
-EdgePtrVec Vertex::getEdges(EdgeDir dir) const
+EdgePtrRange Vertex::getEdges(EdgeDir dir) const
 {
-    EdgePtrVecConstIter iter = m_edges.begin();
-    EdgePtrVec outEdges;
-    for(; iter != m_edges.end(); ++iter)
-    {
-        if((*iter)->getDir() == dir)
-            outEdges.push_back(*iter);
-    }
-    return outEdges;
+    size_t begin = getEdgesBegin(dir);
+    size_t end = getEdgesEnd(dir);
+    if(begin == end)
+        return EdgePtrRange();
+    return EdgePtrRange(&m_edges[0] + begin, &m_edges[0] + end);
 }
 
 
-// Get the edges
-EdgePtrVec Vertex::getEdges() const
+// Get the edges, the sense edges are first
+EdgePtrRange Vertex::getEdges() const
 {
-    EdgePtrVec outEdges(m_edges.begin(), m_edges.end());
-    return outEdges;    
+    if(m_edges.empty())
+        return EdgePtrRange();
+    return EdgePtrRange(&m_edges[0], &m_edges[0] + m_edges.size());
 }
 
 void Vertex::setEdgeColors(GraphColor c) 
@@ -390,10 +429,9 @@ size_t Vertex::countEdges() const
 }
 
 //
-size_t Vertex::countEdges(EdgeDir dir)
+size_t Vertex::countEdges(EdgeDir dir) const
 {
-    EdgePtrVec ev = getEdges(dir);
-    return ev.size();
+    return getEdgesEnd(dir) - getEdgesBegin(dir);
 }
 
 // Calculate the difference in overlap lengths between
@@ -402,12 +440,9 @@ int Vertex::getOverlapLengthDiff(EdgeDir dir) const
 {
     int longest_len = 0;
     int second_longest_len = 0;
-    EdgePtrVecConstIter iter = m_edges.begin();
-    for(; iter != m_edges.end(); ++iter)
+    EdgePtrRange edges = getEdges(dir);
+    for(EdgePtrRangeIter iter = edges.begin(); iter != edges.end(); ++iter)
     {
-        if((*iter)->getDir() != dir)
-            continue;
-
         int currOL = (*iter)->getMatchLength();
         if(currOL > longest_len)
         {
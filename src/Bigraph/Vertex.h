@@ -18,6 +18,7 @@
 #include <ostream>
 #include <iostream>
 #include <iterator>
+#include <algorithm>
 #include "GraphCommon.h"
 #include "QualityVector.h"
 #include "EncodedString.h"
@@ -53,15 +54,47 @@ typedef EdgePtrVec::const_iterator EdgePtrVecConstIter;
 typedef EdgePtrList::iterator EdgePtrListIter;
 typedef EdgePtrList::const_iterator EdgePtrListConstIter;
 
+// A view of a contiguous run of the edges of a vertex.
+// The view is invalidated when an edge is added to or
+// removed from the vertex. Callers that change the edges
+// while iterating must copy the range with toVector().
+class EdgePtrRange
+{
+    public:
+        typedef Edge* const* const_iterator;
+
+        EdgePtrRange() : m_pBegin(NULL), m_pEnd(NULL) {}
+        EdgePtrRange(const_iterator pBegin, const_iterator pEnd) : m_pBegin(pBegin), m_pEnd(pEnd) {}
+
+        const_iterator begin() const { return m_pBegin; }
+        const_iterator end() const { return m_pEnd; }
+        size_t size() const { return m_pEnd - m_pBegin; }
+        bool empty() const { return m_pBegin == m_pEnd; }
+        Edge* operator[](size_t i) const { return m_pBegin[i]; }
+        Edge* front() const { return *m_pBegin; }
+        Edge* back() const { return *(m_pEnd - 1); }
+
+        EdgePtrVec toVector() const { return EdgePtrVec(m_pBegin, m_pEnd); }
+
+    private:
+        const_iterator m_pBegin;
+        const_iterator m_pEnd;
+};
+typedef EdgePtrRange::const_iterator EdgePtrRangeIter;
+
 class Vertex
 {
     public:
+
+        // The type returned by getEdges
+        typedef EdgePtrRange EdgeRange;
     
         Vertex(VertexID id, const std::string& s) : m_id(id), 
                                                     m_seq(s), 
                                                     m_color(GC_WHITE),
                                                     m_coverage(1),
-                                                    m_isContained(false) {}
+                                                    m_isContained(false),
+                                                    m_numSenseEdges(0) {}
         ~Vertex();
 
         // High-level modification functions
@@ -95,14 +128,14 @@ class Vertex
 
         Edge* getEdge(const EdgeDesc& ed);
         EdgePtrVec findEdgesTo(VertexID id);
-        EdgePtrVec getEdges(EdgeDir dir) const;
-        EdgePtrVec getEdges() const;
+        EdgePtrRange getEdges(EdgeDir dir) const;
+        EdgePtrRange getEdges() const;
         EdgePtrVecIter findEdge(const EdgeDesc& ed);
         EdgePtrVecConstIter findEdge(const EdgeDesc& ed) const;
         Edge* getLongestOverlapEdge(EdgeDir dir) const;
 
         size_t countEdges() const;
-        size_t countEdges(EdgeDir dir);
+        size_t countEdges(EdgeDir dir) const;
 
         // Calculate the difference in overlap lengths between
         // the longest and second longest edge
@@ -157,7 +190,27 @@ class Vertex
         // Ensure all the edges in DIR are unique
         bool markDuplicateEdges(EdgeDir dir, GraphColor dupColor);
 
+        // The positions in m_edges of the edges in a direction
+        size_t getEdgesBegin(EdgeDir dir) const { return dir == ED_SENSE ? 0 : getNumSenseEdges(); }
+        size_t getEdgesEnd(EdgeDir dir) const { return dir == ED_SENSE ? getNumSenseEdges() : m_edges.size(); }
+
+        // The number of sense edges. The count is only stored up to
+        // SENSE_EDGES_SATURATED, larger counts are searched for.
+        size_t getNumSenseEdges() const
+        {
+            return m_numSenseEdges != SENSE_EDGES_SATURATED ? m_numSenseEdges : findNumSenseEdges();
+        }
+        size_t findNumSenseEdges() const;
+        void setNumSenseEdges(size_t n) { m_numSenseEdges = std::min(n, (size_t)SENSE_EDGES_SATURATED); }
+        static const uint16_t SENSE_EDGES_SATURATED = 0xFFFF;
+
+        // Remove the edge at iter, keeping the partition of the edges
+        EdgePtrVecIter eraseEdge(EdgePtrVecIter iter);
+
         VertexID m_id;
+
+        // The sense edges are stored before the antisense edges.
+        // Within a direction the edges are in the order they were added.
         EdgePtrVec m_edges;
         DNAEncodedString m_seq;
         GraphColor m_color;
@@ -167,6 +220,9 @@ class Vertex
 
         bool m_isContained;
         bool m_isSuperRepeat;
+
+        // Fits in the padding after the flags
+        uint16_t m_numSenseEdges;
 };
 
 #endif
@@ -4,20 +4,107 @@
 // Released under the GPL
 //-----------------------------------------------
 //
-// Implementation of a multikey quicksort worker thread
+// Implementation of a multikey quicksort worker thread.
+// Each thread owns a deque of sort jobs. It pushes and
+// pops jobs at the back of its own deque and, when that
+// is empty, steals the oldest (largest) job from the front
+// of another thread's deque.
 //
 #include <pthread.h>
-#include <semaphore.h>
+#include <sched.h>
+#include <deque>
+#include <vector>
 #include "mkqs.h"
 
-// 
+//
 template<typename T>
 struct MkqsJob
 {
-    MkqsJob(T* p, int num, int d) : pData(p), n(num), depth(d) {}
+    MkqsJob() : pData(NULL), n(0), depth(0), bFinalOnly(false) {}
+    MkqsJob(T* p, int num, int d, bool finalOnly = false) : pData(p), n(num), depth(d), bFinalOnly(finalOnly) {}
     T* pData;
     int n;
     int depth;
+
+    // If true, the elements are equal under the primary sorter
+    // and only need to be ordered by the final sorter
+    bool bFinalOnly;
+};
+
+// Order jobs by decreasing size
+template<typename T>
+struct MkqsJobSizeCompare
+{
+    bool operator()(const MkqsJob<T>& a, const MkqsJob<T>& b) const
+    {
+        return a.n > b.n;
+    }
+};
+
+// A deque of jobs guarded by a mutex. The owning thread
+// works at the back, thieves take from the front.
+template<typename T>
+class MkqsJobDeque
+{
+    typedef MkqsJob<T> Job;
+
+    public:
+        MkqsJobDeque()
+        {
+            int ret = pthread_mutex_init(&m_mutex, NULL);
+            if(ret != 0)
+            {
+                std::cerr << "Mutex initialization failed with error " << ret << ", aborting" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        ~MkqsJobDeque()
+        {
+            int ret = pthread_mutex_destroy(&m_mutex);
+            if(ret != 0)
+            {
+                std::cerr << "Mutex destruction failed with error " << ret << ", aborting" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        void push(const Job& job)
+        {
+            pthread_mutex_lock(&m_mutex);
+            m_jobs.push_back(job);
+            pthread_mutex_unlock(&m_mutex);
+        }
+
+        bool popBack(Job& job)
+        {
+            pthread_mutex_lock(&m_mutex);
+            bool found = !m_jobs.empty();
+            if(found)
+            {
+                job = m_jobs.back();
+                m_jobs.pop_back();
+            }
+            pthread_mutex_unlock(&m_mutex);
+            return found;
+        }
+
+        bool stealFront(Job& job)
+        {
+            pthread_mutex_lock(&m_mutex);
+            bool found = !m_jobs.empty();
+            if(found)
+            {
+                job = m_jobs.front();
+                m_jobs.pop_front();
+            }
+            pthread_mutex_unlock(&m_mutex);
+            return found;
+        }
+
+    private:
+        std::deque<Job> m_jobs;
+        pthread_mutex_t m_mutex;
 };
 
 //
@@ -25,26 +112,26 @@ template<typename T, class PrimarySorter, class FinalSorter>
 class MkqsThread
 {
     typedef MkqsJob<T> Job;
-    typedef std::queue<Job> JobQueue;
+    typedef MkqsJobDeque<T> JobDeque;
+    typedef std::vector<JobDeque*> JobDequeVector;
 
     public:
-        MkqsThread(int id, JobQueue* pQueue, pthread_mutex_t* pQueueMutex, 
-                   sem_t* pQueueSem, sem_t* pDoneSem, int thresholdSize,
-                   const PrimarySorter* pPrimarySorter, 
-                   const FinalSorter* pFinalSorter) : m_id(id), 
-                                                      m_pQueue(pQueue), 
-                                                      m_pQueueMutex(pQueueMutex), 
-                                                      m_pQueueSem(pQueueSem),
-                                                      m_pDoneSem(pDoneSem),
+        // pDeques holds the deque of every thread. pNumPendingJobs counts the
+        // jobs that have been created but not finished, across all threads.
+        MkqsThread(int id, JobDequeVector* pDeques, volatile int* pNumPendingJobs,
+                   int thresholdSize,
+                   const PrimarySorter* pPrimarySorter,
+                   const FinalSorter* pFinalSorter) : m_id(id),
+                                                      m_pDeques(pDeques),
+                                                      m_pNumPendingJobs(pNumPendingJobs),
                                                       m_thresholdSize(thresholdSize),
-                                                      m_pPrimary(pPrimarySorter), 
+                                                      m_pPrimary(pPrimarySorter),
                                                       m_pFinal(pFinalSorter),
-                                                      m_stopRequested(false),
-                                                      m_numProcessed(0) {}
+                                                      m_numProcessed(0),
+                                                      m_numStolen(0) {}
         ~MkqsThread();
 
         void start();
-        void stop();
         void join();
 
         static void* startThread(void* obj);
@@ -52,22 +139,22 @@ class MkqsThread
     private:
 
         void run();
-        void process(Job& job);
+
+        // Get a job from this thread's deque or steal one from another thread
+        bool getJob(Job& job);
 
         // Data
         int m_id;
-        JobQueue* m_pQueue; // shared
-        pthread_mutex_t* m_pQueueMutex; // shared
-        sem_t* m_pQueueSem; // shared
-        sem_t* m_pDoneSem; // shared
-        
+        JobDequeVector* m_pDeques; // shared
+        volatile int* m_pNumPendingJobs; // shared
+
         int m_thresholdSize;
         const PrimarySorter* m_pPrimary;
         const FinalSorter* m_pFinal;
 
         pthread_t m_thread;
-        volatile bool m_stopRequested;
         int m_numProcessed;
+        int m_numStolen;
 };
 
 //
@@ -88,13 +175,6 @@ void MkqsThread<T, PrimarySorter, FinalSorter>::start()
     }
 }
 
-// Stop thread
-template<typename T, class PrimarySorter, class FinalSorter>
-void MkqsThread<T, PrimarySorter, FinalSorter>::stop()
-{
-    m_stopRequested = true;
-}
-
 // Called from the external main function, joins the thread to the main on exit
 template<typename T, class PrimarySorter, class FinalSorter>
 void MkqsThread<T, PrimarySorter, FinalSorter>::join()
@@ -107,47 +187,64 @@ void MkqsThread<T, PrimarySorter, FinalSorter>::join()
     }
 }
 
+//
+template<typename T, class PrimarySorter, class FinalSorter>
+bool MkqsThread<T, PrimarySorter, FinalSorter>::getJob(Job& job)
+{
+    if((*m_pDeques)[m_id]->popBack(job))
+        return true;
+
+    // Try to steal from the other threads, starting with the next one
+    int num_threads = m_pDeques->size();
+    for(int i = 1; i < num_threads; ++i)
+    {
+        if((*m_pDeques)[(m_id + i) % num_threads]->stealFront(job))
+        {
+            m_numStolen += 1;
+            return true;
+        }
+    }
+    return false;
+}
+
 // Run thread
 template<typename T, class PrimarySorter, class FinalSorter>
 void MkqsThread<T, PrimarySorter, FinalSorter>::run()
 {
+    JobDeque* pDeque = (*m_pDeques)[m_id];
     while(1)
     {
-        sem_post(m_pDoneSem);
-        sem_wait(m_pQueueSem);
-        
-        // Exit if the thread was stopped
-        if(m_stopRequested)
+        Job job;
+        if(!getJob(job))
         {
-            pthread_exit(NULL);
+            // No work is available. The sort is complete when no
+            // job is pending, otherwise another thread is still
+            // working and may create new jobs.
+            if(*m_pNumPendingJobs == 0)
+                break;
+            sched_yield();
+            continue;
         }
 
-        // Take an item from the queue and process it
-        pthread_mutex_lock(m_pQueueMutex);
-        assert(!m_pQueue->empty());
-
-        // Decrement the done count. Since this is done
-        // while the queue is not empty and locked, the master
-        // thread can never see an empty queue before the
-        // done semaphore is decremented. This ensures all threads
-        // will work to completion
-        sem_wait(m_pDoneSem);
-
-        Job job = m_pQueue->front();
-        m_pQueue->pop();
-        pthread_mutex_unlock(m_pQueueMutex);
-
         // Process the item using either the parallel algorithm (which subdivides the job further)
         // or the serial algorithm (which doesn't subdivide)
-        if(job.n > m_thresholdSize)
+        if(job.bFinalOnly)
         {
-            parallel_mkqs_process(job, m_pQueue, m_pQueueMutex, m_pQueueSem, *m_pPrimary, *m_pFinal);
+            std::sort(job.pData, job.pData + job.n, *m_pFinal);
+        }
+        else if(job.n > m_thresholdSize)
+        {
+            parallel_mkqs_process(job, pDeque, m_pNumPendingJobs, *m_pPrimary, *m_pFinal);
         }
         else
         {
             mkqs2(job.pData, job.n, job.depth, *m_pPrimary, *m_pFinal);
         }
         m_numProcessed += 1;
+
+        // Any subjobs were counted before this point so the
+        // pending count cannot reach zero while work remains
+        __sync_sub_and_fetch(m_pNumPendingJobs, 1);
     }
 }
 
@@ -11,25 +11,26 @@
 //
 //
 //
-OverlapProcess::OverlapProcess(const std::string& outFile, 
+OverlapProcess::OverlapProcess(OverlapHitStore* pHitStore, 
                                const OverlapAlgorithm* pOverlapper, 
-                               int minOverlap) : m_pOverlapper(pOverlapper), 
+                               int minOverlap) : m_pHitStore(pHitStore),
+                                                 m_pOverlapper(pOverlapper), 
                                                  m_minOverlap(minOverlap)
 {
-    m_pWriter = createWriter(outFile);
+
 }
 
 //
 OverlapProcess::~OverlapProcess()
 {
-    delete m_pWriter;
+
 }
 
 //
 OverlapResult OverlapProcess::process(const SequenceWorkItem& workItem)
 {
     OverlapResult result = m_pOverlapper->overlapRead(workItem.read, m_minOverlap, &m_blockList);
-    m_pOverlapper->writeOverlapBlocks(*m_pWriter, workItem.idx, result.isSubstring, &m_blockList);
+    m_pHitStore->addHits(workItem.idx, result.isSubstring, &m_blockList);
     m_blockList.clear();
     return result;
 }
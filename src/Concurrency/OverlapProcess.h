@@ -11,13 +11,14 @@
 
 #include "Util.h"
 #include "OverlapAlgorithm.h"
+#include "OverlapHitStore.h"
 #include "SequenceProcessFramework.h"
 
-// Compute the overlap blocks for reads
+// Compute the overlap blocks for reads and add them to a hit store
 class OverlapProcess
 {
     public:
-        OverlapProcess(const std::string& outFile, 
+        OverlapProcess(OverlapHitStore* pHitStore, 
                        const OverlapAlgorithm* pOverlapper, 
                        int minOverlap);
 
@@ -26,7 +27,7 @@ class OverlapProcess
         OverlapResult process(const SequenceWorkItem& item);
     
     private:
-        std::ostream* m_pWriter;
+        OverlapHitStore* m_pHitStore;
         OverlapBlockList m_blockList;
         const OverlapAlgorithm* m_pOverlapper;
         const int m_minOverlap;
@@ -139,7 +139,7 @@ size_t processWorkParallelPthread(Generator& generator,
         }
 
         // Create and start the thread
-        threadVec[i] = new Thread(semVec[i], processPtrVector[i], BUFFER_SIZE);
+        threadVec[i] = new Thread(semVec[i], processPtrVector[i], BUFFER_SIZE, i);
         threadVec[i]->start();
 
         inputBuffers[i] = new InputItemVector;
@@ -16,6 +16,7 @@
 
 #include <semaphore.h>
 #include "Util.h"
+#include "NumaUtil.h"
 
 template<class Input, class Output, class Processor>
 class ThreadWorker
@@ -24,7 +25,8 @@ class ThreadWorker
     typedef std::vector<Output> OutputVector;
 
     public:
-        ThreadWorker(sem_t* pReadySem, Processor* pProcessor, const size_t max_items);
+        // workerID is used to place the thread on a NUMA node, see NumaUtil
+        ThreadWorker(sem_t* pReadySem, Processor* pProcessor, const size_t max_items, int workerID = -1);
         ~ThreadWorker();
 
         // Exchange the contents of the shared input/output vectors with pInput/pOutput
@@ -62,6 +64,7 @@ class ThreadWorker
         InputVector m_sharedInputVector;
         OutputVector m_sharedOutputVector;
         Processor* m_pProcessor;
+        int m_workerID;
 
         volatile bool m_stopRequested;
         bool m_isReady;
@@ -71,9 +74,11 @@ class ThreadWorker
 template<class Input, class Output, class Processor>
 ThreadWorker<Input, Output, Processor>::ThreadWorker(sem_t* pReadySem, 
                                                      Processor* pProcessor,
-                                                     const size_t max_items) :
+                                                     const size_t max_items,
+                                                     int workerID) :
                                                       m_pReadySem(pReadySem),
                                                       m_pProcessor(pProcessor),
+                                                      m_workerID(workerID),
                                                       m_stopRequested(false), 
                                                       m_isReady(false)
 {
@@ -169,6 +174,8 @@ bool ThreadWorker<Input, Output, Processor>::isReady()
 template<class Input, class Output, class Processor>
 void ThreadWorker<Input, Output, Processor>::run()
 {
+    NumaUtil::pinWorkerThread(m_workerID);
+
     // Indicate that the thread is ready to receive data
     pthread_mutex_lock(&m_mutex);
     m_isReady = true;
@@ -9,7 +9,6 @@
 //
 #include "DeBruijnHaplotypeBuilder.h"
 #include "BWTAlgorithms.h"
-#include "SGSearch.h"
 #include "SGAlgorithms.h"
 #include "SGVisitors.h"
 #include "Profiler.h"
@@ -21,7 +20,9 @@
 //
 //
 //
-DeBruijnHaplotypeBuilder::DeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params)
+DeBruijnHaplotypeBuilder::DeBruijnHaplotypeBuilder(const GraphCompareParameters& params, 
+                                                   LocalDeBruijnGraph* pGraph) : m_parameters(params),
+                                                                                 m_pGraph(pGraph)
 {
 
 }
@@ -44,8 +45,6 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
     PROFILE_FUNC("GraphCompare::buildVariantStringGraph")
     assert(!m_startingKmer.empty());
 
-    std::map<std::string, int> kmerCountMap;
-
     // We search until we find the first common vertex in each direction
     size_t MIN_TARGET_COUNT = m_parameters.bReferenceMode ? 1 : 2;
     size_t MAX_ITERATIONS = 2000;
@@ -57,20 +56,23 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
     size_t total_branches = 0;
     size_t iterations = 0;
 
-    // Initialize the graph
-    StringGraph* pGraph = new StringGraph;
-    BuilderExtensionQueue queue;
+    // Initialize the graph. K-mers with bases other than ACGT
+    // have no de Bruijn graph extensions
+    LocalDeBruijnGraph& graph = *m_pGraph;
+    if(!graph.reset(m_startingKmer))
+        return HBRC_OK;
 
-    Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(m_startingKmer, m_startingKmer);
-    pVertex->setColor(GC_BLACK);
-    pGraph->addVertex(pVertex);
+    LocalDeBruijnExtensionQueue queue;
 
     // Add the vertex to the extension queue
-    queue.push(BuilderExtensionNode(pVertex, ED_SENSE));
-    queue.push(BuilderExtensionNode(pVertex, ED_ANTISENSE));
+    queue.push(LocalDeBruijnExtension(0, ED_SENSE, 0));
+    queue.push(LocalDeBruijnExtension(0, ED_ANTISENSE, 0));
+
+    std::vector<size_t> sense_join_vector;
+    std::vector<size_t> antisense_join_vector;
 
-    std::vector<Vertex*> sense_join_vector;
-    std::vector<Vertex*> antisense_join_vector;
+    std::string vertStr;
+    std::string newStr;
 
     // Perform the extension. The while conditions are heuristics to avoid searching
     // the graph too much 
@@ -79,14 +81,17 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
         if(queue.size() > max_simul_branches_used)
             max_simul_branches_used = queue.size();
 
-        BuilderExtensionNode curr = queue.front();
+        LocalDeBruijnExtension curr = queue.front();
         queue.pop();
 
         // Calculate de Bruijn extensions for this node
-        std::string vertStr = curr.pVertex->getSeq().toString();
-        AlphaCount64 extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_parameters.variantIndex.pBWT, curr.direction);
+        graph.getKmer(curr.id, vertStr);
+        AlphaCount64 extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, 
+                                                                                             m_parameters.variantIndex.pBWT, 
+                                                                                             curr.direction,
+                                                                                             m_parameters.variantIndex.pCache);
 
-        std::string extensionsUsed;
+        size_t num_used = 0;
         for(size_t i = 0; i < DNA_ALPHABET::size; ++i)
         {
             char b = DNA_ALPHABET::getBase(i);
@@ -95,65 +100,48 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
             if(!acceptExt)
                 continue;
 
-            extensionsUsed.push_back(b);
-            std::string newStr = VariationBuilderCommon::makeDeBruijnVertex(vertStr, b, curr.direction);
-            kmerCountMap[newStr] = count;
+            num_used += 1;
 
-            // Create the new vertex and edge in the graph
+            // Create the new vertex in the graph
             // Skip if the vertex already exists
-            if(pGraph->getVertex(newStr) != NULL)
+            size_t newID = graph.addExtension(curr.id, b, curr.direction);
+            if(newID == LocalDeBruijnGraph::NO_VERTEX)
                 continue;
             
-            // Allocate the new vertex and add it to the graph
-            Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(newStr, newStr);
-            pVertex->setColor(GC_BLACK);
-            pGraph->addVertex(pVertex);
-
-            // Add edges
-            VariationBuilderCommon::addSameStrandDeBruijnEdges(pGraph, curr.pVertex, pVertex, curr.direction);
-            
             // Check if this sequence is present in the FM-index of the target
             // If so, it is the join point of the de Bruijn graph and we extend no further.
+            graph.getKmer(newID, newStr);
             size_t targetCount = BWTAlgorithms::countSequenceOccurrences(newStr, m_parameters.baseIndex);
 
             if(targetCount >= MIN_TARGET_COUNT)
             {
                 if(curr.direction == ED_SENSE)
-                    sense_join_vector.push_back(pVertex);
+                    sense_join_vector.push_back(newID);
                 else
-                    antisense_join_vector.push_back(pVertex);
+                    antisense_join_vector.push_back(newID);
             }
             else
             {
                 // Add the vertex to the extension queue
-                queue.push(BuilderExtensionNode(pVertex, curr.direction));
+                queue.push(LocalDeBruijnExtension(newID, curr.direction, curr.distance + 1));
             }
         }
         
         // Update the total number of times we branches the search
-        if(!extensionsUsed.empty())
-            total_branches += extensionsUsed.size() - 1;
+        if(num_used > 0)
+            total_branches += num_used - 1;
     }
 
     // If the graph construction was successful, walk the graph
     // between the endpoints to make a string
-    // Generate haplotypes between every pair of antisense/sense join vertices
+    // Generate haplotypes between every pair of antisense/sense join vertices.
+    // Each vertex was added by a single extension so there is exactly one
+    // path between the join vertices, through the starting k-mer.
     for(size_t i = 0; i < antisense_join_vector.size(); ++i) {
         for(size_t j = 0; j < sense_join_vector.size(); ++j) {
-            SGWalkVector outWalks;
-            SGSearch::findWalks(antisense_join_vector[i],
-                                sense_join_vector[j],
-                                ED_SENSE,
-                                100000, // max distance to search
-                                10000, // max nodes to search
-                                true, // exhaustive search
-                                outWalks);
-
-            for(size_t k = 0; k < outWalks.size(); ++k)
-                out_haplotypes.push_back(outWalks[k].getString(SGWT_START_TO_END));
+            out_haplotypes.push_back(graph.makePathString(antisense_join_vector[i], sense_join_vector[j]));
         }
     }
     
-    delete pGraph;
     return HBRC_OK;
 }
@@ -18,6 +18,7 @@
 #include "SGWalk.h"
 #include "VariationBuilderCommon.h"
 #include "HaplotypeBuilder.h"
+#include "LocalDeBruijnGraph.h"
 #include "multiple_alignment.h"
 #include "GraphCompare.h"
 #include "ErrorCorrectProcess.h"
@@ -29,7 +30,8 @@ class DeBruijnHaplotypeBuilder
 {
     public:
 
-        DeBruijnHaplotypeBuilder(const GraphCompareParameters& parameters);
+        // The graph is reset and reused for each run
+        DeBruijnHaplotypeBuilder(const GraphCompareParameters& parameters, LocalDeBruijnGraph* pGraph);
         ~DeBruijnHaplotypeBuilder();
         
         // Set the string to start from
@@ -46,6 +48,7 @@ class DeBruijnHaplotypeBuilder
         //
         GraphCompareParameters m_parameters;
         std::string m_startingKmer;
+        LocalDeBruijnGraph* m_pGraph;
 };
 
 #endif
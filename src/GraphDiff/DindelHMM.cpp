@@ -62,12 +62,12 @@ void DindelHMM::getSeedPositions(std::set<int> & positions)
     std::map<int, std::list<int> > freq_to_pos;
     for (int x=0;x<int(readKeys.size());x++)
     {
-        std::list<int> hpos_set = hapHash.lookupList(readKeys[x]);
-        if (!hpos_set.empty())
+        DindelSequenceHash::EntryRange hpos_range = hapHash.lookupRange(readKeys[x]);
+        if (hpos_range.first != hpos_range.second)
         {
             int numHits=0;
-            for (std::list<int>::const_iterator hpos = hpos_set.begin();hpos!=hpos_set.end() && numHits<4;++hpos,++numHits) {
-                int rpos = *hpos-x;
+            for (DindelSequenceHash::EntryVector::const_iterator hpos = hpos_range.first;hpos!=hpos_range.second && numHits<4;++hpos,++numHits) {
+                int rpos = hpos->pos-x;
                 HashMap<int, int>::iterator it = pos_to_freq.find(rpos);
                 if (it == pos_to_freq.end()) pos_to_freq[rpos]=1; else it->second++;
             }
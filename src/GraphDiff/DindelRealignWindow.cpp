@@ -25,6 +25,7 @@
 #include <set>
 #include <numeric>
 #include <iomanip>
+#include <limits>
 #include "StdAlnTools.h"
 #include "MultiAlignment.h"
 #include "DindelRealignWindow.h"
@@ -1023,35 +1024,41 @@ DindelSequenceHash::DindelSequenceHash(const std::string & sequence)
 
 void DindelSequenceHash::print() const
 {
-    for (Hash::const_iterator it=m_hash.begin();it!=m_hash.end();it++)
+    for (EntryVector::const_iterator it=m_entries.begin();it!=m_entries.end();it++)
     {
-        std::cout << " hash: " << it->first << " => ";
-        for (std::list<int>::const_iterator i=it->second.begin();i!=it->second.end();i++) std::cout << " " << *i; std::cout << std::endl;
+        if(it == m_entries.begin() || (it - 1)->key != it->key)
+        {
+            if(it != m_entries.begin())
+                std::cout << std::endl;
+            std::cout << " hash: " << it->key << " => ";
+        }
+        std::cout << " " << it->pos;
     }
-    
-}
-
-/*
-int DindelSequenceHash::lookup(unsigned int key) const
-{
-    UniqueHash::const_iterator iter = m_uniqueHash.find(key);
-    if (iter!=m_uniqueHash.end()) return iter->second; else return -1;
+    if(!m_entries.empty())
+        std::cout << std::endl;
 }
-*/
 
-const std::list<int> & DindelSequenceHash::lookupList(unsigned int key) const
+DindelSequenceHash::EntryRange DindelSequenceHash::lookupRange(unsigned int key) const
 {
-    Hash::const_iterator iter = m_hash.find(key);
-    if (iter == m_hash.end())
-        return emptyList;
-    else
-        return iter->second;
+    Entry lower = { key, std::numeric_limits<int>::min() };
+    Entry upper = { key, std::numeric_limits<int>::max() };
+    return EntryRange(std::lower_bound(m_entries.begin(), m_entries.end(), lower),
+                      std::upper_bound(m_entries.begin(), m_entries.end(), upper));
 }
 
 void DindelSequenceHash::makeHash(const std::string & sequence)
 {
+    m_entries.clear();
+    if(sequence.size() <= DINDEL_HASH_SIZE)
+        return;
+
+    m_entries.reserve(sequence.size()-DINDEL_HASH_SIZE);
     for (size_t x=0;x<sequence.size()-DINDEL_HASH_SIZE;x++)
-        m_hash[convert(sequence,x)].push_back(x);
+    {
+        Entry e = { convert(sequence,x), (int)x };
+        m_entries.push_back(e);
+    }
+    std::sort(m_entries.begin(), m_entries.end());
 }
 
 
@@ -300,20 +300,38 @@ class DindelVariant
 };
 
 //
-// DindelSequenceHash
+// DindelSequenceHash - Index of the DINDEL_HASH_SIZE-mers of a haplotype.
+// The (key, position) pairs are stored in a single vector sorted by key
+// so that all positions of a k-mer are contiguous and can be returned
+// as a range without any per-position allocation.
 //
 class DindelSequenceHash
 {
     public:
-        
+
+        struct Entry
+        {
+            unsigned int key;
+            int pos;
+
+            friend bool operator<(const Entry& a, const Entry& b)
+            {
+                return a.key < b.key || (a.key == b.key && a.pos < b.pos);
+            }
+        };
+
+        typedef std::vector<Entry> EntryVector;
+        typedef std::pair<EntryVector::const_iterator, EntryVector::const_iterator> EntryRange;
+
         // Constructors
         DindelSequenceHash() {};
         DindelSequenceHash(const std::string & sequence);
 
         // Functions
-        const std::set<int> & lookup(const std::string & seq, int pos) const;
-        //int lookup(unsigned int key) const;
-        const std::list<int> & lookupList(unsigned int key) const;
+        
+        // Return the range of entries matching key. The entries
+        // are ordered by increasing position in the sequence.
+        EntryRange lookupRange(unsigned int key) const;
         
         static inline unsigned int convert(const std::string & seq, int pos)
         {
@@ -345,17 +363,12 @@ class DindelSequenceHash
         void print() const;
 
     protected:
-        typedef HashMap<unsigned int, std::list<int> > Hash;
-        typedef HashMap<unsigned int, int > UniqueHash;
 
         // Functions
         void makeHash(const std::string & sequence);
 
         // Data
-        Hash m_hash;
-        // UniqueHash m_uniqueHash;
-        std::set<int> emptySet;
-        std::list<int> emptyList;
+        EntryVector m_entries;
 };
 
 // DindelReferenceMapping
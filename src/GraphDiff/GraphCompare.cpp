@@ -243,13 +243,13 @@ GraphBuildResult GraphCompare::processVariantKmer(const std::string& str, int /*
 
     if(m_parameters.algorithm == GCA_DEBRUIJN_GRAPH)
     {
-        DeBruijnHaplotypeBuilder dbg_builder(m_parameters);
+        DeBruijnHaplotypeBuilder dbg_builder(m_parameters, &m_localGraph);
         dbg_builder.setInitialHaplotype(str);
         dbg_builder.run(result.variant_haplotypes);
     }
     else if(m_parameters.algorithm == GCA_PAIRED_DEBRUIJN_GRAPH)
     {
-        PairedDeBruijnHaplotypeBuilder dbg_builder(m_parameters);
+        PairedDeBruijnHaplotypeBuilder dbg_builder(m_parameters, &m_localGraph);
         dbg_builder.setInitialHaplotype(str);
         dbg_builder.run(result.variant_haplotypes);
     }
@@ -508,15 +508,10 @@ size_t GraphCompare::calculateHaplotypeBranches(const std::string& sequence,
 //
 IntVector GraphCompare::makeCountProfile(const std::string& str, size_t k, const BWT* pBWT, int max)
 {
-    IntVector out;
-    if(str.size() < k)
-        return out;
-
-    for(size_t i = 0; i < str.size() - k + 1; ++i)
-    {
-        int count = BWTAlgorithms::countSequenceOccurrences(str.substr(i, k), pBWT);
-        out.push_back(count > max ? max : count);
-    }
+    std::vector<size_t> counts = BWTAlgorithms::countKmerProfile(str, k, pBWT);
+    IntVector out(counts.size());
+    for(size_t i = 0; i < counts.size(); ++i)
+        out[i] = counts[i] > (size_t)max ? max : counts[i];
     return out;
 }
 
@@ -28,6 +28,7 @@
 #include "SampledSuffixArray.h"
 #include "DindelRealignWindow.h"
 #include "BloomFilter.h"
+#include "LocalDeBruijnGraph.h"
 #include "api/BamWriter.h"
 
 enum GraphCompareAlgorithm
@@ -195,6 +196,9 @@ class GraphCompare
         // Results stats
         GraphCompareStats m_stats;
 
+        // Reused by the de Bruijn graph haplotype builders for each variant k-mer
+        mutable LocalDeBruijnGraph m_localGraph;
+
 };
 
 // Shared result object that the threaded
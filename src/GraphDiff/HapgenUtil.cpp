@@ -15,6 +15,13 @@
 #include "Profiler.h"
 #include "Verbosity.h"
 #include "overlapper.h"
+#include "config.h"
+#include <algorithm>
+#include <string.h>
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
 
 // Align the haplotype to the reference genome represented by the BWT/SSA pair
 void HapgenUtil::alignHaplotypeToReferenceBWASW(const std::string& haplotype,
@@ -362,9 +369,10 @@ bool HapgenUtil::checkAlignmentsAreConsistent(const std::string& refString, cons
         return true;
 
     // Perform local alignments of each query to the refString
+    LocalAlignmentProfile profile(refString);
     LocalAlignmentResultVector alignments;
     for(size_t i = 0; i < queries.size(); ++i)
-        alignments.push_back(StdAlnTools::localAlignment(refString, queries[i]));
+        alignments.push_back(StdAlnTools::localAlignment(profile, queries[i]));
 
     size_t i = 0;
     for(size_t j = 1; j < alignments.size(); ++j)
@@ -382,6 +390,21 @@ bool HapgenUtil::checkAlignmentsAreConsistent(const std::string& refString, cons
     return true;
 }
 
+// Compare two k-mers given by pointers to their first base
+struct KmerPointerLess
+{
+    KmerPointerLess(int k) : m_k(k) {}
+    bool operator()(const char* a, const char* b) const { return memcmp(a, b, m_k) < 0; }
+    int m_k;
+};
+
+struct KmerPointerEqual
+{
+    KmerPointerEqual(int k) : m_k(k) {}
+    bool operator()(const char* a, const char* b) const { return memcmp(a, b, m_k) == 0; }
+    int m_k;
+};
+
 // Extract reads from an FM-index that have a k-mer match to any given haplotypes
 // Returns true if the reads were successfully extracted, false if there are 
 // more reads than maxReads
@@ -392,7 +415,8 @@ bool HapgenUtil::extractHaplotypeReads(const StringVector& haplotypes,
                                        size_t maxReads,
                                        int64_t maxIntervalSize,
                                        SeqRecordVector* pOutReads, 
-                                       SeqRecordVector* pOutMates)
+                                       SeqRecordVector* pOutMates,
+                                       int numThreads)
 {
     PROFILE_FUNC("HapgenUtil::extractHaplotypeReads")
     // Extract the set of reads that have at least one kmer shared with these haplotypes
@@ -401,69 +425,84 @@ bool HapgenUtil::extractHaplotypeReads(const StringVector& haplotypes,
     // 2) find the intervals for the kmers in the fm-index
     // 3) compute the set of read indices of the reads from the intervals (using the sampled suffix array)
     // 4) finally, extract the read sequences from the index
-    // Make a set of kmers from the haplotypes
-    std::set<std::string> kmerSet;
-    for(size_t i = 0; i < haplotypes.size(); ++i)
+    // The kmers of the reverse complemented haplotypes are the reverse complements of the kmers
+    StringVector rcHaplotypes;
+    if(doReverse)
     {
-        const std::string& h = haplotypes[i];
+        for(size_t i = 0; i < haplotypes.size(); ++i)
+            rcHaplotypes.push_back(reverseComplement(haplotypes[i]));
+    }
+    const StringVector& sequences = doReverse ? rcHaplotypes : haplotypes;
+
+    // Make a set of kmers from the haplotypes. The kmers are represented by
+    // a pointer into the sequence and deduplicated by sorting.
+    std::vector<const char*> kmers;
+    for(size_t i = 0; i < sequences.size(); ++i)
+    {
+        const std::string& h = sequences[i];
         if((int)h.size() < k)
             continue;
 
         for(size_t j = 0; j < h.size() - k + 1; ++j)
-        {
-            std::string ks = h.substr(j, k);
-            if(doReverse)
-                ks = reverseComplement(ks);
-            kmerSet.insert(ks);
-        }
+            kmers.push_back(h.data() + j);
     }
+    std::sort(kmers.begin(), kmers.end(), KmerPointerLess(k));
+    kmers.erase(std::unique(kmers.begin(), kmers.end(), KmerPointerEqual(k)), kmers.end());
 
-    // Compute suffix array intervals for the kmers
-    std::vector<BWTInterval> intervals;
-    for(std::set<std::string>::const_iterator iter = kmerSet.begin(); iter != kmerSet.end(); ++iter)
+    // Compute suffix array intervals for the kmers and collect the positions within them
+    std::vector<int64_t> saIndices;
+    std::string ks;
+    for(size_t i = 0; i < kmers.size(); ++i)
     {
-        BWTInterval interval = BWTAlgorithms::findInterval(indices, *iter);
+        ks.assign(kmers[i], k);
+        BWTInterval interval = BWTAlgorithms::findInterval(indices, ks);
         if(interval.size() < maxIntervalSize)
-            intervals.push_back(interval);
-    }
-
-    // Compute the set of reads ids 
-    std::set<int64_t> readIndices;
-    for(size_t i = 0; i < intervals.size(); ++i)
-    {
-        BWTInterval interval = intervals[i];
-        for(int64_t j = interval.lower; j <= interval.upper; ++j)
         {
-            // Get index from sampled suffix array
-            SAElem elem = indices.pSSA->calcSA(j, indices.pBWT);
-            readIndices.insert(elem.getID());
+            for(int64_t j = interval.lower; j <= interval.upper; ++j)
+                saIndices.push_back(j);
         }
     }
 
+    // Compute the set of reads ids using the sampled suffix array
+    SAElemVector elems(saIndices.size());
+    if(!saIndices.empty())
+        indices.pSSA->calcSA(&saIndices[0], saIndices.size(), indices.pBWT, &elems[0], numThreads);
+
+    std::vector<int64_t> readIndices(elems.size());
+    for(size_t i = 0; i < elems.size(); ++i)
+        readIndices[i] = elems[i].getID();
+    std::sort(readIndices.begin(), readIndices.end());
+    readIndices.erase(std::unique(readIndices.begin(), readIndices.end()), readIndices.end());
+
     // Check if we have hit the limit of extracting too many reads
     if(readIndices.size() > maxReads)
         return false;
 
-    for(std::set<int64_t>::const_iterator iter = readIndices.begin(); iter != readIndices.end(); ++iter)
+    // Extract the reads and, optionally, their mates.
+    // If the index is constructed properly, 
+    // paired reads are in adjacent indices with the
+    // first read at even indices
+    assert(indices.pQualityTable != NULL);
+    int64_t numReads = readIndices.size();
+    SeqRecordVector reads(numReads);
+    SeqRecordVector mates(pOutMates != NULL ? numReads : 0);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(numThreads) if(numThreads > 1)
+#endif
+    for(int64_t i = 0; i < numReads; ++i)
     {
-        int64_t idx = *iter;
+        int64_t idx = readIndices[i];
         
         // Extract the read
         std::stringstream namer;
         namer << "idx-" << idx;
-        SeqRecord record;
+        SeqRecord& record = reads[i];
         record.id = namer.str();
         record.seq = BWTAlgorithms::extractString(indices.pBWT, idx);
-
-        assert(indices.pQualityTable != NULL);
         record.qual = indices.pQualityTable->getQualityString(idx, record.seq.length());
-        if(!record.seq.empty())
-            pOutReads->push_back(record);
 
         // Optionally extract its mate
-        // If the index is constructed properly, 
-        // paired reads are in adjacent indices with the
-        // first read at even indices
         if(pOutMates != NULL)
         {
             int64_t mateIdx = idx;
@@ -474,14 +513,22 @@ bool HapgenUtil::extractHaplotypeReads(const StringVector& haplotypes,
             
             std::stringstream mateName;
             mateName << "idx-" << mateIdx;
-            SeqRecord mateRecord;
+            SeqRecord& mateRecord = mates[i];
             mateRecord.id = mateName.str();
             mateRecord.seq = BWTAlgorithms::extractString(indices.pBWT, mateIdx);
             mateRecord.qual = indices.pQualityTable->getQualityString(mateIdx, mateRecord.seq.length());
-            if(!record.seq.empty() && !mateRecord.seq.empty())
-                pOutMates->push_back(mateRecord);
         }
     }
+
+    for(int64_t i = 0; i < numReads; ++i)
+    {
+        if(reads[i].seq.empty())
+            continue;
+
+        pOutReads->push_back(reads[i]);
+        if(pOutMates != NULL && !mates[i].seq.empty())
+            pOutMates->push_back(mates[i]);
+    }
     return true;
 }
 
@@ -525,11 +572,13 @@ bool HapgenUtil::extractHaplotypeSpecificReads(const StringVector& haplotypes,
 // Align a bunch of reads locally to a sequence
 LocalAlignmentResultVector HapgenUtil::alignReadsLocally(const std::string& target, const SeqItemVector& reads)
 {
+    // The target profile is shared by all the reads
+    LocalAlignmentProfile profile(target);
     LocalAlignmentResultVector results;
     for(size_t i = 0; i < reads.size(); ++i)
     {
-        LocalAlignmentResult fwdAR = StdAlnTools::localAlignment(target, reads[i].seq.toString());
-        LocalAlignmentResult rcAR = StdAlnTools::localAlignment(target, reverseComplement(reads[i].seq.toString()));
+        LocalAlignmentResult fwdAR = StdAlnTools::localAlignment(profile, reads[i].seq.toString());
+        LocalAlignmentResult rcAR = StdAlnTools::localAlignment(profile, reverseComplement(reads[i].seq.toString()));
         results.push_back(fwdAR.score > rcAR.score ? fwdAR : rcAR);
     }
     return results;
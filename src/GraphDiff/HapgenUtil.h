@@ -100,7 +100,8 @@ namespace HapgenUtil
 
 
     // Extract reads from an FM-index that have a k-mer match to any given haplotypes
-    // If the number of reads to extract exceeds maxReads, false is returned
+    // If the number of reads to extract exceeds maxReads, false is returned.
+    // The suffix array lookups and the read extraction use numThreads threads.
     bool extractHaplotypeReads(const StringVector& haplotypes, 
                                const BWTIndexSet& indices,
                                int k,
@@ -108,7 +109,8 @@ namespace HapgenUtil
                                size_t maxReads,
                                int64_t maxIntervalSize,
                                SeqRecordVector* pOutReads, 
-                               SeqRecordVector* pOutMates);
+                               SeqRecordVector* pOutMates,
+                               int numThreads = 1);
 
     // Extract reads from an FM-index that have a k-mer match to AT MOST one haplotype
     // If the number of reads to extract exceeds maxReads, false is returned
@@ -0,0 +1,194 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// LocalDeBruijnGraph - A small de Bruijn graph built
+// around a single candidate k-mer.
+// See LocalDeBruijnGraph.h
+//
+#include <assert.h>
+#include <algorithm>
+#include "LocalDeBruijnGraph.h"
+#include "Alphabet.h"
+
+// Marks an empty slot in the hash table
+static const uint32_t EMPTY_SLOT = (uint32_t)-1;
+
+// Initial number of slots in the hash table. The table
+// is doubled when it becomes half full.
+static const size_t INITIAL_TABLE_SIZE = 1024;
+
+//
+LocalDeBruijnGraph::LocalDeBruijnGraph() : m_k(0), m_numWords(0)
+{
+
+}
+
+//
+LocalDeBruijnGraph::~LocalDeBruijnGraph()
+{
+
+}
+
+//
+bool LocalDeBruijnGraph::reset(const std::string& rootKmer)
+{
+    assert(rootKmer.size() <= MAX_K);
+    m_k = rootKmer.size();
+    m_numWords = (m_k + 31) / 32;
+    m_vertices.clear();
+
+    if(m_table.empty())
+        m_table.resize(INITIAL_TABLE_SIZE);
+    std::fill(m_table.begin(), m_table.end(), EMPTY_SLOT);
+
+    LocalVertex root;
+    if(!encode(rootKmer, root.kmer))
+        return false;
+    root.parent = 0;
+    root.base = '\0';
+
+    m_table[findSlot(root.kmer)] = 0;
+    m_vertices.push_back(root);
+    return true;
+}
+
+//
+size_t LocalDeBruijnGraph::addExtension(size_t id, char b, EdgeDir dir)
+{
+    assert(id < m_vertices.size());
+    const PackedKmer& curr = m_vertices[id].kmer;
+    uint64_t rank = DNA_ALPHABET::getBaseRank(b);
+
+    LocalVertex v;
+    v.parent = id;
+    v.base = b;
+
+    if(dir == ED_SENSE)
+    {
+        // Drop the first base and append b
+        for(size_t i = 0; i < m_numWords; ++i)
+        {
+            v.kmer.words[i] = curr.words[i] >> 2;
+            if(i + 1 < m_numWords)
+                v.kmer.words[i] |= curr.words[i + 1] << 62;
+        }
+        size_t p = m_k - 1;
+        v.kmer.words[p / 32] |= rank << (2 * (p % 32));
+    }
+    else
+    {
+        // Drop the last base and prepend b
+        for(size_t i = 0; i < m_numWords; ++i)
+        {
+            v.kmer.words[i] = curr.words[i] << 2;
+            if(i > 0)
+                v.kmer.words[i] |= curr.words[i - 1] >> 62;
+        }
+        if(m_k % 32 != 0)
+            v.kmer.words[m_k / 32] &= ~((uint64_t)3 << (2 * (m_k % 32)));
+        v.kmer.words[0] |= rank;
+    }
+
+    size_t slot = findSlot(v.kmer);
+    if(m_table[slot] != EMPTY_SLOT)
+        return NO_VERTEX;
+
+    size_t newID = m_vertices.size();
+    m_table[slot] = newID;
+    m_vertices.push_back(v);
+
+    if(2 * m_vertices.size() > m_table.size())
+        growTable();
+    return newID;
+}
+
+//
+void LocalDeBruijnGraph::getKmer(size_t id, std::string& out) const
+{
+    assert(id < m_vertices.size());
+    const PackedKmer& kmer = m_vertices[id].kmer;
+    out.resize(m_k);
+    for(size_t i = 0; i < m_k; ++i)
+        out[i] = DNA_ALPHABET::getBase((kmer.words[i / 32] >> (2 * (i % 32))) & 3);
+}
+
+// The antisense vertices prepend a base to their parent and the
+// sense vertices append a base so the path string is the bases
+// from antisenseID up to the root, the root k-mer, then the bases
+// from the root down to senseID
+std::string LocalDeBruijnGraph::makePathString(size_t antisenseID, size_t senseID) const
+{
+    std::string out;
+    for(size_t id = antisenseID; id != 0; id = m_vertices[id].parent)
+        out.push_back(m_vertices[id].base);
+
+    std::string rootKmer;
+    getKmer(0, rootKmer);
+    out.append(rootKmer);
+
+    size_t start = out.size();
+    for(size_t id = senseID; id != 0; id = m_vertices[id].parent)
+        out.push_back(m_vertices[id].base);
+    std::reverse(out.begin() + start, out.end());
+    return out;
+}
+
+//
+bool LocalDeBruijnGraph::encode(const std::string& kmer, PackedKmer& out) const
+{
+    for(size_t i = 0; i < PackedKmer::NUM_WORDS; ++i)
+        out.words[i] = 0;
+
+    for(size_t i = 0; i < kmer.size(); ++i)
+    {
+        char b = kmer[i];
+        if(b != 'A' && b != 'C' && b != 'G' && b != 'T')
+            return false;
+        out.words[i / 32] |= (uint64_t)DNA_ALPHABET::getBaseRank(b) << (2 * (i % 32));
+    }
+    return true;
+}
+
+//
+bool LocalDeBruijnGraph::isEqual(const PackedKmer& a, const PackedKmer& b) const
+{
+    for(size_t i = 0; i < m_numWords; ++i)
+    {
+        if(a.words[i] != b.words[i])
+            return false;
+    }
+    return true;
+}
+
+//
+size_t LocalDeBruijnGraph::hash(const PackedKmer& kmer) const
+{
+    uint64_t h = 0;
+    for(size_t i = 0; i < m_numWords; ++i)
+    {
+        h ^= kmer.words[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+    }
+    return h;
+}
+
+// Linear probing
+size_t LocalDeBruijnGraph::findSlot(const PackedKmer& kmer) const
+{
+    size_t mask = m_table.size() - 1;
+    size_t slot = hash(kmer) & mask;
+    while(m_table[slot] != EMPTY_SLOT && !isEqual(m_vertices[m_table[slot]].kmer, kmer))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+//
+void LocalDeBruijnGraph::growTable()
+{
+    m_table.assign(2 * m_table.size(), EMPTY_SLOT);
+    for(size_t i = 0; i < m_vertices.size(); ++i)
+        m_table[findSlot(m_vertices[i].kmer)] = i;
+}
@@ -0,0 +1,110 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// LocalDeBruijnGraph - A small de Bruijn graph built
+// around a single candidate k-mer by the haplotype
+// builders. The k-mers are packed 2 bits per base into
+// a fixed number of 64-bit words and stored in an
+// open-addressing hash table. Each vertex records the
+// vertex it was extended from so the graph is a tree
+// rooted at the starting k-mer and the path between two
+// vertices can be read off directly. The storage is kept
+// when the graph is reset so one graph can be reused,
+// per thread, for every candidate.
+//
+#ifndef LOCAL_DEBRUIJN_GRAPH_H
+#define LOCAL_DEBRUIJN_GRAPH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <queue>
+#include "GraphCommon.h"
+
+// A k-mer of up to 127 bases. Base i is held in bits
+// 2*(i % 32) of word i / 32. Unused bits are zero.
+struct PackedKmer
+{
+    static const size_t NUM_WORDS = 4;
+    uint64_t words[NUM_WORDS];
+};
+
+class LocalDeBruijnGraph
+{
+    public:
+
+        // The largest k that can be packed
+        static const size_t MAX_K = 127;
+
+        // Returned by addExtension when the k-mer is already in the graph
+        static const size_t NO_VERTEX = (size_t)-1;
+
+        LocalDeBruijnGraph();
+        ~LocalDeBruijnGraph();
+
+        // Remove all the vertices and set the starting k-mer. The memory
+        // used by the previous graph is reused. Returns false if the
+        // k-mer has a base other than ACGT, in which case the graph is empty.
+        bool reset(const std::string& rootKmer);
+
+        // Add the vertex made by extending vertex id with base b in direction dir.
+        // Returns the new vertex or NO_VERTEX if the k-mer is already in the graph.
+        size_t addExtension(size_t id, char b, EdgeDir dir);
+
+        // Write the k-mer of vertex id to out
+        void getKmer(size_t id, std::string& out) const;
+
+        // Make the string spelled by the path from vertex antisenseID, which must have
+        // been reached by antisense extensions from the root, through the root to vertex
+        // senseID, which must have been reached by sense extensions.
+        std::string makePathString(size_t antisenseID, size_t senseID) const;
+
+        //
+        size_t getNumVertices() const { return m_vertices.size(); }
+        size_t getK() const { return m_k; }
+
+    private:
+
+        struct LocalVertex
+        {
+            PackedKmer kmer;
+            uint32_t parent;
+            char base; // the base added to the parent k-mer
+        };
+
+        // Not copyable
+        LocalDeBruijnGraph(const LocalDeBruijnGraph&);
+        LocalDeBruijnGraph& operator=(const LocalDeBruijnGraph&);
+
+        //
+        bool encode(const std::string& kmer, PackedKmer& out) const;
+        bool isEqual(const PackedKmer& a, const PackedKmer& b) const;
+        size_t hash(const PackedKmer& kmer) const;
+
+        // Return the table slot holding kmer or the empty slot where it should be inserted
+        size_t findSlot(const PackedKmer& kmer) const;
+        void growTable();
+
+        //
+        size_t m_k;
+        size_t m_numWords;
+        std::vector<LocalVertex> m_vertices;
+
+        // Open-addressing table of indices into m_vertices. The size is a power of 2.
+        std::vector<uint32_t> m_table;
+};
+
+// A vertex of a LocalDeBruijnGraph waiting to be extended
+struct LocalDeBruijnExtension
+{
+    LocalDeBruijnExtension(size_t i, EdgeDir dir, int dist) : id(i), direction(dir), distance(dist) {}
+
+    size_t id; // the vertex to extend
+    EdgeDir direction; // the direction to extend to
+    int distance; // the total number of nodes from the start to this node.
+};
+typedef std::queue<LocalDeBruijnExtension> LocalDeBruijnExtensionQueue;
+
+#endif
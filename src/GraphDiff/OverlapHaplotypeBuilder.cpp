@@ -200,7 +200,7 @@ void OverlapHaplotypeBuilder::extendGraph()
         }
 
         // Check if x is still a tip in this direction. If so, we trim it and its branch from the graph
-        EdgePtrVec x_edges = x->getEdges(dir);
+        EdgePtrRange x_edges = x->getEdges(dir);
         if(x_edges.size() == 0)
             vertices_to_trim.push_back(tips[i]);
     }
@@ -428,7 +428,7 @@ bool OverlapHaplotypeBuilder::areWalksValid(const SGWalkVector& walks)
         VertexPtrVec verts = walks[i].getVertices();
         for(size_t j = 1; j < verts.size() - 1; ++j)
         {
-            EdgePtrVec edges = verts[j]->getEdges();
+            EdgePtrRange edges = verts[j]->getEdges();
             for(size_t k = 0; k < edges.size(); ++k)
             {
                 if(vertex_set.find(edges[k]->getEnd()) == vertex_set.end())
@@ -447,8 +447,8 @@ bool OverlapHaplotypeBuilder::isUniqueJoin(Vertex* x, EdgeDir direction)
     // or goes to non-join sequences. This avoids the case
     // where we have chains of unambiguous join vertices
     // and we try to build paths using all pairs of them
-    EdgePtrVec dir_edges = x->getEdges(direction);
-    EdgePtrVec opp_edges = x->getEdges(!direction);
+    EdgePtrRange dir_edges = x->getEdges(direction);
+    EdgePtrRange opp_edges = x->getEdges(!direction);
     if(dir_edges.size() != 1 || opp_edges.size() > 1)
     {
         return true;
@@ -476,7 +476,7 @@ ExtendableTipVector OverlapHaplotypeBuilder::findTips() const
         edge_count[ED_ANTISENSE] = 0;
 
         Vertex* x = vertices[i];
-        EdgePtrVec x_edges = x->getEdges();
+        EdgePtrRange x_edges = x->getEdges();
         for(size_t j = 0; j < x_edges.size(); ++j)
         {
             Edge* xy = x_edges[j];
@@ -509,9 +509,8 @@ ExtendableTipVector OverlapHaplotypeBuilder::findTips() const
 //
 void OverlapHaplotypeBuilder::trimTip(Vertex* x, EdgeDir direction)
 {
-    // Check if we should recurse to the neighbors of x
-    EdgePtrVec x_opp_edges = x->getEdges(!direction);
-    
+    (void)direction;
+
     /*
     Vertex* x_neighbor = NULL;
     if(x_opp_edges.size() == 1)
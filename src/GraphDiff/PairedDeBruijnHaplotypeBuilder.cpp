@@ -9,7 +9,6 @@
 //
 #include "PairedDeBruijnHaplotypeBuilder.h"
 #include "BWTAlgorithms.h"
-#include "SGSearch.h"
 #include "SGAlgorithms.h"
 #include "SGVisitors.h"
 #include "Profiler.h"
@@ -21,7 +20,9 @@
 //
 //
 //
-PairedDeBruijnHaplotypeBuilder::PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params)
+PairedDeBruijnHaplotypeBuilder::PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& params,
+                                                               LocalDeBruijnGraph* pGraph) : m_parameters(params),
+                                                                                             m_pGraph(pGraph)
 {
 
 }
@@ -72,23 +73,26 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
     if(target_set.empty())
         return HBRC_OK;
 
-    // Initialize the graph
-    StringGraph* pGraph = new StringGraph;
-    BuilderExtensionQueue queue;
+    // Initialize the graph. K-mers with bases other than ACGT
+    // have no de Bruijn graph extensions
+    LocalDeBruijnGraph& graph = *m_pGraph;
+    if(!graph.reset(m_startingKmer))
+        return HBRC_OK;
 
-    Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(m_startingKmer, m_startingKmer);
-    pVertex->setColor(GC_BLACK);
-    pGraph->addVertex(pVertex);
+    LocalDeBruijnExtensionQueue queue;
 
     // Add the vertex to the extension queue
-    queue.push(BuilderExtensionNode(pVertex, ED_SENSE, 0));
-    queue.push(BuilderExtensionNode(pVertex, ED_ANTISENSE, 0));
+    queue.push(LocalDeBruijnExtension(0, ED_SENSE, 0));
+    queue.push(LocalDeBruijnExtension(0, ED_ANTISENSE, 0));
 
-    std::vector<Vertex*> sense_join_vector;
-    std::vector<Vertex*> antisense_join_vector;
+    std::vector<size_t> sense_join_vector;
+    std::vector<size_t> antisense_join_vector;
 
     bool extension_allowed[ED_COUNT] = { true, true };
 
+    std::string vertStr;
+    std::string newStr;
+
     // Perform the extension. The while conditions are heuristics to avoid searching
     // the graph too much 
     while(!queue.empty() && iterations++ < MAX_ITERATIONS && queue.size() < MAX_SIMULTANEOUS_BRANCHES && total_branches < MAX_TOTAL_BRANCHES)
@@ -96,15 +100,18 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
         if(queue.size() > max_simul_branches_used)
             max_simul_branches_used = queue.size();
 
-        BuilderExtensionNode curr = queue.front();
+        LocalDeBruijnExtension curr = queue.front();
         queue.pop();
 
         if(!extension_allowed[curr.direction])
             continue;
 
         // Calculate de Bruijn extensions for this node
-        std::string vertStr = curr.pVertex->getSeq().toString();
-        AlphaCount64 extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_parameters.variantIndex.pBWT, curr.direction);
+        graph.getKmer(curr.id, vertStr);
+        AlphaCount64 extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, 
+                                                                                             m_parameters.variantIndex.pBWT, 
+                                                                                             curr.direction,
+                                                                                             m_parameters.variantIndex.pCache);
 
         // Check whether to accept this edge into the graph
         // We currently only use the counts and not the guide kmers
@@ -127,46 +134,38 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
                 extensions.push_back(b);
         }
 
-        std::string extensionsUsed;
         for(size_t i = 0; i < extensions.size(); ++i)
         {
             char b = extensions[i];
-            extensionsUsed.push_back(b);
-            std::string newStr = VariationBuilderCommon::makeDeBruijnVertex(vertStr, b, curr.direction);
 
-            // Create the new vertex and edge in the graph
+            // Create the new vertex in the graph
             // Skip if the vertex already exists
-            if(pGraph->getVertex(newStr) != NULL)
+            size_t newID = graph.addExtension(curr.id, b, curr.direction);
+            if(newID == LocalDeBruijnGraph::NO_VERTEX)
                 continue;
             
-            // Allocate the new vertex and add it to the graph
-            Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(newStr, newStr);
-            pVertex->setColor(GC_BLACK);
-            pGraph->addVertex(pVertex);
-
-            // Add edges
-            VariationBuilderCommon::addSameStrandDeBruijnEdges(pGraph, curr.pVertex, pVertex, curr.direction);
+            graph.getKmer(newID, newStr);
             size_t ref_count = BWTAlgorithms::countSequenceOccurrences(newStr, m_parameters.referenceIndex);
             
             //if(target_set.find(newStr) != target_set.end() && curr.distance >= MIN_TARGET_DISTANCE)
             if((ref_count == 1 || target_set.find(newStr) != target_set.end()) && curr.distance >= MIN_TARGET_DISTANCE)
             {
                 if(curr.direction == ED_SENSE)
-                    sense_join_vector.push_back(pVertex);
+                    sense_join_vector.push_back(newID);
                 else
-                    antisense_join_vector.push_back(pVertex);
+                    antisense_join_vector.push_back(newID);
                 extension_allowed[curr.direction] = false;
             }
             else
             {
                 // Add the vertex to the extension queue
-                queue.push(BuilderExtensionNode(pVertex, curr.direction, curr.distance + 1));
+                queue.push(LocalDeBruijnExtension(newID, curr.direction, curr.distance + 1));
             }
         }
         
         // Update the total number of times we branches the search
-        if(!extensionsUsed.empty())
-            total_branches += extensionsUsed.size() - 1;
+        if(!extensions.empty())
+            total_branches += extensions.size() - 1;
     }
     
     if(Verbosity::Instance().getPrintLevel() > 2)
@@ -177,27 +176,15 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
 
     // If the graph construction was successful, walk the graph
     // between the endpoints to make a string
-    // Generate haplotypes between every pair of antisense/sense join vertices
+    // Generate haplotypes between every pair of antisense/sense join vertices.
+    // Each vertex was added by a single extension so there is exactly one
+    // path between the join vertices, through the starting k-mer.
     for(size_t i = 0; i < antisense_join_vector.size(); ++i) {
         for(size_t j = 0; j < sense_join_vector.size(); ++j) {
-            SGWalkVector outWalks;
-            SGSearch::findWalks(antisense_join_vector[i],
-                                sense_join_vector[j],
-                                ED_SENSE,
-                                100000, // max distance to search
-                                10000, // max nodes to search
-                                true, // exhaustive search
-                                outWalks);
-
-            for(size_t k = 0; k < outWalks.size(); ++k)
-            {
-
-                out_haplotypes.push_back(outWalks[k].getString(SGWT_START_TO_END));
-            }
+            out_haplotypes.push_back(graph.makePathString(antisense_join_vector[i], sense_join_vector[j]));
         }
     }
 
-    delete pGraph;
     return HBRC_OK;
 }
  
@@ -18,6 +18,7 @@
 #include "SGWalk.h"
 #include "VariationBuilderCommon.h"
 #include "HaplotypeBuilder.h"
+#include "LocalDeBruijnGraph.h"
 #include "multiple_alignment.h"
 #include "GraphCompare.h"
 #include "ErrorCorrectProcess.h"
@@ -30,7 +31,8 @@ class PairedDeBruijnHaplotypeBuilder
 {
     public:
 
-        PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& parameters);
+        // The graph is reset and reused for each run
+        PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& parameters, LocalDeBruijnGraph* pGraph);
         ~PairedDeBruijnHaplotypeBuilder();
         
         // Set the string to start from
@@ -53,6 +55,7 @@ class PairedDeBruijnHaplotypeBuilder
         //
         GraphCompareParameters m_parameters;
         std::string m_startingKmer;
+        LocalDeBruijnGraph* m_pGraph;
 };
 
 #endif
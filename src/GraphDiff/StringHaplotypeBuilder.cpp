@@ -433,12 +433,12 @@ void StringHaplotypeBuilder::correctReads(StringVector* reads)
 //
 void StringHaplotypeBuilder::trimTip(Vertex* x, EdgeDir direction)
 {
-    EdgePtrVec x_edges = x->getEdges(direction);
+    EdgePtrRange x_edges = x->getEdges(direction);
     if(x_edges.size() > 0)
         return; // not a tip
 
     // Check if we should recurse to the neighbors of x
-    EdgePtrVec x_opp_edges = x->getEdges(!direction);
+    EdgePtrRange x_opp_edges = x->getEdges(!direction);
     
     Vertex* x_neighbor = NULL;
     if(x_opp_edges.size() == 1)
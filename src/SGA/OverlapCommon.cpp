@@ -24,21 +24,41 @@ void OverlapCommon::parseHitsString(const std::string& hitString,
                                     OverlapVector& outVector, 
                                     bool& isSubstring)
 {
-    OverlapVector outvec;
     std::istringstream convertor(hitString);
 
-    sumBlockSize = 0;
     // Read the overlap blocks for a read
     size_t numBlocks;
     convertor >> readIdx >> isSubstring >> numBlocks;
 
     //std::cout << "<Read> idx: " << readIdx << " count: " << numBlocks << "\n";
+    OverlapBlockList blocks;
     for(size_t i = 0; i < numBlocks; ++i)
     {
         // Read the block
         OverlapBlock record;
         convertor >> record;
         //std::cout << "\t" << record << "\n";
+        blocks.push_back(record);
+    }
+
+    convertBlocksToOverlaps(readIdx, blocks, pQueryRIT, pTargetRIT, pFwdSAI, pRevSAI, bCheckIDs, sumBlockSize, outVector);
+}
+
+// Convert the overlap blocks of a read into a vector of overlaps
+void OverlapCommon::convertBlocksToOverlaps(size_t readIdx,
+                                            const OverlapBlockList& blocks,
+                                            const ReadInfoTable* pQueryRIT, 
+                                            const ReadInfoTable* pTargetRIT, 
+                                            const SuffixArray* pFwdSAI, 
+                                            const SuffixArray* pRevSAI, 
+                                            bool bCheckIDs,
+                                            size_t& sumBlockSize,
+                                            OverlapVector& outVector)
+{
+    sumBlockSize = 0;
+    for(OverlapBlockList::const_iterator iter = blocks.begin(); iter != blocks.end(); ++iter)
+    {
+        const OverlapBlock& record = *iter;
 
         // Iterate through the range and write the overlaps
         for(int64_t j = record.ranges.interval[0].lower; j <= record.ranges.interval[0].upper; ++j)
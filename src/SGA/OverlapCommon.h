@@ -15,6 +15,7 @@
 #include "SGACommon.h"
 #include "Timer.h"
 #include "ReadInfoTable.h"
+#include "OverlapBlock.h"
 
 namespace OverlapCommon
 {
@@ -30,6 +31,17 @@ void parseHitsString(const std::string& hitString,
                      size_t& sumBlockSize,
                      OverlapVector& outVector, 
                      bool& isSubstring);
+
+// Convert the overlap blocks found for a read into a vector of overlaps
+void convertBlocksToOverlaps(size_t readIdx,
+                             const OverlapBlockList& blocks,
+                             const ReadInfoTable* pQueryRIT, 
+                             const ReadInfoTable* pTargetRIT, 
+                             const SuffixArray* pFwdSAI, 
+                             const SuffixArray* pRevSAI,
+                             bool bCheckIDs,
+                             size_t& sumBlockSize,
+                             OverlapVector& outVector);
 };
 
 #endif
@@ -26,6 +26,7 @@
 #define RSAI_EXT ".rsai"
 #define SSA_EXT ".ssa"
 #define POPIDX_EXT ".popidx"
+#define DELTA_EXT ".delta" // index of reads added with sga index --append --delta
 
 // Default values
 #define DEFAULT_MIN_OVERLAP 45
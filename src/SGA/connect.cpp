@@ -28,12 +28,62 @@
 #include "gmap.h"
 #include "SGSearch.h"
 #include "api/BamReader.h"
+#include <pthread.h>
+#include <queue>
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
 
 //#define DEBUG_CONNECT 1
 
+// Number of read pairs that are searched together
+static const size_t CONNECT_BATCH_SIZE = 10000;
+
+// Maximum number of batches that the reader thread reads ahead
+static const size_t CONNECT_MAX_QUEUED_BATCHES = 4;
+
 // Structs
 
+// A read pair and the walks found between its ends
+struct ConnectPair
+{
+    BamTools::BamAlignment record1;
+    BamTools::BamAlignment record2;
+
+    bool bothMapped;
+    SGWalkVector walks;
+
+    // The fragment strings of the walks. Only set if
+    // the number of walks is between 1 and maxPaths
+    StringVector fragments;
+};
+typedef std::vector<ConnectPair> ConnectPairBatch;
+
+// Reads batches of pairs from the BAM file, optionally ahead of
+// the searches on a separate thread
+struct ConnectPairReader
+{
+    BamTools::BamReader* pBamReader;
+    BamTools::BamAlignment record1;
+    BamTools::BamAlignment record2;
+    bool eof;
+
+    // Queue of batches read by the thread. An empty batch is 
+    // never queued, the thread sets done instead.
+    std::queue<ConnectPairBatch*> queue;
+    bool done;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+};
+
 // Functions
+bool readPair(ConnectPairReader* pReader, ConnectPair& pair);
+ConnectPairBatch* readBatch(ConnectPairReader* pReader);
+void* readerThread(void* obj);
+ConnectPairBatch* getNextBatch(ConnectPairReader* pReader, bool threaded);
+void searchPair(const StringGraph* pGraph, const BamTools::RefVector& referenceVector, size_t maxPaths, ConnectPair& pair);
 void markWalkVertices(SGWalk& walk, GraphColor color);
 void writeWalk(const std::string& name, int walkIdx, const std::string& fragment, std::ostream* pWriter);
 
@@ -55,7 +105,7 @@ static const char *CONNECT_USAGE_MESSAGE =
 "\n"
 "      --help                           display this help and exit\n"
 "      -v, --verbose                    display verbose output\n"
-//"      -t, --threads=NUM                use NUM threads to compute the overlaps (default: 1)\n"
+"      -t, --threads=NUM                use NUM threads to search for walks between the pairs (default: 1)\n"
 "      -l, --min-distance=LEN           minimum expected distance between the PE reads (start to end). Default: 150.\n"
 "      -m, --max-distance=LEN           maximum expected distance between the PE reads (start to end). This option specifies\n"
 "                                       how long the search should proceed for. Default: 250\n"
@@ -194,200 +244,144 @@ int connectMain(int argc, char** argv)
     // In heterozygous SV mode, write up to 2 paths
     size_t maxPaths = (opt::hetSVMode ? 2 : 1);
 
-    BamTools::BamAlignment record1;
-    BamTools::BamAlignment record2;
-    bool done = false;
-
     const BamTools::RefVector& referenceVector = pBamReader->GetReferenceData();
-    while(!done)
-    {
-        // Read a pair from the BAM
-        // Read record 1. Skip secondary alignments of the previous pair
-        do
-        {
-            if(!pBamReader->GetNextAlignment(record1))
-            {
-                done = true;
-                break;
-            }
-        } while(!record1.IsPrimaryAlignment());
-
-        // Stop if no alignment could be parsed from the stream
-        if(done)
-            break;
-
-        // Read record 2. Skip any 
-        do
-        {
-            if(!pBamReader->GetNextAlignment(record2))
-            {
-                done = true;
-                break;
-            }
-        } while(!record2.IsPrimaryAlignment());
 
-        // If this read failed, there is a mismatch between the pairing
-        if(done)
-        {
-            std::cout << "Could not read pair for read: " << record1.Name << "\n";
-        }
-    
-        if(!record1.IsMapped() || !record2.IsMapped())
+    // The pairs are read in batches. The walks for the pairs of a batch are found in parallel
+    // while the reader thread reads the next batch. The results are then written out in
+    // the order of the BAM file.
+    bool threaded = opt::numThreads > 1;
+    ConnectPairReader reader;
+    reader.pBamReader = pBamReader;
+    reader.eof = false;
+    reader.done = false;
+    if(threaded)
+    {
+        pthread_mutex_init(&reader.mutex, NULL);
+        pthread_cond_init(&reader.cond, NULL);
+        int ret = pthread_create(&reader.thread, 0, readerThread, &reader);
+        if(ret != 0)
         {
-            numFailedUnaligned += 1;
-            continue;
+            std::cerr << "Thread creation failed with error " << ret << ", aborting" << std::endl;
+            exit(EXIT_FAILURE);
         }
+    }
 
-        // Ensure the pairing is correct
-        assert(record1.Name == record2.Name);
-        
-        std::string vertexID1 = referenceVector[record1.RefID].RefName;
-        std::string vertexID2 = referenceVector[record2.RefID].RefName;
-
-        // Get the vertices for this pair using the mapped IDs
-        Vertex* pX = pGraph->getVertex(vertexID1);
-        Vertex* pY = pGraph->getVertex(vertexID2);
-
-
-        // Ensure that the vertices are found
-        assert(pX != NULL && pY != NULL);
-
-#ifdef DEBUG_CONNECT
-        std::cout << "Finding path from " << vertexID1 << " to " << vertexID2 << "\n";
+#if HAVE_OPENMP
+    omp_set_num_threads(opt::numThreads);
 #endif
 
-        EdgeDir walkDirectionXOut = ED_SENSE;
-        EdgeDir walkDirectionYIn = ED_SENSE;
-
-        // Flip walk directions if the alignment is to the reverse strand
-        if(record1.IsReverseStrand())
-            walkDirectionXOut = !walkDirectionXOut;
-        
-        if(record2.IsReverseStrand())
-            walkDirectionYIn = !walkDirectionYIn;
-
-        int fromX = walkDirectionXOut == ED_SENSE ? record1.Position : record1.GetEndPosition();
-        int toY = walkDirectionYIn == ED_SENSE ? record2.Position : record2.GetEndPosition();
+    ConnectPairBatch* pBatch;
+    while((pBatch = getNextBatch(&reader, threaded)) != NULL)
+    {
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for(int64_t i = 0; i < (int64_t)pBatch->size(); ++i)
+            searchPair(pGraph, referenceVector, maxPaths, (*pBatch)[i]);
 
-        // Calculate the amount of contig X that already covers the fragment
-        // Using this number, we calculate how far we should search
-        int coveredX = walkDirectionXOut == ED_SENSE ? pX->getSeqLen() - fromX : fromX;
-        int maxWalkDistance = opt::maxDistance - coveredX;
+        for(size_t pi = 0; pi < pBatch->size(); ++pi)
+        {
+            ConnectPair& pair = (*pBatch)[pi];
+            const BamTools::BamAlignment& record1 = pair.record1;
+            const BamTools::BamAlignment& record2 = pair.record2;
+            if(!pair.bothMapped)
+            {
+                numFailedUnaligned += 1;
+                continue;
+            }
 
-        SGWalkVector walks;
-        SGSearch::findWalks(pX, pY, walkDirectionXOut, maxWalkDistance, 10000, true, walks);
+            SGWalkVector& walks = pair.walks;
 
-        // Mark used vertices in the graph
-        // If the entire path was resolved, mark black
-        // otherwise mark as red
-        GraphColor used_color = (walks.size() <= maxPaths) ? GC_BLACK : GC_RED;
+            // Mark used vertices in the graph
+            // If the entire path was resolved, mark black
+            // otherwise mark as red
+            GraphColor used_color = (walks.size() <= maxPaths) ? GC_BLACK : GC_RED;
 
-        for(size_t i = 0; i < walks.size(); i +=1 )
-            markWalkVertices(walks[i], used_color);
+            for(size_t i = 0; i < walks.size(); i +=1 )
+                markWalkVertices(walks[i], used_color);
 
-        if(!walks.empty() && walks.size() <= maxPaths)
-        {
-            for(size_t i = 0; i < walks.size(); ++i)
+            if(!walks.empty() && walks.size() <= maxPaths)
             {
-                // Validate that the path is as expected
-                // This has 2 conditions:
-                // 1) The inferred fragment is orientated correctly
-                // 2) The fragment size is within the expected range
-                bool correctOrientation = true;
-                WARN_ONCE("check orientation of result");
-
-                std::string fragment = walks[i].getFragmentString(pX, 
-                                                                  pY, 
-                                                                  fromX,
-                                                                  toY,
-                                                                  walkDirectionXOut,
-                                                                  walkDirectionYIn);
-
-                // Calculate the seqcoord on the path string representing the paired end fragment
-                int fragSize = fragment.length();
-                bool correctSize = !fragment.empty();
-
-                if(fragSize < opt::minDistance)
+                for(size_t i = 0; i < walks.size(); ++i)
                 {
-                    correctSize = false;
-                    numPathsRejectLow += 1;
+                    // Validate that the path is as expected
+                    // This has 2 conditions:
+                    // 1) The inferred fragment is orientated correctly
+                    // 2) The fragment size is within the expected range
+                    bool correctOrientation = true;
+                    WARN_ONCE("check orientation of result");
+
+                    const std::string& fragment = pair.fragments[i];
+
+                    // Calculate the seqcoord on the path string representing the paired end fragment
+                    int fragSize = fragment.length();
+                    bool correctSize = !fragment.empty();
+
+                    if(fragSize < opt::minDistance)
+                    {
+                        correctSize = false;
+                        numPathsRejectLow += 1;
+                    }
+
+                    if(fragSize > opt::maxDistance)
+                    {
+                        correctSize = false;
+                        numPathsRejectHigh += 1;
+                    }
+
+
+                    if(correctOrientation && correctSize)
+                    {                    
+                        writeWalk(getPairBasename(record1.Name), i, fragment, pWriter);
+                        
+                        // Mark all the vertices in this walk as resolved
+                        markWalkVertices(walks[i], GC_BLACK);
+                        numPairsResolved += 1;
+                    }
                 }
+            }
+            else
+            {
+                if(walks.empty())
+                    numFailedNoPath += 1;
+                else if(walks.size() > maxPaths)
+                    numFailedMultiPaths += 1;
 
-                if(fragSize > opt::maxDistance)
+                if(opt::bWriteUnresolved)
                 {
-                    correctSize = false;
-                    numPathsRejectHigh += 1;
-                }
+                    // Write the unconnected reads
+                    SeqRecord unresolved1;
+                    unresolved1.id = record1.Name;
+                    unresolved1.seq = record1.QueryBases;
+                    
+                    SeqRecord unresolved2;
+                    unresolved2.id = record2.Name;
+                    unresolved2.seq = record2.QueryBases;
 
+                    unresolved1.write(*pWriter);
+                    unresolved2.write(*pWriter);
 
-                if(correctOrientation && correctSize)
-                {                    
-                    writeWalk(getPairBasename(record1.Name), i, fragment, pWriter);
-                    
-                    // Mark all the vertices in this walk as resolved
-                    markWalkVertices(walks[i], GC_BLACK);
-                    numPairsResolved += 1;
+                    numUnresolvedWrote += 2;
                 }
             }
+            numPairsAttempted += 1;
+            
+            if(numPairsAttempted % 50000 == 0)
+                printf("[sga connect] Processed %d pairs\n", numPairsAttempted);
         }
-        else
-        {
-            if(walks.empty())
-            {
-                /*
-                std::cout << "No walk found for pair: \n";
-                std::cout << record1.Name << " " << vertexID1 << " -> " << vertexID2 << "\n";
-                std::cout << "Map qual: " << record1.MapQuality << " " << record2.MapQuality << "\n";
-                int xa1 = 0;
-                int xa2 = 0;
-                record1.GetTag("X1", xa1);
-                record2.GetTag("X1", xa2);
-                std::cout << "Num sub1: " << xa1 << "\n";
-                std::cout << "Num sub2: " << xa2 << "\n";
-                std::cout << "Total alts: " << (xa1 + xa2) << "\n";
-                */
-                numFailedNoPath += 1;
-            }
-            else if(walks.size() > maxPaths)
-            {
-                /*
-                for(size_t i = 0; i < walks.size(); ++i)
-                {
-                    std::string fragment = walks[i].getFragmentString(pX, 
-                                                                      pY, 
-                                                                      fromX,
-                                                                      toY,
-                                                                      walkDirectionXOut,
-                                                                      walkDirectionYIn);
-
-                    //std::cout << i << " " << walks[i].pathSignature() << " size: " << fragment.size() << "\n";
-                    //std::cout << ">" << i << "\n" << fragment << "\n";
-                }
-                */
+        delete pBatch;
+    }
 
-                numFailedMultiPaths += 1;
-            }
-            if(opt::bWriteUnresolved)
-            {
-                // Write the unconnected reads
-                SeqRecord unresolved1;
-                unresolved1.id = record1.Name;
-                unresolved1.seq = record1.QueryBases;
-                
-                SeqRecord unresolved2;
-                unresolved2.id = record2.Name;
-                unresolved2.seq = record2.QueryBases;
-
-                unresolved1.write(*pWriter);
-                unresolved2.write(*pWriter);
-
-                numUnresolvedWrote += 2;
-            }
+    if(threaded)
+    {
+        int ret = pthread_join(reader.thread, NULL);
+        if(ret != 0)
+        {
+            std::cerr << "Thread join failed with error " << ret << ", aborting" << std::endl;
+            exit(EXIT_FAILURE);
         }
-        numPairsAttempted += 1;
-        
-        if(numPairsAttempted % 50000 == 0)
-            printf("[sga connect] Processed %d pairs\n", numPairsAttempted);
+        pthread_mutex_destroy(&reader.mutex);
+        pthread_cond_destroy(&reader.cond);
     }
 
     //
@@ -437,10 +431,158 @@ void writeWalk(const std::string& name, int walkIdx, const std::string& fragment
     resolved.write(*pWriter);
 }
 
-// Read all the alignments for 
-bool readPairAlignments()
+// Read the next pair of primary alignments from the BAM. Returns false if no 
+// alignment could be read.
+bool readPair(ConnectPairReader* pReader, ConnectPair& pair)
+{
+    if(pReader->eof)
+        return false;
+
+    // Read record 1. Skip secondary alignments of the previous pair
+    do
+    {
+        if(!pReader->pBamReader->GetNextAlignment(pReader->record1))
+        {
+            pReader->eof = true;
+            return false;
+        }
+    } while(!pReader->record1.IsPrimaryAlignment());
+
+    // Read record 2. Skip any 
+    do
+    {
+        if(!pReader->pBamReader->GetNextAlignment(pReader->record2))
+        {
+            pReader->eof = true;
+            break;
+        }
+    } while(!pReader->record2.IsPrimaryAlignment());
+
+    // If this read failed, there is a mismatch between the pairing
+    if(pReader->eof)
+        std::cout << "Could not read pair for read: " << pReader->record1.Name << "\n";
+
+    pair.record1 = pReader->record1;
+    pair.record2 = pReader->record2;
+    return true;
+}
+
+// Read up to CONNECT_BATCH_SIZE pairs. Returns NULL if the BAM is exhausted
+ConnectPairBatch* readBatch(ConnectPairReader* pReader)
 {
-    return false;
+    ConnectPairBatch* pBatch = new ConnectPairBatch(CONNECT_BATCH_SIZE);
+    size_t n = 0;
+    while(n < CONNECT_BATCH_SIZE && readPair(pReader, (*pBatch)[n]))
+        n += 1;
+
+    if(n == 0)
+    {
+        delete pBatch;
+        return NULL;
+    }
+    pBatch->resize(n);
+    return pBatch;
+}
+
+// Thread entry point to read batches ahead of the searches
+void* readerThread(void* obj)
+{
+    ConnectPairReader* pReader = reinterpret_cast<ConnectPairReader*>(obj);
+    ConnectPairBatch* pBatch;
+    while((pBatch = readBatch(pReader)) != NULL)
+    {
+        pthread_mutex_lock(&pReader->mutex);
+        while(pReader->queue.size() >= CONNECT_MAX_QUEUED_BATCHES)
+            pthread_cond_wait(&pReader->cond, &pReader->mutex);
+        pReader->queue.push(pBatch);
+        pthread_cond_signal(&pReader->cond);
+        pthread_mutex_unlock(&pReader->mutex);
+    }
+
+    pthread_mutex_lock(&pReader->mutex);
+    pReader->done = true;
+    pthread_cond_signal(&pReader->cond);
+    pthread_mutex_unlock(&pReader->mutex);
+    return NULL;
+}
+
+// Get the next batch of pairs, either from the reader thread or directly from the BAM.
+// Returns NULL when all the pairs have been read.
+ConnectPairBatch* getNextBatch(ConnectPairReader* pReader, bool threaded)
+{
+    if(!threaded)
+        return readBatch(pReader);
+
+    pthread_mutex_lock(&pReader->mutex);
+    while(pReader->queue.empty() && !pReader->done)
+        pthread_cond_wait(&pReader->cond, &pReader->mutex);
+
+    ConnectPairBatch* pBatch = NULL;
+    if(!pReader->queue.empty())
+    {
+        pBatch = pReader->queue.front();
+        pReader->queue.pop();
+        pthread_cond_signal(&pReader->cond);
+    }
+    pthread_mutex_unlock(&pReader->mutex);
+    return pBatch;
+}
+
+// Find the walks through the graph between the ends of the pair.
+// The graph is not modified so pairs can be searched concurrently.
+void searchPair(const StringGraph* pGraph, const BamTools::RefVector& referenceVector, size_t maxPaths, ConnectPair& pair)
+{
+    const BamTools::BamAlignment& record1 = pair.record1;
+    const BamTools::BamAlignment& record2 = pair.record2;
+    pair.bothMapped = record1.IsMapped() && record2.IsMapped();
+    if(!pair.bothMapped)
+        return;
+
+    // Ensure the pairing is correct
+    assert(record1.Name == record2.Name);
+    
+    std::string vertexID1 = referenceVector[record1.RefID].RefName;
+    std::string vertexID2 = referenceVector[record2.RefID].RefName;
+
+    // Get the vertices for this pair using the mapped IDs
+    Vertex* pX = pGraph->getVertex(vertexID1);
+    Vertex* pY = pGraph->getVertex(vertexID2);
+
+    // Ensure that the vertices are found
+    assert(pX != NULL && pY != NULL);
+
+#ifdef DEBUG_CONNECT
+    std::cout << "Finding path from " << vertexID1 << " to " << vertexID2 << "\n";
+#endif
+
+    EdgeDir walkDirectionXOut = ED_SENSE;
+    EdgeDir walkDirectionYIn = ED_SENSE;
+
+    // Flip walk directions if the alignment is to the reverse strand
+    if(record1.IsReverseStrand())
+        walkDirectionXOut = !walkDirectionXOut;
+    
+    if(record2.IsReverseStrand())
+        walkDirectionYIn = !walkDirectionYIn;
+
+    int fromX = walkDirectionXOut == ED_SENSE ? record1.Position : record1.GetEndPosition();
+    int toY = walkDirectionYIn == ED_SENSE ? record2.Position : record2.GetEndPosition();
+
+    // Calculate the amount of contig X that already covers the fragment
+    // Using this number, we calculate how far we should search
+    int coveredX = walkDirectionXOut == ED_SENSE ? pX->getSeqLen() - fromX : fromX;
+    int maxWalkDistance = opt::maxDistance - coveredX;
+
+    SGSearch::findWalks(pX, pY, walkDirectionXOut, maxWalkDistance, 10000, true, pair.walks);
+
+    if(!pair.walks.empty() && pair.walks.size() <= maxPaths)
+    {
+        for(size_t i = 0; i < pair.walks.size(); ++i)
+        {
+            pair.fragments.push_back(pair.walks[i].getFragmentString(pX, pY, fromX, toY, 
+                                                                     walkDirectionXOut, walkDirectionYIn));
+        }
+    }
 }
 
 // Mark all the vertices in the walk as color 
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <sstream>
 #include <iterator>
+#include <sys/stat.h>
 #include "Util.h"
 #include "correct.h"
 #include "SuffixArray.h"
@@ -26,9 +27,12 @@
 #include "KmerDistribution.h"
 #include "BWTIntervalCache.h"
 #include "LRAlignment.h"
+#include "NumaIndexPlacement.h"
+#include "NumaUtil.h"
+#include "HugePageAllocator.h"
 
 // Functions
-int learnKmerParameters(const BWT* pBWT);
+int learnKmerParameters(const BWTIndexSet& indices);
 
 //
 // Getopt
@@ -54,6 +58,13 @@ static const char *CORRECT_USAGE_MESSAGE =
 "                                       less memory at the cost of higher runtime. This value must be a power of 2 (default: 128)\n"
 "      -a, --algorithm=STR              specify the correction algorithm to use. STR must be one of kmer, hybrid, overlap. (default: kmer)\n"
 "          --metrics=FILE               collect error correction metrics (error rate by position in read, etc) and write them to FILE\n"
+"          --numa=POLICY                place the FM-index and its interval cache on the NUMA nodes according to POLICY.\n"
+"                                       With interleave the pages of the index are spread across the nodes. With replicate\n"
+"                                       each node gets a copy of the index. In both cases the threads are pinned to the nodes\n"
+"                                       round-robin (default: none)\n"
+"          --huge-pages=MODE            back the FM-index arrays with huge pages to reduce TLB misses. MODE is thp to use\n"
+"                                       transparent huge pages or hugetlb to use reserved 1 GB/2 MB pages, falling back\n"
+"                                       to transparent huge pages (default: none)\n"
 "\nKmer correction parameters:\n"
 "      -k, --kmer-size=N                The length of the kmer to use. (default: 31)\n"
 "      -x, --kmer-threshold=N           Attempt to correct kmers that are seen less than N times. (default: 3)\n"
@@ -102,13 +113,15 @@ namespace opt
     static int numKmerRounds = 10;
     static bool bLearnKmerParams = false;
     static int intervalCacheLength = 10;
+    static NumaPlacementPolicy numaPolicy = NPP_NONE;
+    static HugePageMode hugePageMode = HPM_NONE;
 
     static ErrorCorrectAlgorithm algorithm = ECA_KMER;
 }
 
 static const char* shortopts = "p:m:d:e:t:l:s:o:r:b:a:c:k:x:i:v";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_METRICS, OPT_DISCARD, OPT_LEARN };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_METRICS, OPT_DISCARD, OPT_LEARN, OPT_NUMA, OPT_HUGEPAGES };
 
 static const struct option longopts[] = {
     { "verbose",       no_argument,       NULL, 'v' },
@@ -132,6 +145,8 @@ static const struct option longopts[] = {
     { "help",          no_argument,       NULL, OPT_HELP },
     { "version",       no_argument,       NULL, OPT_VERSION },
     { "metrics",       required_argument, NULL, OPT_METRICS },
+    { "numa",          required_argument, NULL, OPT_NUMA },
+    { "huge-pages",    required_argument, NULL, OPT_HUGEPAGES },
     { NULL, 0, NULL, 0 }
 };
 
@@ -145,6 +160,7 @@ int correctMain(int argc, char** argv)
     std::cout << "Correcting sequencing errors for " << opt::readsFile << "\n";
 
     // Load indices
+    HugePages::setMode(opt::hugePageMode);
     BWT* pBWT = new BWT(opt::prefix + BWT_EXT, opt::sampleRate);
     BWT* pRBWT = NULL;
     SampledSuffixArray* pSSA = NULL;
@@ -153,17 +169,27 @@ int correctMain(int argc, char** argv)
         pSSA = new SampledSuffixArray(opt::prefix + SAI_EXT, SSA_FT_SAI);
 
     BWTIntervalCache* pIntervalCache = new BWTIntervalCache(opt::intervalCacheLength, pBWT);
+    if(opt::hugePageMode != HPM_NONE)
+        HugePages::printReport();
+
+    // Include the reads added with sga index --append --delta in the k-mer counts
+    BWT* pDeltaBWT = NULL;
+    struct stat delta_s;
+    std::string delta_filename = opt::prefix + DELTA_EXT + BWT_EXT;
+    if(stat(delta_filename.c_str(), &delta_s) == 0)
+        pDeltaBWT = new BWT(delta_filename, opt::sampleRate);
 
     BWTIndexSet indexSet;
     indexSet.pBWT = pBWT;
     indexSet.pRBWT = pRBWT;
+    indexSet.pDeltaBWT = pDeltaBWT;
     indexSet.pSSA = pSSA;
     indexSet.pCache = pIntervalCache;
 
     // Learn the parameters of the kmer corrector
     if(opt::bLearnKmerParams)
     {
-        int threshold = learnKmerParameters(pBWT);
+        int threshold = learnKmerParameters(indexSet);
         if(threshold != -1)
             CorrectionThresholds::Instance().setBaseMinSupport(threshold);
     }
@@ -205,10 +231,23 @@ int correctMain(int argc, char** argv)
     else
     {
         // Parallel mode
+        // Each thread uses the copy of the FM-index and its interval cache
+        // on the NUMA node it is pinned to
+        NumaIndexPlacement placement(opt::numaPolicy);
+        placement.addBWT(pBWT);
+        placement.addCache(pIntervalCache);
+        NumaUtil::setWorkerPinning(placement.isPinningRequired());
+        if(opt::numaPolicy != NPP_NONE)
+            placement.printMemoryUsage();
+
         std::vector<ErrorCorrectProcess*> processorVector;
         for(int i = 0; i < opt::numThreads; ++i)
         {
-            ErrorCorrectProcess* pProcessor = new ErrorCorrectProcess(ecParams);
+            ErrorCorrectParameters threadParams = ecParams;
+            int node = NumaUtil::getWorkerNode(i);
+            threadParams.indices.pBWT = placement.getBWT(0, node);
+            threadParams.indices.pCache = placement.getCache(0, node);
+            ErrorCorrectProcess* pProcessor = new ErrorCorrectProcess(threadParams);
             processorVector.push_back(pProcessor);
         }
         
@@ -231,6 +270,7 @@ int correctMain(int argc, char** argv)
     }
 
     delete pBWT;
+    delete pDeltaBWT;
     delete pIntervalCache;
     if(pRBWT != NULL)
         delete pRBWT;
@@ -251,27 +291,15 @@ int correctMain(int argc, char** argv)
 }
 
 // Learn parameters of the kmer corrector
-int learnKmerParameters(const BWT* pBWT)
+int learnKmerParameters(const BWTIndexSet& indices)
 {
     std::cout << "Learning kmer parameters\n";
-    srand(time(0));
     size_t n_samples = 10000;
+    unsigned int seed = time(0);
 
     //
     KmerDistribution kmerDistribution;
-    int k = opt::kmerLength;
-    for(size_t i = 0; i < n_samples; ++i)
-    {
-        std::string s = BWTAlgorithms::sampleRandomString(pBWT);
-        int n = s.size();
-        int nk = n - k + 1;
-        for(int j = 0; j < nk; ++j)
-        {
-            std::string kmer = s.substr(j, k);
-            int count = BWTAlgorithms::countSequenceOccurrences(kmer, pBWT);
-            kmerDistribution.add(count);
-        }
-    }
+    BWTAlgorithms::sampleKmerCounts(indices, opt::kmerLength, n_samples, seed, opt::numThreads, kmerDistribution);
 
     //
     kmerDistribution.print(75);
@@ -332,6 +360,8 @@ void parseCorrectOptions(int argc, char** argv)
             case OPT_LEARN: opt::bLearnKmerParams = true; break;
             case OPT_DISCARD: bDiscardReads = true; break;
             case OPT_METRICS: arg >> opt::metricsFile; break;
+            case OPT_NUMA: opt::numaPolicy = NumaIndexPlacement::parsePolicy(arg.str()); break;
+            case OPT_HUGEPAGES: opt::hugePageMode = HugePages::parseMode(arg.str()); break;
             case OPT_HELP:
                 std::cout << CORRECT_USAGE_MESSAGE;
                 exit(EXIT_SUCCESS);
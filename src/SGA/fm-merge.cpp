@@ -103,7 +103,7 @@ int FMMergeMain(int argc, char** argv)
     if(opt::numThreads <= 1)
     {
         printf("[%s] starting serial-mode read merging\n", PROGRAM_IDENT);
-        FMMergeProcess processor(pOverlapper, opt::minOverlap, &markedReads);
+        FMMergeProcess processor(pOverlapper, opt::minOverlap, &markedReads, NULL);
         SequenceProcessFramework::processSequencesSerial<SequenceWorkItem,
                                                          FMMergeResult, 
                                                          FMMergeProcess, 
@@ -113,10 +113,15 @@ int FMMergeMain(int argc, char** argv)
     {
         printf("[%s] starting parallel-mode read merging computation with %d threads\n", PROGRAM_IDENT, opt::numThreads);
         
+        // The threads claim the reads of the unipath they are building in this
+        // bitvector with atomic compare-and-swap updates so that they do not
+        // build the same unipath at once
+        BitVector claimedReads(pBWT->getNumStrings());
+
         std::vector<FMMergeProcess*> processorVector;
         for(int i = 0; i < opt::numThreads; ++i)
         {
-            FMMergeProcess* pProcessor = new FMMergeProcess(pOverlapper, opt::minOverlap, &markedReads);
+            FMMergeProcess* pProcessor = new FMMergeProcess(pOverlapper, opt::minOverlap, &markedReads, &claimedReads);
             processorVector.push_back(pProcessor);
         }
 
@@ -124,7 +129,17 @@ int FMMergeMain(int argc, char** argv)
                                                          FMMergeResult, 
                                                          FMMergeProcess, 
                                                          FMMergePostProcess>(opt::readsFile, processorVector, &postProcessor);
-        
+
+        // Merge the reads whose unipath was abandoned after a conflicting claim.
+        // There is a single thread now so the claims are not used.
+        std::vector<SequenceWorkItem> deferredItems = postProcessor.getDeferredItems();
+        postProcessor.clearDeferredItems();
+        printf("[%s] merging %zu deferred reads\n", PROGRAM_IDENT, deferredItems.size());
+
+        FMMergeProcess serialProcessor(pOverlapper, opt::minOverlap, &markedReads, NULL);
+        for(size_t i = 0; i < deferredItems.size(); ++i)
+            postProcessor.process(deferredItems[i], serialProcessor.process(deferredItems[i]));
+
         for(size_t i = 0; i < processorVector.size(); ++i)
         {
             delete processorVector[i];
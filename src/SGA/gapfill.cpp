@@ -21,14 +21,11 @@
 #include "GapFillProcess.h"
 #include "gapfill.h"
 
-// Defines to clarify awful template function calls
-#define PROCESS_GAPFILL_SERIAL SequenceProcessFramework::processSequencesSerial<SequenceWorkItem, GraphCompareResult, \
-                                                                                GraphCompare, GraphCompareAggregateResults>
+// The number of scaffolds, and the total length of the scaffolds, 
+// that are read in before their gaps are processed
+static const size_t GAPFILL_BATCH_SCAFFOLDS = 1024;
+static const size_t GAPFILL_BATCH_BASES = 50000000;
 
-#define PROCESS_GAPFILL_PARALLEL SequenceProcessFramework::processSequencesParallel<SequenceWorkItem, GraphCompareResult, \
-                                                                                    GraphCompare, GraphCompareAggregateResults>
-
-   
 //
 // Getopt
 //
@@ -113,19 +110,42 @@ int gapfillMain(int argc, char** argv)
     parameters.endKmer = opt::endKmer;
     parameters.stride = opt::stride;
     parameters.kmerThreshold = opt::kmerThreshold;
+    parameters.numThreads = opt::numThreads;
     parameters.verbose = opt::verbose;
 
     GapFillProcess processor(parameters);
 
     std::ostream* pWriter = createWriter(opt::outFile);
 
+    // Read the scaffolds in batches. The gaps of a batch are filled
+    // in parallel then the scaffolds are written in the input order.
     SeqReader reader(opt::scaffoldFile, SRF_NO_VALIDATION | SRF_KEEP_CASE);
     SeqRecord record;
-    while(reader.get(record))
+    bool done = false;
+    while(!done)
     {
-        GapFillResult result = processor.processScaffold(record.seq.toString());
-        record.seq = result.scaffold;
-        record.write(*pWriter);
+        SeqRecordVector records;
+        StringVector scaffolds;
+        size_t numBases = 0;
+        while(scaffolds.size() < GAPFILL_BATCH_SCAFFOLDS && numBases < GAPFILL_BATCH_BASES)
+        {
+            if(!reader.get(record))
+            {
+                done = true;
+                break;
+            }
+            records.push_back(record);
+            scaffolds.push_back(record.seq.toString());
+            numBases += scaffolds.back().length();
+        }
+
+        GapFillResultVector results;
+        processor.processScaffolds(scaffolds, results);
+        for(size_t i = 0; i < records.size(); ++i)
+        {
+            records[i].seq = results[i].scaffold;
+            records[i].write(*pWriter);
+        }
     }
 
     // Cleanup
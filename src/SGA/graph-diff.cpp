@@ -505,6 +505,12 @@ void parseGraphDiffOptions(int argc, char** argv)
         die = true;
     }
 
+    if((opt::deBruijnMode || opt::deBruijnPairedMode) && opt::kmer > (int)LocalDeBruijnGraph::MAX_K)
+    {
+        std::cerr << SUBPROGRAM ": the k-mer size can be at most " << LocalDeBruijnGraph::MAX_K << " with the de Bruijn graph algorithms\n";
+        die = true;
+    }
+
     if(opt::baseFile.empty())
         opt::referenceMode = true;
 
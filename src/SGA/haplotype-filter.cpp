@@ -22,6 +22,10 @@
 #include "SGAStats.h"
 #include "HashMap.h"
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 // Functions
 // Add the log-scaled values l1 and l2 using a transform to avoid
 // precision errors
@@ -42,6 +46,16 @@ bool applyFilter(const std::string& kmer, const BWTIndexSet& indices);
 // Get the number of times the kmer appears in each samples
 std::vector<size_t> getPopulationCoverageCount(const std::string& kmer, const BWTIndexSet& indices);
 
+// Compute the segregation statistics for a single VCF record and return the annotated record.
+// Diagnostic output is written to log.
+std::string filterVCFRecord(const std::string& line,
+                            const HashMap<std::string, size_t>& kmer_to_haplotype,
+                            const StringVector& haplotypes,
+                            const std::vector<double>& depths,
+                            const BWTIndexSet& indices,
+                            const BWTIndexSet& referenceIndex,
+                            std::ostream& log);
+
 // Get the mean depth of a random k-mer in each sample
 std::vector<double> getSampleMeanKmerDepth(size_t k, const BWTIndexSet& indices);
 
@@ -89,7 +103,7 @@ static const char *HAPLOTYPE_FILTER_USAGE_MESSAGE =
 "          --reference=STR              load the reference genome from FILE\n"
 "          --haploid                    force use of the haploid model\n"
 "      -o, --out-prefix=STR             write the passed haplotypes and variants to STR.vcf and STR.fa\n" 
-"      -t, --threads=NUM                use NUM threads to compute the overlaps (default: 1)\n"
+"      -t, --threads=NUM                use NUM threads to process the variants (default: 1)\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
 static const char* PROGRAM_IDENT =
@@ -180,6 +194,8 @@ int haplotypeFilterMain(int argc, char** argv)
     std::ofstream outFile(opt::outFile.c_str());
     std::ifstream inFile(opt::vcfFile.c_str());
 
+    // Read the records of the VCF file. The header is written immediately.
+    StringVector records;
     std::string line;
     while(getline(inFile, line))
     {
@@ -194,69 +210,28 @@ int haplotypeFilterMain(int argc, char** argv)
             outFile << line << "\n";
             continue;
         }
+        records.push_back(line);
+    }
 
-        StringVector fields = split(line, '\t');
-        std::string vcf_kmer = fields[2];
-        
-        // Load the haplotype with this kmer
-        HashMap<std::string, size_t>::iterator iter = kmer_to_haplotype.find(vcf_kmer);
-        if(iter == kmer_to_haplotype.end())
-            iter = kmer_to_haplotype.find(reverseComplement(vcf_kmer));
-
-        assert(iter != kmer_to_haplotype.end());
-        std::string& haplotype = haplotypes[iter->second];
-        
-        printf("Kmer --- %s\n", vcf_kmer.c_str());
-        printf("Haplotype --- %s\n", haplotype.c_str());
-
-        // Find the highest-depth non-reference kmer to use to calculate the segregation stats
-        size_t best_index = 0;
-        size_t best_count = 0;
-        size_t nk = haplotype.size() - opt::k + 1;
-        for(size_t i = 0; i < nk; ++i)
-        {
-            std::string seg_kmer = haplotype.substr(i, opt::k);
-            size_t ref_c = BWTAlgorithms::countSequenceOccurrences(seg_kmer, referenceIndex);
-            printf("seg_kmer --- %s ref_c? %zu\n", seg_kmer.c_str(), ref_c);
-            if(ref_c == 0)
-            {
-                size_t read_c = BWTAlgorithms::countSequenceOccurrences(seg_kmer, indices);
-                if(read_c > best_count)
-                {
-                    best_count = read_c;
-                    best_index = i;
-                }
-                printf("read_c: %zu\n", read_c);
-            }
-        }
-        
-        double LM = 0.f;
-        size_t total_coverage = 0;
-        if(best_count > 0)
-        {
-            std::string kmer = haplotype.substr(best_index, opt::k);
-            std::vector<size_t> sample_coverage = getPopulationCoverageCount(kmer, indices);
-            std::copy(sample_coverage.begin(), sample_coverage.end(), std::ostream_iterator<size_t>(std::cout, " "));
-            std::cout << "\n";
-          
-            for(size_t i = 0; i < sample_coverage.size(); ++i)
-                total_coverage += sample_coverage[i];
-            
-            if(opt::bHaploid)
-                LM = LMHaploidNonUniform(depths, sample_coverage);
-            else
-                LM = LMDiploidNonUniform(depths, sample_coverage);
-        }
+    // Process the records in parallel. The annotated records and the
+    // diagnostic output are buffered and written in the input order.
+    StringVector out_records(records.size());
+    StringVector out_logs(records.size());
+#if HAVE_OPENMP
+    omp_set_num_threads(opt::numThreads);
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for(int64_t i = 0; i < (int64_t)records.size(); ++i)
+    {
+        std::stringstream log;
+        out_records[i] = filterVCFRecord(records[i], kmer_to_haplotype, haplotypes, depths, indices, referenceIndex, log);
+        out_logs[i] = log.str();
+    }
 
-        std::stringstream lmss;
-        lmss << fields[7];
-        lmss << ";LM=" << LM << ";";
-        lmss << "O=" << total_coverage << ";";
-        fields[7] = lmss.str();
-        for(size_t i = 0; i < fields.size()-1; ++i)
-            outFile << fields[i] << "\t";
-        outFile << fields[fields.size()-1];
-        outFile << "\n";
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        std::cout << out_logs[i];
+        outFile << out_records[i] << "\n";
     }
     
     // Cleanup
@@ -272,6 +247,81 @@ int haplotypeFilterMain(int argc, char** argv)
     return 0;
 }
 
+//
+std::string filterVCFRecord(const std::string& line,
+                            const HashMap<std::string, size_t>& kmer_to_haplotype,
+                            const StringVector& haplotypes,
+                            const std::vector<double>& depths,
+                            const BWTIndexSet& indices,
+                            const BWTIndexSet& referenceIndex,
+                            std::ostream& log)
+{
+    StringVector fields = split(line, '\t');
+    std::string vcf_kmer = fields[2];
+    
+    // Load the haplotype with this kmer
+    HashMap<std::string, size_t>::const_iterator iter = kmer_to_haplotype.find(vcf_kmer);
+    if(iter == kmer_to_haplotype.end())
+        iter = kmer_to_haplotype.find(reverseComplement(vcf_kmer));
+
+    assert(iter != kmer_to_haplotype.end());
+    const std::string& haplotype = haplotypes[iter->second];
+    
+    log << "Kmer --- " << vcf_kmer << "\n";
+    log << "Haplotype --- " << haplotype << "\n";
+
+    // Find the highest-depth non-reference kmer to use to calculate the segregation stats
+    size_t best_index = 0;
+    size_t best_count = 0;
+    size_t nk = haplotype.size() - opt::k + 1;
+    for(size_t i = 0; i < nk; ++i)
+    {
+        std::string seg_kmer = haplotype.substr(i, opt::k);
+        size_t ref_c = BWTAlgorithms::countSequenceOccurrences(seg_kmer, referenceIndex);
+        log << "seg_kmer --- " << seg_kmer << " ref_c? " << ref_c << "\n";
+        if(ref_c == 0)
+        {
+            size_t read_c = BWTAlgorithms::countSequenceOccurrences(seg_kmer, indices);
+            if(read_c > best_count)
+            {
+                best_count = read_c;
+                best_index = i;
+            }
+            log << "read_c: " << read_c << "\n";
+        }
+    }
+    
+    double LM = 0.f;
+    size_t total_coverage = 0;
+    if(best_count > 0)
+    {
+        std::string kmer = haplotype.substr(best_index, opt::k);
+        std::vector<size_t> sample_coverage = getPopulationCoverageCount(kmer, indices);
+        std::copy(sample_coverage.begin(), sample_coverage.end(), std::ostream_iterator<size_t>(log, " "));
+        log << "\n";
+      
+        for(size_t i = 0; i < sample_coverage.size(); ++i)
+            total_coverage += sample_coverage[i];
+        
+        if(opt::bHaploid)
+            LM = LMHaploidNonUniform(depths, sample_coverage);
+        else
+            LM = LMDiploidNonUniform(depths, sample_coverage);
+    }
+
+    std::stringstream lmss;
+    lmss << fields[7];
+    lmss << ";LM=" << LM << ";";
+    lmss << "O=" << total_coverage << ";";
+    fields[7] = lmss.str();
+
+    std::stringstream out;
+    for(size_t i = 0; i < fields.size()-1; ++i)
+        out << fields[i] << "\t";
+    out << fields[fields.size()-1];
+    return out.str();
+}
+
 //
 void runSimulation()
 {
@@ -990,26 +1040,37 @@ std::vector<double> simulateSampleKmerDepths(size_t mean_depth, size_t N)
 }
 
 //
+// The read indices of the k-mer occurrences are computed directly from the
+// sampled suffix array. Occurrence intervals of MAX_COVERAGE_INTERVAL or more
+// entries are skipped without any lookups.
 std::vector<size_t> getPopulationCoverageCount(const std::string& kmer, const BWTIndexSet& indices)
 {
-    //
-    StringVector kmers;
-    kmers.push_back(kmer);
-    kmers.push_back(reverseComplement(kmer));
-    SeqRecordVector records;
-    HapgenUtil::extractHaplotypeReads(kmers, indices, opt::k, false, -1, 100000, &records, NULL);
+    static const int64_t MAX_COVERAGE_INTERVAL = 100000;
 
-    // Count the number of reads per samples using their index in the BWT
-    std::vector<size_t> sample_counts(indices.pPopIdx->getNumSamples());
+    BWTInterval intervals[2];
+    intervals[0] = BWTAlgorithms::findInterval(indices, kmer);
+    intervals[1] = BWTAlgorithms::findInterval(indices, reverseComplement(kmer));
 
-    for(size_t i = 0; i < records.size(); ++i)
+    // Collect the indices of the reads containing the kmer on either strand.
+    // A read is only counted once even if it has multiple occurrences.
+    std::vector<int64_t> read_indices;
+    for(size_t i = 0; i < 2; ++i)
     {
-        std::stringstream parser(records[i].id.substr(4));
-        size_t index;
-        parser >> index;
-        size_t s_idx = indices.pPopIdx->getSampleIndex(index);
-        sample_counts[s_idx]++;
+        const BWTInterval& interval = intervals[i];
+        if(!interval.isValid() || interval.size() >= MAX_COVERAGE_INTERVAL)
+            continue;
+
+        for(int64_t j = interval.lower; j <= interval.upper; ++j)
+            read_indices.push_back(indices.pSSA->calcSA(j, indices.pBWT).getID());
     }
+
+    std::sort(read_indices.begin(), read_indices.end());
+    read_indices.erase(std::unique(read_indices.begin(), read_indices.end()), read_indices.end());
+
+    // Count the number of reads per samples using their index in the BWT
+    std::vector<size_t> sample_counts(indices.pPopIdx->getNumSamples());
+    for(size_t i = 0; i < read_indices.size(); ++i)
+        sample_counts[indices.pPopIdx->getSampleIndex(read_indices[i])]++;
     return sample_counts;
 }
 
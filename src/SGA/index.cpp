@@ -9,6 +9,10 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
 #include "SGACommon.h"
 #include "Util.h"
 #include "index.h"
@@ -42,6 +46,10 @@ static const char *INDEX_USAGE_MESSAGE =
 "  -a, --algorithm=STR                  BWT construction algorithm. STR can be:\n"
 "                                       sais - induced sort algorithm, slower but works for very long sequences (default)\n"
 "                                       ropebwt - very fast and memory efficient. use this for short (<200bp) reads\n"
+"      --single-pass                    with ropebwt or --disk, build the forward and reverse indices in a single pass over the reads.\n"
+"                                       Both indices are held in memory at once, doubling the peak memory. With --disk the\n"
+"                                       --gap-array-memory limit is split between them. With 2 or more threads the two indices\n"
+"                                       are built concurrently.\n"
 "  -d, --disk=NUM                       use disk-based BWT construction algorithm. The suffix array/BWT will be constructed\n"
 "                                       for batchs of NUM reads at a time. To construct the suffix array of 200 megabases of sequence\n"
 "                                       requires ~2GB of memory, set this parameter accordingly.\n"
@@ -56,6 +64,19 @@ static const char *INDEX_USAGE_MESSAGE =
 "                                       When this value is set to 32, the memory requirement is essentially deterministic and requires ~5N bytes where\n"
 "                                       N is the size of the FM-index of READS2.\n"
 "                                       The default value is 8.\n"
+"      --append=READS                   add the reads in READSFILE to the existing index of READS, which must be next to READS as\n"
+"                                       for sga merge. The new reads are indexed in memory, ranked against the existing index and merged\n"
+"                                       into it by streaming it, then appended to READS in its format. Only the forward and reverse indices\n"
+"                                       that already exist are updated. The append is refused if the sampled suffix array (.ssa) or\n"
+"                                       population index (.popidx) of READS exist as their read IDs would no longer match the index.\n"
+"      --delta                          with --append, add the reads to a small delta index of READS (files starting with\n"
+"                                       PREFIX.delta, where PREFIX is READS without its extension) instead of rewriting the main index.\n"
+"                                       Only sga correct loads the delta index, for its k-mer counts. Other commands use the main index\n"
+"                                       alone. To fold the delta into the main index, append PREFIX.delta.fa with --append=READS then\n"
+"                                       remove the PREFIX.delta files.\n"
+"      --gap-array-memory=NUM           limit the memory used by the gap array to roughly NUM megabytes. If the gap array does not\n"
+"                                       fit, the rank updates are spilled to temporary files and the gap array is read back one range at a time.\n"
+"                                       The default is no limit.\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
 namespace opt
@@ -71,11 +92,15 @@ namespace opt
     static bool bBuildForward = true;
     static bool validate;
     static int gapArrayStorage = 4;
+    static size_t gapArrayMemoryMB = 0;
+    static std::string appendFile;
+    static bool bAppendDelta = false;
+    static bool bSinglePass = false;
 }
 
 static const char* shortopts = "p:a:m:t:d:g:cv";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_REVERSE,OPT_NO_FWD };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_REVERSE,OPT_NO_FWD, OPT_GAP_MEMORY, OPT_APPEND, OPT_DELTA, OPT_SINGLE_PASS };
 
 static const struct option longopts[] = {
     { "verbose",     no_argument,       NULL, 'v' },
@@ -84,6 +109,10 @@ static const struct option longopts[] = {
     { "threads",     required_argument, NULL, 't' },
     { "disk",        required_argument, NULL, 'd' },
     { "gap-array",   required_argument, NULL, 'g' },
+    { "gap-array-memory", required_argument, NULL, OPT_GAP_MEMORY },
+    { "append",      required_argument, NULL, OPT_APPEND },
+    { "delta",       no_argument,       NULL, OPT_DELTA },
+    { "single-pass", no_argument,       NULL, OPT_SINGLE_PASS },
     { "algorithm",   required_argument, NULL, 'a' },
     { "no-reverse",  no_argument,       NULL, OPT_NO_REVERSE },
     { "no-forward",  no_argument,       NULL, OPT_NO_FWD },
@@ -96,20 +125,139 @@ int indexMain(int argc, char** argv)
 {
     Timer t("sga index");
     parseIndexOptions(argc, argv);
-    if(!opt::bDiskAlgo)
+    if(!opt::appendFile.empty())
+        indexAppend();
+    else if(!opt::bDiskAlgo)
+        indexInMemory();
+    else
+        indexOnDisk();
+    return 0;
+}
+
+//
+void indexInMemory()
+{
+    if(opt::algorithm == "sais")
+        indexInMemorySAIS();
+    else if(opt::algorithm == "bcr")
+        indexInMemoryBCR();
+    else if(opt::algorithm == "ropebwt")
+        indexInMemoryRopebwt();
+}
+
+// Add the reads to an existing index. The new reads are indexed in memory then
+// ranked against the existing index, which is streamed from disk to merge them in
+void indexAppend()
+{
+    std::string targetReads = opt::appendFile;
+    std::string targetPrefix = stripGzippedExtension(opt::appendFile);
+    if(opt::bAppendDelta)
     {
-        if(opt::algorithm == "sais")
-            indexInMemorySAIS();
-        else if(opt::algorithm == "bcr")
-            indexInMemoryBCR();
-        else if(opt::algorithm == "ropebwt")
-            indexInMemoryRopebwt();
+        targetPrefix += DELTA_EXT;
+        targetReads = targetPrefix + ".fa";
     }
-    else
+
+    std::cout << "Appending " << opt::readsFile << " to the index of " << targetReads << "\n";
+
+    // The reads are written in the format of the target reads file. Fasta
+    // reads cannot be added to a fastq file as they have no qualities.
+    if(isFastq(targetReads) && !isFastq(opt::readsFile))
     {
-        indexOnDisk();
+        std::cerr << SUBPROGRAM ": cannot append the fasta reads in " << opt::readsFile 
+                  << " to the fastq file " << targetReads << "\n";
+        exit(EXIT_FAILURE);
     }
-    return 0;
+
+    // The sampled suffix array and population index store read IDs
+    // that would no longer match the index, refuse to leave them stale
+    struct stat file_s;
+    std::string sideFiles[] = { targetPrefix + SSA_EXT, targetPrefix + POPIDX_EXT };
+    for(size_t i = 0; i < 2; ++i)
+    {
+        if(stat(sideFiles[i].c_str(), &file_s) == 0)
+        {
+            std::cerr << SUBPROGRAM ": cannot append to the index of " << targetReads << " as " << sideFiles[i] 
+                      << " would no longer match it. Remove the file and rebuild it after appending.\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Only update the indices that exist. If neither exists this is the
+    // first batch of a delta index and the new index is used as is.
+    bool hasForward = stat((targetPrefix + BWT_EXT).c_str(), &file_s) == 0;
+    bool hasReverse = stat((targetPrefix + RBWT_EXT).c_str(), &file_s) == 0;
+    bool bNewIndex = !hasForward && !hasReverse;
+    if(bNewIndex && !opt::bAppendDelta)
+    {
+        std::cerr << SUBPROGRAM ": the index of " << opt::appendFile << " does not exist\n";
+        exit(EXIT_FAILURE);
+    }
+
+    if(!bNewIndex)
+    {
+        opt::bBuildForward = opt::bBuildForward && hasForward;
+        opt::bBuildReverse = opt::bBuildReverse && hasReverse;
+    }
+
+    // Index the new reads
+    std::string newPrefix = bNewIndex ? targetPrefix : targetPrefix + ".append-new";
+    opt::prefix = newPrefix;
+    indexInMemory();
+
+    if(!bNewIndex)
+    {
+        BWTDiskParameters parameters;
+        parameters.inFile = opt::readsFile;
+        parameters.outPrefix = targetPrefix + ".append-merged";
+        parameters.bwtExtension = BWT_EXT;
+        parameters.saiExtension = SAI_EXT;
+        parameters.rbwtExtension = RBWT_EXT;
+        parameters.rsaiExtension = RSAI_EXT;
+        parameters.numReadsPerBatch = 0;
+        parameters.numThreads = opt::numThreads;
+        parameters.storageLevel = opt::gapArrayStorage;
+        parameters.maxGapArrayBytes = opt::gapArrayMemoryMB * 1024 * 1024;
+        parameters.bBuildForward = opt::bBuildForward;
+        parameters.bBuildReverse = opt::bBuildReverse;
+        parameters.bUseBCR = false;
+        appendToIndex(parameters, targetPrefix, newPrefix);
+
+        // Replace the existing index with the merged index. The index of the
+        // new reads is removed first so that any failure leaves the index and
+        // the reads file unchanged.
+        std::string extensions[] = { BWT_EXT, SAI_EXT, RBWT_EXT, RSAI_EXT };
+        for(size_t i = 0; i < 4; ++i)
+        {
+            bool isReverse = i >= 2;
+            if((!isReverse && !opt::bBuildForward) || (isReverse && !opt::bBuildReverse))
+                continue;
+
+            std::string added = newPrefix + extensions[i];
+            if(unlink(added.c_str()) != 0)
+            {
+                std::cerr << SUBPROGRAM ": could not remove " << added << ": " << strerror(errno) << "\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        for(size_t i = 0; i < 4; ++i)
+        {
+            bool isReverse = i >= 2;
+            if((!isReverse && !opt::bBuildForward) || (isReverse && !opt::bBuildReverse))
+                continue;
+
+            std::string merged = parameters.outPrefix + extensions[i];
+            std::string target = targetPrefix + extensions[i];
+            if(rename(merged.c_str(), target.c_str()) != 0)
+            {
+                std::cerr << SUBPROGRAM ": could not rename " << merged << " to " << target << ": " << strerror(errno) << "\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    // Append the reads to the reads file of the index
+    mergeReadFiles(targetReads, opt::readsFile, "");
 }
 
 //
@@ -147,13 +295,24 @@ void indexInMemoryRopebwt()
 {
     std::cout << "Building index for " << opt::readsFile << " in memory using ropebwt\n";
 
-    bool use_threads = opt::numThreads >= 4;
+    // By default the BWTs are built one at a time to bound the memory
+    std::string bwt_filename = opt::bBuildForward ? opt::prefix + BWT_EXT : "";
+    std::string rbwt_filename = opt::bBuildReverse ? opt::prefix + RBWT_EXT : "";
+    if(opt::bSinglePass)
+    {
+        BWTCA::runRopebwt(opt::readsFile, bwt_filename, rbwt_filename, opt::numThreads);
+    }
+    else
+    {
+        if(opt::bBuildForward)
+            BWTCA::runRopebwt(opt::readsFile, bwt_filename, "", opt::numThreads);
+        if(opt::bBuildReverse)
+            BWTCA::runRopebwt(opt::readsFile, "", rbwt_filename, opt::numThreads);
+    }
 
     if(opt::bBuildForward)
     {
-        std::string bwt_filename = opt::prefix + BWT_EXT;
         std::string sai_filename = opt::prefix + SAI_EXT;
-        BWTCA::runRopebwt(opt::readsFile, bwt_filename, use_threads, false);
         std::cout << "\t done bwt construction, generating .sai file\n";
 
         BWT* pBWT = new BWT(bwt_filename);
@@ -165,11 +324,9 @@ void indexInMemoryRopebwt()
 
     if(opt::bBuildReverse)
     {
-        std::string rbwt_filename = opt::prefix + RBWT_EXT;
         std::string rsai_filename = opt::prefix + RSAI_EXT;
-        BWTCA::runRopebwt(opt::readsFile, rbwt_filename, use_threads, true);
-
         std::cout << "\t done rbwt construction, generating .rsai file\n";
+
         BWT* pRBWT = new BWT(rbwt_filename);
         SampledSuffixArray ssa;
         ssa.buildLexicoIndex(pRBWT, opt::numThreads);
@@ -216,23 +373,33 @@ void indexOnDisk()
     parameters.outPrefix = opt::prefix;
     parameters.bwtExtension = BWT_EXT;
     parameters.saiExtension = SAI_EXT;
+    parameters.rbwtExtension = RBWT_EXT;
+    parameters.rsaiExtension = RSAI_EXT;
     parameters.numReadsPerBatch = opt::numReadsPerBatch;
     parameters.numThreads = opt::numThreads;
     parameters.storageLevel = opt::gapArrayStorage;
-    parameters.bBuildReverse = false;
+    parameters.maxGapArrayBytes = opt::gapArrayMemoryMB * 1024 * 1024;
     parameters.bUseBCR = (opt::algorithm == "bcr");
-		
-	if(opt::bBuildForward)
-	{
-		buildBWTDisk(parameters);
-	}
-		
-	if(opt::bBuildReverse)
+
+    // By default the indices are built one at a time to bound the memory
+    if(opt::bSinglePass)
     {
-        parameters.bwtExtension = RBWT_EXT;
-        parameters.saiExtension = RSAI_EXT;
-        parameters.bBuildReverse = true;
-        buildBWTDisk(parameters);
+        parameters.bBuildForward = opt::bBuildForward;
+        parameters.bBuildReverse = opt::bBuildReverse;
+        if(opt::bBuildForward || opt::bBuildReverse)
+            buildBWTDisk(parameters);
+    }
+    else
+    {
+        parameters.bBuildReverse = false;
+        parameters.bBuildForward = opt::bBuildForward;
+        if(opt::bBuildForward)
+            buildBWTDisk(parameters);
+
+        parameters.bBuildForward = false;
+        parameters.bBuildReverse = opt::bBuildReverse;
+        if(opt::bBuildReverse)
+            buildBWTDisk(parameters);
     }
 }
 
@@ -275,6 +442,10 @@ void parseIndexOptions(int argc, char** argv)
             case 'd': opt::bDiskAlgo = true; arg >> opt::numReadsPerBatch; break;
             case 't': arg >> opt::numThreads; break;
             case 'g': arg >> opt::gapArrayStorage; break;
+            case OPT_GAP_MEMORY: arg >> opt::gapArrayMemoryMB; break;
+            case OPT_APPEND: arg >> opt::appendFile; break;
+            case OPT_DELTA: opt::bAppendDelta = true; break;
+            case OPT_SINGLE_PASS: opt::bSinglePass = true; break;
             case 'a': arg >> opt::algorithm; break;
             case 'v': opt::verbose++; break;
             case OPT_NO_REVERSE: opt::bBuildReverse = false; break;
@@ -321,6 +492,18 @@ void parseIndexOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::bAppendDelta && opt::appendFile.empty())
+    {
+        std::cerr << SUBPROGRAM ": --delta requires --append\n";
+        die = true;
+    }
+
+    if(!opt::appendFile.empty() && opt::bDiskAlgo)
+    {
+        std::cerr << SUBPROGRAM ": --append cannot be used with --disk\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cout << "\n" << INDEX_USAGE_MESSAGE;
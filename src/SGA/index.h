@@ -13,6 +13,8 @@
 #include "SuffixArray.h"
 
 int indexMain(int argc, char** argv);
+void indexInMemory();
+void indexAppend();
 void indexInMemorySAIS();
 void indexInMemoryBCR();
 void indexInMemoryRopebwt();
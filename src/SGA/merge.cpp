@@ -45,6 +45,9 @@ static const char *MERGE_USAGE_MESSAGE =
 "                                       When this value is set to 32, the memory requirement is essentially deterministic and requires ~5N bytes where\n"
 "                                       N is the size of the FM-index of READS2.\n"
 "                                       The default value is 4.\n"
+"      --gap-array-memory=NUM           limit the memory used by the gap array to roughly NUM megabytes. If the gap array does not\n"
+"                                       fit, the rank updates are spilled to temporary files and the gap array is read back one range at a time.\n"
+"                                       The default is no limit.\n"
 "      --no-sequence                    Suppress merging of the sequence files. Use this option when merging the index(es) separate e.g. in parallel\n"
 "      --no-forward                     Suppress merging of the forward index. Use this option when merging the index(es) separate e.g. in parallel\n"
 "      --no-reverse                     Suppress merging of the reverse index. Use this option when merging the index(es) separate e.g. in parallel\n"
@@ -58,6 +61,7 @@ namespace opt
     static int numThreads = 1;
     static bool bRemove;
     static int gapArrayStorage = 4;
+    static size_t gapArrayMemoryMB = 0;
 	static bool bMergeSequence = true;
 	static bool bMergeForward = true;
 	static bool bMergeReverse = true;
@@ -65,7 +69,7 @@ namespace opt
 
 static const char* shortopts = "p:m:t:g:vr";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_SEQUENCE, OPT_NO_FWD, OPT_NO_REV };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_SEQUENCE, OPT_NO_FWD, OPT_NO_REV, OPT_GAP_MEMORY };
 
 static const struct option longopts[] = {
     { "verbose",     no_argument,       NULL, 'v' },
@@ -73,6 +77,7 @@ static const struct option longopts[] = {
     { "remove",      no_argument,       NULL, 'r' },
     { "threads",     required_argument, NULL, 't' },
     { "gap-array",   required_argument, NULL, 'g' },
+    { "gap-array-memory", required_argument, NULL, OPT_GAP_MEMORY },
     { "no-sequence", no_argument,       NULL, OPT_NO_SEQUENCE },
     { "no-forward", no_argument,       NULL, OPT_NO_FWD },
     { "no-reverse", no_argument,       NULL, OPT_NO_REV },
@@ -104,7 +109,8 @@ int mergeMain(int argc, char** argv)
     // Merge the indices
 	if(opt::bMergeForward)
 	{
-		mergeIndependentIndices(inFiles[0], inFiles[1], opt::prefix, BWT_EXT, SAI_EXT, false, opt::numThreads, opt::gapArrayStorage);
+		mergeIndependentIndices(inFiles[0], inFiles[1], opt::prefix, BWT_EXT, SAI_EXT, false, opt::numThreads, opt::gapArrayStorage,
+                                opt::gapArrayMemoryMB * 1024 * 1024);
 	}
     
     std::string prefix1 = stripGzippedExtension(inFiles[0]);
@@ -121,7 +127,8 @@ int mergeMain(int argc, char** argv)
 
     if((ret1 == 0 || ret2 == 0) && opt::bMergeReverse)
 	{
-		mergeIndependentIndices(inFiles[0], inFiles[1], opt::prefix, RBWT_EXT, RSAI_EXT, true, opt::numThreads, opt::gapArrayStorage);
+		mergeIndependentIndices(inFiles[0], inFiles[1], opt::prefix, RBWT_EXT, RSAI_EXT, true, opt::numThreads, opt::gapArrayStorage,
+                                opt::gapArrayMemoryMB * 1024 * 1024);
 	}
 		
     // Merge the read files
@@ -180,6 +187,7 @@ void parseMergeOptions(int argc, char** argv)
             case '?': die = true; break;
             case 't': arg >> opt::numThreads; break;
             case 'g': arg >> opt::gapArrayStorage; break;
+            case OPT_GAP_MEMORY: arg >> opt::gapArrayMemoryMB; break;
             case 'v': opt::verbose++; break;
 			case OPT_NO_SEQUENCE: opt::bMergeSequence = false; break;
 			case OPT_NO_FWD: opt::bMergeForward = false; break;
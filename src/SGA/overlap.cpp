@@ -22,7 +22,11 @@
 #include "gzstream.h"
 #include "SequenceProcessFramework.h"
 #include "OverlapProcess.h"
+#include "OverlapHitStore.h"
 #include "ReadInfoTable.h"
+#include "NumaIndexPlacement.h"
+#include "NumaUtil.h"
+#include "HugePageAllocator.h"
 
 //
 enum OutputType
@@ -32,16 +36,18 @@ enum OutputType
 };
 
 // Functions
+typedef std::vector<OverlapHitStore*> OverlapHitStoreVector;
+
 size_t computeHitsSerial(const std::string& prefix, const std::string& readsFile, 
                          const OverlapAlgorithm* pOverlapper, int minOverlap, 
-                         StringVector& filenameVec, std::ostream* pASQGWriter);
+                         OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter);
 
 size_t computeHitsParallel(int numThreads, const std::string& prefix, const std::string& readsFile, 
-                           const OverlapAlgorithm* pOverlapper, int minOverlap, 
-                           StringVector& filenameVec, std::ostream* pASQGWriter);
+                           const std::vector<OverlapAlgorithm*>& overlappers, int minOverlap, 
+                           OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter);
 
 //
-void convertHitsToASQG(const std::string& indexPrefix, const StringVector& hitsFilenames, std::ostream* pASQGWriter);
+void convertHitsToASQG(const std::string& indexPrefix, const OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter);
 
 
 //
@@ -75,6 +81,15 @@ static const char *OVERLAP_USAGE_MESSAGE =
 "                                       is specified (see above). This parameter defaults to the same value as --seed-length\n"
 "      -d, --sample-rate=N              sample the symbol counts every N symbols in the FM-index. Higher values use significantly\n"
 "                                       less memory at the cost of higher runtime. This value must be a power of 2 (default: 128)\n"
+"          --numa=POLICY                place the FM-index on the NUMA nodes according to POLICY. With interleave the\n"
+"                                       pages of the index are spread across the nodes. With replicate each node gets\n"
+"                                       a copy of the index. In both cases the threads are pinned to the nodes\n"
+"                                       round-robin (default: none)\n"
+"          --huge-pages=MODE            back the FM-index arrays with huge pages to reduce TLB misses. MODE is thp to use\n"
+"                                       transparent huge pages or hugetlb to use reserved 1 GB/2 MB pages, falling back\n"
+"                                       to transparent huge pages (default: none)\n"
+"          --hits-memory=MB             keep up to MB megabytes of compressed overlap hits in memory, split between\n"
+"                                       the threads. Hits beyond this are spilled to temporary files (default: 512)\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
 static const char* PROGRAM_IDENT =
@@ -96,11 +111,14 @@ namespace opt
     static int sampleRate = BWT::DEFAULT_SAMPLE_RATE_SMALL;
     static bool bIrreducibleOnly = true;
     static bool bExactIrreducible = false;
+    static NumaPlacementPolicy numaPolicy = NPP_NONE;
+    static HugePageMode hugePageMode = HPM_NONE;
+    static size_t hitsMemoryMB = 512;
 }
 
 static const char* shortopts = "m:d:e:t:l:s:o:f:vix";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_EXACT };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_EXACT, OPT_NUMA, OPT_HUGEPAGES, OPT_HITSMEMORY };
 
 static const struct option longopts[] = {
     { "verbose",     no_argument,       NULL, 'v' },
@@ -115,6 +133,9 @@ static const struct option longopts[] = {
     { "seed-stride", required_argument, NULL, 's' },
     { "exhaustive",  no_argument,       NULL, 'x' },
     { "exact",       no_argument,       NULL, OPT_EXACT },
+    { "numa",        required_argument, NULL, OPT_NUMA },
+    { "huge-pages",  required_argument, NULL, OPT_HUGEPAGES },
+    { "hits-memory", required_argument, NULL, OPT_HITSMEMORY },
     { "help",        no_argument,       NULL, OPT_HELP },
     { "version",     no_argument,       NULL, OPT_VERSION },
     { NULL, 0, NULL, 0 }
@@ -143,7 +164,7 @@ int overlapMain(int argc, char** argv)
     headerRecord.write(*pASQGWriter);
 
     // Compute the overlap hits
-    StringVector hitsFilenames;
+    OverlapHitStoreVector hitStores;
 
     // Determine which index files to use. If a target file was provided,
     // use the index of the target reads
@@ -153,14 +174,35 @@ int overlapMain(int argc, char** argv)
     else
         indexPrefix = stripFilename(opt::readsFile);
 
+    HugePages::setMode(opt::hugePageMode);
     BWT* pBWT = new BWT(indexPrefix + BWT_EXT, opt::sampleRate);
     BWT* pRBWT = new BWT(indexPrefix + RBWT_EXT, opt::sampleRate);
-    OverlapAlgorithm* pOverlapper = new OverlapAlgorithm(pBWT, pRBWT, 
-                                                         opt::errorRate, opt::seedLength, 
-                                                         opt::seedStride, opt::bIrreducibleOnly);
 
-    pOverlapper->setExactModeOverlap(opt::errorRate <= 0.0001);
-    pOverlapper->setExactModeIrreducible(opt::errorRate <= 0.0001);
+    // Place the indices on the NUMA nodes and make an overlapper for each
+    // node that uses the node's copy of the indices. Without replication
+    // one overlapper is shared by all the threads.
+    NumaIndexPlacement placement(opt::numaPolicy);
+    placement.addBWT(pBWT);
+    placement.addBWT(pRBWT);
+    NumaUtil::setWorkerPinning(placement.isPinningRequired());
+    if(opt::numaPolicy != NPP_NONE)
+        placement.printMemoryUsage();
+    if(opt::hugePageMode != HPM_NONE)
+        HugePages::printReport();
+
+    int numOverlappers = opt::numaPolicy == NPP_REPLICATE ? NumaUtil::getNumNodes() : 1;
+    std::vector<OverlapAlgorithm*> overlappers;
+    for(int i = 0; i < numOverlappers; ++i)
+    {
+        OverlapAlgorithm* pNodeOverlapper = new OverlapAlgorithm(placement.getBWT(0, i), placement.getBWT(1, i),
+                                                                 opt::errorRate, opt::seedLength, 
+                                                                 opt::seedStride, opt::bIrreducibleOnly);
+
+        pNodeOverlapper->setExactModeOverlap(opt::errorRate <= 0.0001);
+        pNodeOverlapper->setExactModeIrreducible(opt::errorRate <= 0.0001);
+        overlappers.push_back(pNodeOverlapper);
+    }
+    OverlapAlgorithm* pOverlapper = overlappers.front();
 
     Timer* pTimer = new Timer(PROGRAM_IDENT);
     pBWT->printInfo();
@@ -177,21 +219,24 @@ int overlapMain(int argc, char** argv)
     if(opt::numThreads <= 1)
     {
         printf("[%s] starting serial-mode overlap computation\n", PROGRAM_IDENT);
-        computeHitsSerial(outPrefix, opt::readsFile, pOverlapper, opt::minOverlap, hitsFilenames, pASQGWriter);
+        computeHitsSerial(outPrefix, opt::readsFile, pOverlapper, opt::minOverlap, hitStores, pASQGWriter);
     }
     else
     {
         printf("[%s] starting parallel-mode overlap computation with %d threads\n", PROGRAM_IDENT, opt::numThreads);
-        computeHitsParallel(opt::numThreads, outPrefix, opt::readsFile, pOverlapper, opt::minOverlap, hitsFilenames, pASQGWriter);
+        computeHitsParallel(opt::numThreads, outPrefix, opt::readsFile, overlappers, opt::minOverlap, hitStores, pASQGWriter);
     }
 
     // Get the number of strings in the BWT, this is used to pre-allocated the read table
-    delete pOverlapper;
+    for(size_t i = 0; i < overlappers.size(); ++i)
+        delete overlappers[i];
     delete pBWT; 
     delete pRBWT;
 
-    // Parse the hits files and write the overlaps to the ASQG file
-    convertHitsToASQG(indexPrefix, hitsFilenames, pASQGWriter);
+    // Convert the hits to overlaps and write them to the ASQG file
+    convertHitsToASQG(indexPrefix, hitStores, pASQGWriter);
+    for(size_t i = 0; i < hitStores.size(); ++i)
+        delete hitStores[i];
 
     // Cleanup
     delete pASQGWriter;
@@ -206,12 +251,13 @@ int overlapMain(int argc, char** argv)
 // Return the number of reads processed
 size_t computeHitsSerial(const std::string& prefix, const std::string& readsFile, 
                          const OverlapAlgorithm* pOverlapper, int minOverlap, 
-                         StringVector& filenameVec, std::ostream* pASQGWriter)
+                         OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter)
 {
-    std::string filename = prefix + HITS_EXT + GZIP_EXT;
-    filenameVec.push_back(filename);
+    std::string filename = prefix + HITS_EXT;
+    OverlapHitStore* pHitStore = new OverlapHitStore(filename, opt::hitsMemoryMB * 1024 * 1024);
+    hitStores.push_back(pHitStore);
 
-    OverlapProcess processor(filename, pOverlapper, minOverlap);
+    OverlapProcess processor(pHitStore, pOverlapper, minOverlap);
     OverlapPostProcess postProcessor(pASQGWriter, pOverlapper);
 
     size_t numProcessed = 
@@ -227,25 +273,29 @@ size_t computeHitsSerial(const std::string& prefix, const std::string& readsFile
 // pass this to the SequenceProcessFramework which wraps the processes
 // in threads and distributes the reads to each thread.
 // The number of reads processsed is returned
+// Each thread uses the overlapper of the NUMA node it is pinned to.
 size_t computeHitsParallel(int numThreads, const std::string& prefix, const std::string& readsFile, 
-                           const OverlapAlgorithm* pOverlapper, int minOverlap, 
-                           StringVector& filenameVec, std::ostream* pASQGWriter)
+                           const std::vector<OverlapAlgorithm*>& overlappers, int minOverlap, 
+                           OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter)
 {
-    std::string filename = prefix + HITS_EXT + GZIP_EXT;
+    // Each thread adds its hits to its own store
+    size_t memoryBudget = opt::hitsMemoryMB * 1024 * 1024 / numThreads;
 
     std::vector<OverlapProcess*> processorVector;
     for(int i = 0; i < numThreads; ++i)
     {
         std::stringstream ss;
-        ss << prefix << "-thread" << i << HITS_EXT << GZIP_EXT;
+        ss << prefix << "-thread" << i << HITS_EXT;
         std::string outfile = ss.str();
-        filenameVec.push_back(outfile);
-        OverlapProcess* pProcessor = new OverlapProcess(outfile, pOverlapper, minOverlap);
+        OverlapHitStore* pHitStore = new OverlapHitStore(outfile, memoryBudget);
+        hitStores.push_back(pHitStore);
+        const OverlapAlgorithm* pOverlapper = overlappers[NumaUtil::getWorkerNode(i) % overlappers.size()];
+        OverlapProcess* pProcessor = new OverlapProcess(pHitStore, pOverlapper, minOverlap);
         processorVector.push_back(pProcessor);
     }
 
     // The post processing is performed serially so only one post processor is created
-    OverlapPostProcess postProcessor(pASQGWriter, pOverlapper);
+    OverlapPostProcess postProcessor(pASQGWriter, overlappers.front());
     
     size_t numProcessed = 
            SequenceProcessFramework::processSequencesParallel<SequenceWorkItem,
@@ -258,7 +308,7 @@ size_t computeHitsParallel(int numThreads, const std::string& prefix, const std:
 }
 
 //
-void convertHitsToASQG(const std::string& indexPrefix, const StringVector& hitsFilenames, std::ostream* pASQGWriter)
+void convertHitsToASQG(const std::string& indexPrefix, const OverlapHitStoreVector& hitStores, std::ostream* pASQGWriter)
 {
     // Load the suffix array index and the reverse suffix array index
     // Note these are not the full suffix arrays
@@ -278,30 +328,26 @@ void convertHitsToASQG(const std::string& indexPrefix, const StringVector& hitsF
     bool bIsSelfCompare = pTargetRIT == pQueryRIT;
 
     // Convert the hits to overlaps and write them to the asqg file as initial edges
-    for(StringVector::const_iterator iter = hitsFilenames.begin(); iter != hitsFilenames.end(); ++iter)
+    for(size_t i = 0; i < hitStores.size(); ++i)
     {
-        printf("[%s] parsing file %s\n", PROGRAM_IDENT, iter->c_str());
-        std::istream* pReader = createReader(*iter);
-    
+        OverlapHitStore* pHitStore = hitStores[i];
+
         // Read each hit sequentially, converting it to an overlap
-        std::string line;
-        while(getline(*pReader, line))
+        size_t readIdx;
+        bool isSubstring;
+        OverlapBlockList blocks;
+        while(pHitStore->readHits(readIdx, isSubstring, blocks))
         {
-            size_t readIdx;
             size_t totalEntries;
-            bool isSubstring;
             OverlapVector ov;
-            OverlapCommon::parseHitsString(line, pQueryRIT, pTargetRIT, pFwdSAI, pRevSAI, bIsSelfCompare, readIdx, totalEntries, ov, isSubstring);
+            OverlapCommon::convertBlocksToOverlaps(readIdx, blocks, pQueryRIT, pTargetRIT, pFwdSAI, pRevSAI, bIsSelfCompare, totalEntries, ov);
             for(OverlapVector::iterator iter = ov.begin(); iter != ov.end(); ++iter)
             {
                 ASQG::EdgeRecord edgeRecord(*iter);
                 edgeRecord.write(*pASQGWriter);
             }
         }
-        delete pReader;
-
-        // delete the hits file
-        unlink(iter->c_str());
+        pHitStore->printStats(PROGRAM_IDENT);
     }
 
     // Deallocate data
@@ -332,6 +378,9 @@ void parseOverlapOptions(int argc, char** argv)
             case 'd': arg >> opt::sampleRate; break;
             case 'f': arg >> opt::targetFile; break;
             case OPT_EXACT: opt::bExactIrreducible = true; break;
+            case OPT_NUMA: opt::numaPolicy = NumaIndexPlacement::parsePolicy(arg.str()); break;
+            case OPT_HUGEPAGES: opt::hugePageMode = HugePages::parseMode(arg.str()); break;
+            case OPT_HITSMEMORY: arg >> opt::hitsMemoryMB; break;
             case 'x': opt::bIrreducibleOnly = false; break;
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
@@ -348,24 +348,15 @@ int calculate_delta(const std::string& kmer,
     return delta;
 }
 
+// The k-mer distributions are sampled with this seed so the
+// results do not depend on the number of threads
+static const unsigned int KMER_SAMPLE_SEED = 1;
+
 KmerDistribution sample_kmer_counts(size_t k, size_t n, const BWTIndexSet& index_set)
 {
     // Learn k-mer occurrence distribution for this value of k
     KmerDistribution distribution;
-    for(size_t i = 0; i < n; ++i)
-    {
-        std::string s = BWTAlgorithms::sampleRandomString(index_set.pBWT);
-        if(s.size() < k)
-            continue;
-        size_t nk = s.size() - k + 1;    
-        for(size_t j = 0; j < nk; ++j)
-        {
-            std::string kmer = s.substr(j, k);
-            int count = BWTAlgorithms::countSequenceOccurrences(kmer, index_set.pBWT);
-            distribution.add(count);
-        }
-    }
-
+    BWTAlgorithms::sampleKmerCounts(index_set, k, n, KMER_SAMPLE_SEED, opt::numThreads, distribution);
     return distribution;
 }
 
@@ -644,19 +635,7 @@ void generate_kmer_coverage(JSONWriter* pWriter, const BWTIndexSet& index_set)
     pWriter->String("k");
     pWriter->Int(k);
     
-    KmerDistribution kmerDistribution;
-    for(size_t i = 0; i < n_samples; ++i)
-    {
-        std::string s = BWTAlgorithms::sampleRandomString(index_set.pBWT);
-        int n = s.size();
-        int nk = n - k + 1;
-        for(int j = 0; j < nk; ++j)
-        {
-            std::string kmer = s.substr(j, k);
-            int count = BWTAlgorithms::countSequenceOccurrences(kmer, index_set.pBWT);
-            kmerDistribution.add(count);
-        }
-    }
+    KmerDistribution kmerDistribution = sample_kmer_counts(k, n_samples, index_set);
 
     pWriter->String("distribution");
     pWriter->StartArray();
@@ -1356,23 +1335,9 @@ void generate_quality_stats(JSONWriter* pJSONWriter, const std::string& filename
 //
 GenomeEstimates estimate_genome_size_from_k_counts(size_t k, const BWTIndexSet& index_set)
 {
-    //
-    size_t sum_read_length = 0;
-    
     KmerDistribution kmerDistribution;
-    for(size_t i = 0; i < opt::kmerDistributionSamples; ++i)
-    {
-        std::string s = BWTAlgorithms::sampleRandomString(index_set.pBWT);
-        int n = s.size();
-        int nk = n - k + 1;
-        for(int j = 0; j < nk; ++j)
-        {
-            std::string kmer = s.substr(j, k);
-            int count = BWTAlgorithms::countSequenceOccurrences(kmer, index_set.pBWT);
-            kmerDistribution.add(count);
-        }
-        sum_read_length += s.size();
-    }
+    size_t sum_read_length = BWTAlgorithms::sampleKmerCounts(index_set, k, opt::kmerDistributionSamples,
+                                                             KMER_SAMPLE_SEED, opt::numThreads, kmerDistribution);
 
     // calculate the k-mer count model parameters from the distribution
     // this gives us the estimated proportion of kmers that contain errors
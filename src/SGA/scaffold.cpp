@@ -29,6 +29,7 @@ static const char *SCAFFOLD_USAGE_MESSAGE =
 "\n"
 "      --help                           display this help and exit\n"
 "      -v, --verbose                    display verbose output\n"
+"      -t, --threads=NUM                use NUM threads to process the connected components of the graph (default: 1)\n"
 "          --pe=FILE                    load links derived from paired-end (short insert) libraries from FILE\n"
 "          --mate-pair=FILE             load links derived from mate-pair (long insert) libraries from FILE\n"
 "      -m, --min-length=N               only use contigs at least N bp in length to build scaffolds (default: no minimun).\n"
@@ -62,15 +63,17 @@ namespace opt
     static double minEstCopyNumber = 0.3f;
     static int maxSVSize = 0;
     static int minContigLength = 0;
+    static int numThreads = 1;
 }
 
-static const char* shortopts = "vm:a:u:r:o:g:s:c:";
+static const char* shortopts = "vm:a:u:r:o:g:s:c:t:";
 
 enum { OPT_HELP = 1, OPT_VERSION, OPT_PE, OPT_MATEPAIR, OPT_CUTCONFLICT, OPT_STRICT };
 
 static const struct option longopts[] = {
     { "verbose",            no_argument,       NULL, 'v' },
     { "min-length",         required_argument, NULL, 'm' },
+    { "threads",            required_argument, NULL, 't' },
     { "asgq-file",          required_argument, NULL, 'g' }, 
     { "astatistic-file",    required_argument, NULL, 'a' },
     { "unique-astat",       required_argument, NULL, 'u' },
@@ -138,7 +141,7 @@ int scaffoldMain(int argc, char** argv)
         graph.visit(trVisit);
     
         // Check for cycles in the graph
-        ScaffoldAlgorithms::destroyStrictCycles(&graph, "scaffold.cycles.out");
+        ScaffoldAlgorithms::destroyStrictCycles(&graph, "scaffold.cycles.out", opt::numThreads);
 
         ScaffoldMultiEdgeRemoveVisitor meVisit;
         graph.visit(meVisit);
@@ -162,12 +165,12 @@ int scaffoldMain(int argc, char** argv)
         graph.deleteVertices(SVC_REPEAT);
         
         // Check for cycles in the graph using the old cycle finding algorithm
-        ScaffoldAlgorithms::removeInternalCycles(&graph);
+        ScaffoldAlgorithms::removeInternalCycles(&graph, opt::numThreads);
     }
 
 
     // Linearize the scaffolds
-    ScaffoldAlgorithms::makeScaffolds(&graph);
+    ScaffoldAlgorithms::makeScaffolds(&graph, opt::numThreads);
 
     // TODO Place floating contigs and repeats into the gaps.
 
@@ -194,6 +197,7 @@ void parseScaffoldOptions(int argc, char** argv)
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
             case 'm': arg >> opt::minContigLength; break;
+            case 't': arg >> opt::numThreads; break;
             case 'a': arg >> opt::astatFile; break;
             case 'g': arg >> opt::asqgFile; break;
             case 'u': arg >> opt::uniqueAstatThreshold; break;
@@ -228,6 +232,12 @@ void parseScaffoldOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cout << "\n" << SCAFFOLD_USAGE_MESSAGE;
@@ -127,7 +127,7 @@ void addNeighborsToSubgraph(Vertex* pCurrVertex, StringGraph* pSubgraph, int spa
         return;
 
     // These are the edges in the main graph
-    EdgePtrVec edges = pCurrVertex->getEdges();
+    EdgePtrRange edges = pCurrVertex->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
     {
         if(edges[i]->getColor() != GC_BLACK)
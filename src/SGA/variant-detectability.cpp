@@ -16,6 +16,7 @@
 #include "variant-detectability.h"
 #include "BWTAlgorithms.h"
 #include "BWTIndexSet.h"
+#include "MultiSampleIndex.h"
 #include "Timer.h"
 
 // Structs
@@ -27,8 +28,9 @@ struct KmerCounts
 
 // Local functions
 void computeDetectableAll(StringVector& ref_sequences, const BWTIndexSet& ref_index);
-void computeDetectableSampling(StringVector& ref_sequences, const BWTIndexSet& ref_index);
-KmerCounts computeChangeCounts(const BWTIndexSet& ref_index, std::string& sequence, size_t base_idx, char new_base);
+void computeDetectableSampling(StringVector& ref_sequences, const BWTIndexSet& ref_index, const MultiSampleIndex* pSamples);
+StringVector getChangedKmers(std::string& sequence, size_t base_idx, char new_base);
+KmerCounts computeChangeCounts(const BWTIndexSet& ref_index, const StringVector& kmers);
 
 //
 // Getopt
@@ -49,6 +51,9 @@ static const char *VARIANT_DETECTABILITY_USAGE_MESSAGE =
 "      --help                           display this help and exit\n"
 "  -k, --kmer=K                         set the k-mer length\n"
 "  -n, --num-samples=N                  perform the calculation by randomly sampling N mutations\n"
+"      --samples=FILE                   also compute the detectability of the mutations against the reads of each sample\n"
+"                                       listed in FILE. Each line of FILE holds a sample name and the path to its BWT file\n"
+"  -t, --threads=NUM                    use NUM threads to query the samples (default: 1)\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
 namespace opt
@@ -57,15 +62,19 @@ namespace opt
     static std::string referenceFile;
     static size_t kmer = 31;
     static size_t num_samples = 10000;
+    static std::string samplesFile;
+    static int numThreads = 1;
 }
 
-static const char* shortopts = "k:n:v";
+static const char* shortopts = "k:n:t:v";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_REVERSE };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_NO_REVERSE, OPT_SAMPLES };
 
 static const struct option longopts[] = {
     { "kmer",        required_argument, NULL, 'k' },
     { "num-samples", required_argument, NULL, 'n' },
+    { "samples",     required_argument, NULL, OPT_SAMPLES },
+    { "threads",     required_argument, NULL, 't' },
     { "verbose",     no_argument,       NULL, 'v' },
     { "help",        no_argument,       NULL, OPT_HELP },
     { "version",     no_argument,       NULL, OPT_VERSION },
@@ -90,8 +99,18 @@ int variantDetectabilityMain(int argc, char** argv)
     for(size_t i = 0; i < ref_table.getCount(); ++i) {
         ref_sequences.push_back(ref_table.getRead(i).seq.toString());   
     }
-    computeDetectableSampling(ref_sequences, ref_index);
 
+    // Load the indices of the samples, if given
+    MultiSampleIndex* pSamples = NULL;
+    if(!opt::samplesFile.empty())
+    {
+        pSamples = new MultiSampleIndex(opt::numThreads);
+        pSamples->addSamplesFromFile(opt::samplesFile, BWT::DEFAULT_SAMPLE_RATE_SMALL, 11);
+    }
+
+    computeDetectableSampling(ref_sequences, ref_index, pSamples);
+
+    delete pSamples;
     delete ref_index.pBWT;
     delete ref_index.pCache;
     return 0;
@@ -113,7 +132,7 @@ void computeDetectableAll(StringVector& ref_sequences, const BWTIndexSet& ref_in
                 char m = "ACGT"[j];
                 if(b == m)
                     continue;
-                KmerCounts counts = computeChangeCounts(ref_index, sequence, i, m);
+                KmerCounts counts = computeChangeCounts(ref_index, getChangedKmers(sequence, i, m));
                 total_tested += 1;
                 total_detected += (counts.zero > 0) ? 1 : 0;
             }
@@ -126,13 +145,18 @@ void computeDetectableAll(StringVector& ref_sequences, const BWTIndexSet& ref_in
     printf("Detectable: %zu\n", total_detected);
 }
 
-void computeDetectableSampling(StringVector& ref_sequences, const BWTIndexSet& ref_index)
+// If pSamples is not NULL the mutations are also tested against each sample
+void computeDetectableSampling(StringVector& ref_sequences, const BWTIndexSet& ref_index, const MultiSampleIndex* pSamples)
 {
     size_t total_tested = 0;
     size_t total_detected = 0;
     size_t total_complete = 0;
     size_t num_ref = ref_sequences.size();
 
+    size_t num_indexed_samples = pSamples != NULL ? pSamples->getNumSamples() : 0;
+    std::vector<size_t> sample_detected(num_indexed_samples, 0);
+    std::vector<size_t> sample_complete(num_indexed_samples, 0);
+
     // seed rng
     srandom( time(NULL) );
 
@@ -154,20 +178,40 @@ void computeDetectableSampling(StringVector& ref_sequences, const BWTIndexSet& r
             m = "ACGT"[j];
         } while(m == b);
 
-        KmerCounts counts = computeChangeCounts(ref_index, sequence, base_idx, m);
+        StringVector kmers = getChangedKmers(sequence, base_idx, m);
+        KmerCounts counts = computeChangeCounts(ref_index, kmers);
         total_tested += 1;
         total_detected += (counts.zero > 0) ? 1 : 0;
         total_complete += (counts.zero == counts.total) ? 1 : 0;
         if(opt::verbose > 0)
             printf("tt: %zu td: %zu tc: %zu\n", total_tested, total_detected, total_complete);
+
+        if(pSamples != NULL)
+        {
+            // Count the changed k-mers in all the samples at once
+            std::vector<std::vector<size_t> > sample_counts;
+            pSamples->countSequenceOccurrences(kmers, sample_counts);
+            for(size_t j = 0; j < num_indexed_samples; ++j)
+            {
+                size_t zero = 0;
+                for(size_t ki = 0; ki < kmers.size(); ++ki)
+                    zero += (sample_counts[ki][j] == 0) ? 1 : 0;
+                sample_detected[j] += (zero > 0) ? 1 : 0;
+                sample_complete[j] += (zero == kmers.size()) ? 1 : 0;
+            }
+        }
     }
 
     printf("k=%zu tested=%zu detected=%zu complete=%zu\n", opt::kmer, total_tested, total_detected, total_complete);
+    for(size_t j = 0; j < num_indexed_samples; ++j)
+    {
+        printf("sample=%s k=%zu tested=%zu detected=%zu complete=%zu\n", pSamples->getSampleName(j).c_str(), 
+               opt::kmer, total_tested, sample_detected[j], sample_complete[j]);
+    }
 }
 
-
-// Returns true if changing the given reference base is detectable with kmers
-KmerCounts computeChangeCounts(const BWTIndexSet& ref_index, std::string& sequence, size_t base_idx, char new_base)
+// Return the k-mers covering base_idx after changing it to new_base
+StringVector getChangedKmers(std::string& sequence, size_t base_idx, char new_base)
 {
     // Introduce the change
     char old_base = sequence[base_idx];
@@ -179,20 +223,31 @@ KmerCounts computeChangeCounts(const BWTIndexSet& ref_index, std::string& sequen
     size_t end_k_idx = (base_idx + opt::kmer) < l ? base_idx : l - opt::kmer;
     assert(end_k_idx - start_k_idx <= opt::kmer);
 
+    StringVector kmers;
+    for(size_t ki = start_k_idx; ki <= end_k_idx; ++ki)
+        kmers.push_back(sequence.substr(ki, opt::kmer));
+
+    // Reset the base
+    sequence[base_idx] = old_base;
+    return kmers;
+}
+
+
+// Count the k-mers that are missing from the reference. The
+// change is detectable if any of the changed k-mers is missing.
+KmerCounts computeChangeCounts(const BWTIndexSet& ref_index, const StringVector& kmers)
+{
     KmerCounts counts;
     counts.total = 0;
     counts.zero = 0;
-    for(size_t ki = start_k_idx; ki <= end_k_idx; ++ki) {
-        std::string ks = sequence.substr(ki, opt::kmer);
+    for(size_t ki = 0; ki < kmers.size(); ++ki) {
+        const std::string& ks = kmers[ki];
         size_t occ = BWTAlgorithms::countSequenceOccurrences(ks, ref_index) + 
                      BWTAlgorithms::countSequenceOccurrences(reverseComplement(ks), ref_index);
 
         counts.total += 1;
         counts.zero += (occ == 0) ? 1 : 0;
     }
-
-    // Reset the base
-    sequence[base_idx] = old_base;
     return counts;
 }
 
@@ -210,6 +265,8 @@ void parseVarDetectOptions(int argc, char** argv)
             case '?': die = true; break;
             case 'k': arg >> opt::kmer; break;
             case 'n': arg >> opt::num_samples; break;
+            case 't': arg >> opt::numThreads; break;
+            case OPT_SAMPLES: arg >> opt::samplesFile; break;
             case 'v': opt::verbose++; break;
             case OPT_HELP:
                 std::cout << VARIANT_DETECTABILITY_USAGE_MESSAGE;
@@ -231,6 +288,12 @@ void parseVarDetectOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     if(die) 
     {
         std::cerr << "Try `" << SUBPROGRAM << " --help' for more information.\n";
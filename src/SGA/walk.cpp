@@ -38,6 +38,7 @@ static const char *WALK_USAGE_MESSAGE =
 "\n"
 "      --help                           display this help and exit\n"
 "      -v, --verbose                    display verbose output\n"
+"      -t, --threads=NUM                use NUM threads to find the components and walks (default: 1)\n"
 "      -d, --distance=NUM               the maximum length of the walks to find.\n"
 "      -s,--start ID                    start the walk at vertex with ID\n"
 "      -e,--end ID                      end the walk at vertex with ID\n"
@@ -64,14 +65,16 @@ namespace opt
     static int maxDistance = 500;
     static bool componentWalks = false;
     static int numOutputWalks = -1;
+    static int numThreads = 1;
 }
 
-static const char* shortopts = "o:d:s:e:w:v";
+static const char* shortopts = "o:d:s:e:w:t:v";
 
 enum { OPT_HELP = 1, OPT_VERSION, OPT_COMPONENT, OPT_SAM, OPT_LONGEST_N };
 
 static const struct option longopts[] = {
     { "verbose",           no_argument,       NULL, 'v' },
+    { "threads",           required_argument, NULL, 't' },
     { "out-file",          required_argument, NULL, 'o' },
     { "prefix",            required_argument, NULL, 'p' },
     { "sam",               required_argument, NULL, OPT_SAM },
@@ -241,7 +244,7 @@ void componentWalk(StringGraph* pGraph, SGWalkVector& outWalks)
     typedef std::vector<VertexPtrVec> ComponentVector;
     VertexPtrVec allVertices = pGraph->getAllVertices();
     ComponentVector components;
-    SGSearchTree::connectedComponents(allVertices, components);
+    SGSearchTree::connectedComponents(allVertices, components, opt::numThreads);
 
     // Select the largest component
     int selectedIdx = -1;
@@ -276,25 +279,37 @@ void componentWalk(StringGraph* pGraph, SGWalkVector& outWalks)
 
     std::cout << "selected component has " << terminals.size() << " terminal vertices\n";
 
-    // Find walks between all-pairs of terminal vertices
-    SGWalkVector tempWalks;
-    for(size_t i = 0; i < terminals.size(); ++i)
+    // Find walks between all-pairs of terminal vertices. The searches only
+    // read the graph so the walks starting at each terminal are found in parallel.
+    // They are merged in terminal order so the output does not depend on the threads.
+    int64_t numTerminals = terminals.size();
+    std::vector<SGWalkVector> terminalWalks(numTerminals);
+    std::vector<StringVector> terminalWalkStrings(numTerminals);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(opt::numThreads) if(opt::numThreads > 1)
+#endif
+    for(int64_t i = 0; i < numTerminals; ++i)
     {
-        for(size_t j = i + 1; j < terminals.size(); j++)
+        SGWalkVector& tempWalks = terminalWalks[i];
+        for(int64_t j = i + 1; j < numTerminals; j++)
         {
             Vertex* pX = terminals[i];
             Vertex* pY = terminals[j];
             SGSearch::findWalks(pX, pY, ED_SENSE, opt::maxDistance, 1000000, false, tempWalks);
             SGSearch::findWalks(pX, pY, ED_ANTISENSE, opt::maxDistance, 1000000, false, tempWalks);   
         }
+
+        for(size_t j = 0; j < tempWalks.size(); ++j)
+            terminalWalkStrings[i].push_back(tempWalks[j].getString(SGWT_START_TO_END));
     }
 
     // Remove duplicate walks
     std::map<std::string, SGWalk> walkMap;
-    for(size_t i = 0; i < tempWalks.size(); ++i)
+    for(int64_t i = 0; i < numTerminals; ++i)
     {
-        std::string walkString = tempWalks[i].getString(SGWT_START_TO_END);
-        walkMap.insert(std::make_pair(walkString, tempWalks[i]));
+        for(size_t j = 0; j < terminalWalks[i].size(); ++j)
+            walkMap.insert(std::make_pair(terminalWalkStrings[i][j], terminalWalks[i][j]));
     }
 
     // Copy unique walks to the output
@@ -331,6 +346,7 @@ void parseWalkOptions(int argc, char** argv)
             case 's': arg >> opt::id1; break;
             case 'e': arg >> opt::id2; break;
             case 'w': arg >> opt::walkStr; break;
+            case 't': arg >> opt::numThreads; break;
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
             case OPT_SAM: arg >> opt::samFile; break;
@@ -357,6 +373,12 @@ void parseWalkOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cerr << "Try `" << SUBPROGRAM << " --help' for more information.\n";
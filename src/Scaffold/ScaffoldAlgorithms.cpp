@@ -14,17 +14,25 @@
 // all the terminal vertices of each component. It then searches the
 // components starting from the terminals for a walk that maximizes
 // the size of the contigs in the primary scaffold.
-void ScaffoldAlgorithms::makeScaffolds(ScaffoldGraph* pGraph)
+void ScaffoldAlgorithms::makeScaffolds(ScaffoldGraph* pGraph, int numThreads)
 {
     // Set every edge to be colored black
     // Edges that are kept in the scaffold will be colored white
     pGraph->setEdgeColors(GC_BLACK);
 
     ScaffoldConnectedComponents connectedComponents;
-    ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents);
+    ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents, numThreads);
  
-    // Iterate over each connected component and linearize the scaffolds   
-    for(size_t i = 0; i < connectedComponents.size(); ++i)
+    // Select the layout of each connected component. The layouts
+    // only read the graph so the components are processed in parallel.
+    int64_t numComponents = connectedComponents.size();
+    std::vector<ScaffoldWalk> bestWalks(numComponents, ScaffoldWalk(NULL));
+    std::vector<int> hasTerminals(numComponents, 1);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+#endif
+    for(int64_t i = 0; i < numComponents; ++i)
     {
         // Discover the terminal vertices in the component
         ScaffoldVertexPtrVector& component = connectedComponents[i];
@@ -38,15 +46,15 @@ void ScaffoldAlgorithms::makeScaffolds(ScaffoldGraph* pGraph)
 
         if(terminalVertices.empty())
         {
-            std::cerr << "Warning: scaffold component of size " << component.size() << 
-                         " does not have a terminal vertex. Skipping\n";
+            hasTerminals[i] = 0;
             continue;
         }
+
         // Construct a scaffold layout for each terminal vertex of the component
         // We select the layout that contains the greatest amount of sequence as
         // the initial layout of the scaffold
         size_t bestLayoutBases = 0;
-        ScaffoldWalk bestWalk(NULL);
+        ScaffoldWalk& bestWalk = bestWalks[i];
 
         for(size_t j = 0; j < terminalVertices.size(); j++)
         {
@@ -67,12 +75,26 @@ void ScaffoldAlgorithms::makeScaffolds(ScaffoldGraph* pGraph)
 
         // Ensure a valid layout is chosen
         assert(bestLayoutBases > 0 && bestWalk.getStartVertex() != NULL);
+    }
+
+    for(int64_t i = 0; i < numComponents; ++i)
+    {
+        ScaffoldVertexPtrVector& component = connectedComponents[i];
+        if(component.size() == 1) 
+            continue;
+
+        if(!hasTerminals[i])
+        {
+            std::cerr << "Warning: scaffold component of size " << component.size() << 
+                         " does not have a terminal vertex. Skipping\n";
+            continue;
+        }
 
         // Remove every edge that is not a part of the chosen walk
         // Since every edge in the graph was initially colored black,
         // we color the kept edges white then remove every black edge
         // in a single pass later
-        ScaffoldEdgePtrVector keptEdges = bestWalk.getEdges();
+        ScaffoldEdgePtrVector keptEdges = bestWalks[i].getEdges();
         for(size_t j = 0; j < keptEdges.size(); ++j)
         {
             keptEdges[j]->setColor(GC_WHITE);
@@ -85,7 +107,7 @@ void ScaffoldAlgorithms::makeScaffolds(ScaffoldGraph* pGraph)
 }
 
 // Remove internal cycles from the connected components of the graph
-void ScaffoldAlgorithms::removeInternalCycles(ScaffoldGraph* pGraph)
+void ScaffoldAlgorithms::removeInternalCycles(ScaffoldGraph* pGraph, int numThreads)
 {
     bool done = false;
     while(!done)
@@ -95,10 +117,17 @@ void ScaffoldAlgorithms::removeInternalCycles(ScaffoldGraph* pGraph)
 
         // Compute the connected components of the graph
         ScaffoldConnectedComponents connectedComponents;
-        ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents);
+        ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents, numThreads);
 
-        // Check each CC for a cycle
-        for(size_t i = 0; i < connectedComponents.size(); ++i)
+        // Check each CC for a cycle. The search only colors the
+        // vertices of its own component so the CCs are checked in parallel.
+        int64_t numComponents = connectedComponents.size();
+        std::vector<ScaffoldEdge*> backEdges(numComponents, (ScaffoldEdge*)NULL);
+
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+#endif
+        for(int64_t i = 0; i < numComponents; ++i)
         {
             // Discover the terminal vertices in the component
             ScaffoldVertexPtrVector& component = connectedComponents[i];
@@ -113,17 +142,23 @@ void ScaffoldAlgorithms::removeInternalCycles(ScaffoldGraph* pGraph)
 
             for(size_t j = 0; j < terminalVertices.size(); j++)
             {
-                ScaffoldEdge* pBackEdge = checkForInternalCycle(terminalVertices[j]);
-                if(pBackEdge != NULL)
-                {
-                    std::cout << "Internal cycle found between: " << pBackEdge->getStartID() << " and " << pBackEdge->getEndID() << "\n";
-
-                    // Mark the endpoints of the cycle as repeats
-                    pBackEdge->getStart()->setClassification(SVC_REPEAT);
-                    pBackEdge->getEnd()->setClassification(SVC_REPEAT);
-                    cycleFound = true;
+                backEdges[i] = checkForInternalCycle(terminalVertices[j]);
+                if(backEdges[i] != NULL)
                     break;
-                }
+            }
+        }
+
+        for(int64_t i = 0; i < numComponents; ++i)
+        {
+            ScaffoldEdge* pBackEdge = backEdges[i];
+            if(pBackEdge != NULL)
+            {
+                std::cout << "Internal cycle found between: " << pBackEdge->getStartID() << " and " << pBackEdge->getEndID() << "\n";
+
+                // Mark the endpoints of the cycle as repeats
+                pBackEdge->getStart()->setClassification(SVC_REPEAT);
+                pBackEdge->getEnd()->setClassification(SVC_REPEAT);
+                cycleFound = true;
             }
         }
 
@@ -139,7 +174,7 @@ void ScaffoldAlgorithms::removeInternalCycles(ScaffoldGraph* pGraph)
 }
 
 // Destroy simple cycles in the graph
-void ScaffoldAlgorithms::destroyStrictCycles(ScaffoldGraph* pGraph, std::string out_filename)
+void ScaffoldAlgorithms::destroyStrictCycles(ScaffoldGraph* pGraph, std::string out_filename, int numThreads)
 {
     std::ofstream cycle_writer(out_filename.c_str());
 
@@ -152,10 +187,17 @@ void ScaffoldAlgorithms::destroyStrictCycles(ScaffoldGraph* pGraph, std::string
 
         // Compute the connected components of the graph
         ScaffoldConnectedComponents connectedComponents;
-        ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents);
+        ScaffoldAlgorithms::connectedComponents(pGraph, connectedComponents, numThreads);
+
+        // Check each CC for a cycle. The search only colors the vertices
+        // and edges of its own component so the CCs are checked in parallel.
+        int64_t numComponents = connectedComponents.size();
+        std::vector<ScaffoldVertexVector> cycles(numComponents);
 
-        // Check each CC for a cycle. 
-        for(size_t i = 0; i < connectedComponents.size(); ++i)
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+#endif
+        for(int64_t i = 0; i < numComponents; ++i)
         {
             ScaffoldVertexPtrVector& component = connectedComponents[i];
 
@@ -167,7 +209,12 @@ void ScaffoldAlgorithms::destroyStrictCycles(ScaffoldGraph* pGraph, std::string
 
             // The strict cycle check will find the first cycle in the connected component reachable from this vertex
             ScaffoldVertex* test_vertex = component.front();
-            ScaffoldVertexVector cycle_vertices = checkForStrictCycle(test_vertex);
+            cycles[i] = checkForStrictCycle(test_vertex);
+        }
+
+        for(int64_t i = 0; i < numComponents; ++i)
+        {
+            ScaffoldVertexVector& cycle_vertices = cycles[i];
             if(!cycle_vertices.empty())
             {
                 //std::cout << "\tcycle starting at " << cycle_vertices[0]->getID() << " length " << cycle_vertices.size() << " found\n";
@@ -187,10 +234,10 @@ void ScaffoldAlgorithms::destroyStrictCycles(ScaffoldGraph* pGraph, std::string
 }
 
 // Compute the connected components of the graph
-void ScaffoldAlgorithms::connectedComponents(ScaffoldGraph* pGraph, ScaffoldConnectedComponents& outComponents)
+void ScaffoldAlgorithms::connectedComponents(ScaffoldGraph* pGraph, ScaffoldConnectedComponents& outComponents, int numThreads)
 {
     ScaffoldVertexPtrVector allVertices = pGraph->getAllVertices();
-    ScaffoldSearchTree::connectedComponents(allVertices, outComponents);
+    ScaffoldSearchTree::connectedComponents(allVertices, outComponents, numThreads);
 }
 
 // Compute the terminal vertices of a connected component
@@ -19,20 +19,24 @@ typedef std::vector<ScaffoldVertex*> ScaffoldVertexVector;
 
 namespace ScaffoldAlgorithms
 {
+    // The connected components are independent so the functions below
+    // process them in parallel with numThreads threads. The results are
+    // applied to the graph in component order.
+
     // Construct scaffolds from the given graph
-    void makeScaffolds(ScaffoldGraph* pGraph);
+    void makeScaffolds(ScaffoldGraph* pGraph, int numThreads = 1);
 
     // Remove any internal cycles from the connected components of the graph. 
     // An internal cycle of a connected component is a cycle which does
     // not contain all vertices in a connected component.
-    void removeInternalCycles(ScaffoldGraph* pGraph);
+    void removeInternalCycles(ScaffoldGraph* pGraph, int numThreads = 1);
 
     // Remove all edges for strict cycles in the graph.
     // The names of the vertices in the cycle are written to the file.
-    void destroyStrictCycles(ScaffoldGraph* pGraph, std::string out_filename);
+    void destroyStrictCycles(ScaffoldGraph* pGraph, std::string out_filename, int numThreads = 1);
 
     // Compute the connected components of the scaffold graph
-    void connectedComponents(ScaffoldGraph* pGraph, ScaffoldConnectedComponents& outComponents);
+    void connectedComponents(ScaffoldGraph* pGraph, ScaffoldConnectedComponents& outComponents, int numThreads = 1);
 
     // Compute the terminal vertices in the given connected component
     // A terminal vertex is one that has a connection in at most one direction
@@ -65,6 +65,9 @@ class ScaffoldVertex
         ScaffoldEdge* findEdgeTo(VertexID id, ScaffoldLinkType type) const;
         ScaffoldEdge* findEdgeTo(VertexID id, EdgeDir dir, EdgeComp comp) const;
 
+        // The type returned by getEdges
+        typedef ScaffoldEdgePtrVector EdgeRange;
+
         ScaffoldEdgePtrVector getEdges();
         ScaffoldEdgePtrVector getEdges(EdgeDir dir);
 
@@ -27,7 +27,7 @@ void CompleteOverlapSet::constructBFS()
 {
     EdgeDescList markedList;
     ExploreQueue queue;
-    EdgePtrVec edges = m_pX->getEdges();
+    EdgePtrRange edges = m_pX->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
     {
         Edge* pEdge = edges[i];
@@ -69,7 +69,7 @@ void CompleteOverlapSet::constructBFS()
         }
 
         // Enqueue neighbors
-        EdgePtrVec neighborEdges = pY->getEdges();
+        EdgePtrRange neighborEdges = pY->getEdges();
         for(size_t i = 0; i < neighborEdges.size(); ++i)
         {
             Edge* pEdgeYZ = neighborEdges[i];
@@ -111,7 +111,7 @@ void CompleteOverlapSet::iterativeConstruct()
     SGAlgorithms::EdgeDescOverlapMap exclusionMap;
 
     // Add first-order overlaps
-    EdgePtrVec edges = m_pX->getEdges();
+    EdgePtrRange edges = m_pX->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
     {
         Edge* pEdge = edges[i];
@@ -142,7 +142,7 @@ void CompleteOverlapSet::iterativeConstruct()
         
         // Add the overlaps of Y
         Vertex* pY = edXY.pVertex;
-        EdgePtrVec neighborEdges = pY->getEdges();
+        EdgePtrRange neighborEdges = pY->getEdges();
 
         for(size_t i = 0; i < neighborEdges.size(); ++i)
         {
@@ -202,7 +202,7 @@ void CompleteOverlapSet::iterativeConstruct()
 //
 void CompleteOverlapSet::constructMap()
 {
-    EdgePtrVec edges = m_pX->getEdges();
+    EdgePtrRange edges = m_pX->getEdges();
 
     // Add the primary overlaps to the map, and all the nodes reachable from the primaries
     for(size_t i = 0; i < edges.size(); ++i)
@@ -226,7 +226,7 @@ void CompleteOverlapSet::recursiveConstruct(const EdgeDesc& edXY, const Overlap&
     //std::cout << "depth: " << depth << " " << distance << " " << ovrXY << "\n";
     Vertex* pY = edXY.pVertex;
 
-    EdgePtrVec neighborEdges = pY->getEdges();
+    EdgePtrRange neighborEdges = pY->getEdges();
 
     for(size_t i = 0; i < neighborEdges.size(); ++i)
     {
@@ -275,7 +275,7 @@ void CompleteOverlapSet::recursiveConstruct(const EdgeDesc& edXY, const Overlap&
 void CompleteOverlapSet::getDiffMap(SGAlgorithms::EdgeDescOverlapMap& missingMap, SGAlgorithms::EdgeDescOverlapMap& extraMap)
 {
     missingMap = m_overlapMap;
-    EdgePtrVec edges = m_pX->getEdges();
+    EdgePtrRange edges = m_pX->getEdges();
 
     for(size_t i = 0; i < edges.size(); ++i)
     {
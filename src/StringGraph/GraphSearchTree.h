@@ -13,10 +13,12 @@
 #ifndef GRAPHSEARCHTREE_H
 #define GRAPHSEARCHTREE_H
 
+#include "config.h"
 #include "Bigraph.h"
 #include "SGWalk.h"
 #include <deque>
 #include <queue>
+#include <algorithm>
 
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 class GraphSearchNode
@@ -24,7 +26,7 @@ class GraphSearchNode
     // Typedefs
     public:
         typedef std::deque<GraphSearchNode<VERTEX,EDGE,DISTANCE>* > GraphSearchNodePtrDeque;
-        typedef std::vector<EDGE*> _EDGEPtrVector;
+        typedef typename VERTEX::EdgeRange _EDGERange;
 
     public:
         GraphSearchNode(VERTEX* pVertex, EdgeDir expandDir, GraphSearchNode* pParent, EDGE* pEdgeFromParent, int distance);
@@ -79,8 +81,10 @@ class GraphSearchTree
         ~GraphSearchTree();
 
         // Find connected components in the graph
-        // Takes in a vector of all the vertices in the graph
-        static void connectedComponents(VertexPtrVector allVertices, VertexPtrVectorVector& connectedComponents);
+        // Takes in a vector of all the vertices in the graph.
+        // The components are in the order of their first vertex in
+        // allVertices and each is in breadth-first order from that vertex.
+        static void connectedComponents(VertexPtrVector allVertices, VertexPtrVectorVector& connectedComponents, int numThreads = 1);
 
         // Returns true if the search has converged on a single vertex. In
         // other words, all walks from the start node share a common vertex,
@@ -114,6 +118,12 @@ class GraphSearchTree
 
     private:
 
+        // Concurrent union-find over the positions of the vertices. A root is
+        // only ever linked below a root with a lower position so the root of
+        // each component is its first vertex.
+        static size_t findComponentRoot(std::vector<size_t>& parents, size_t i);
+        static void unionComponents(std::vector<size_t>& parents, size_t i, size_t j);
+
         // Search the branch from pNode to the root for pX.  
         bool searchBranchForVertex(_SearchNode* pNode, VERTEX* pX, _SearchNode*& pFoundNode) const;
 
@@ -207,7 +217,7 @@ int GraphSearchNode<VERTEX,EDGE,DISTANCE>::createChildren(GraphSearchNodePtrDequ
 {
     assert(m_numChildren == 0);
 
-    _EDGEPtrVector edges = m_pVertex->getEdges(m_expandDir);
+    _EDGERange edges = m_pVertex->getEdges(m_expandDir);
 
     for(size_t i = 0; i < edges.size(); ++i)
     {
@@ -507,9 +517,49 @@ void GraphSearchTree<VERTEX,EDGE,DISTANCE>::printBranch(_SearchNode* pNode) cons
     }
 }
 
+// Find the root of the set containing i, halving the path as it is followed
+template<typename VERTEX, typename EDGE, typename DISTANCE>
+size_t GraphSearchTree<VERTEX,EDGE,DISTANCE>::findComponentRoot(std::vector<size_t>& parents, size_t i)
+{
+    while(true)
+    {
+        size_t parent = parents[i];
+        if(parent == i)
+            return i;
+        size_t grandparent = parents[parent];
+        if(grandparent != parent)
+            __sync_bool_compare_and_swap(&parents[i], parent, grandparent);
+        i = parent;
+    }
+}
+
+// Link the root with the higher position below the other. The link fails
+// if another thread has linked the root in the meantime, in which case
+// the roots are found again.
+template<typename VERTEX, typename EDGE, typename DISTANCE>
+void GraphSearchTree<VERTEX,EDGE,DISTANCE>::unionComponents(std::vector<size_t>& parents, size_t i, size_t j)
+{
+    while(true)
+    {
+        i = findComponentRoot(parents, i);
+        j = findComponentRoot(parents, j);
+        if(i == j)
+            return;
+        if(i < j)
+            std::swap(i, j);
+        if(__sync_bool_compare_and_swap(&parents[i], i, j))
+            return;
+    }
+}
+
+// The components are first labelled with a union-find over the edges
+// of every vertex. Each component is then ordered by a breadth-first
+// search from its first vertex. As the components are disjoint the
+// searches can run in parallel using the vertex colors.
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 void GraphSearchTree<VERTEX,EDGE,DISTANCE>::connectedComponents(VertexPtrVector allVertices, 
-                                                                VertexPtrVectorVector& connectedComponents)
+                                                                VertexPtrVectorVector& connectedComponents,
+                                                                int numThreads)
 {
     // Set the color of each vertex to be white signalling its not visited
     typename VertexPtrVector::iterator iter = allVertices.begin();
@@ -519,23 +569,58 @@ void GraphSearchTree<VERTEX,EDGE,DISTANCE>::connectedComponents(VertexPtrVector
         (*iter)->setColor(GC_WHITE);
     }
 
-    // 
-    iter = allVertices.begin();
-    for(; iter != allVertices.end(); ++iter)
+    // Sort the vertices by address to look up their positions
+    int64_t numVertices = allVertices.size();
+    std::vector<std::pair<VERTEX*, size_t> > positions(numVertices);
+    for(int64_t i = 0; i < numVertices; ++i)
+        positions[i] = std::make_pair(allVertices[i], i);
+    std::sort(positions.begin(), positions.end());
+
+    std::vector<size_t> parents(numVertices);
+    for(int64_t i = 0; i < numVertices; ++i)
+        parents[i] = i;
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) num_threads(numThreads) if(numThreads > 1)
+#endif
+    for(int64_t i = 0; i < numVertices; ++i)
     {
-        // Do nothing if this vertex is already part of a CC
-        if((*iter)->getColor() == GC_BLACK)
-            continue;
+        typename VERTEX::EdgeRange edges = allVertices[i]->getEdges();
+        for(size_t j = 0; j < edges.size(); ++j)
+        {
+            VERTEX* pNext = edges[j]->getEnd();
+            typename std::vector<std::pair<VERTEX*, size_t> >::iterator found = 
+                std::lower_bound(positions.begin(), positions.end(), std::make_pair(pNext, (size_t)0));
+            assert(found != positions.end() && found->first == pNext);
+            unionComponents(parents, i, found->second);
+        }
+    }
 
-       // Start a new CC
-       VertexPtrVector currComponent;
+    // Every vertex that is its own root starts a new component
+    std::vector<size_t> roots;
+    for(int64_t i = 0; i < numVertices; ++i)
+    {
+        if(findComponentRoot(parents, i) == (size_t)i)
+            roots.push_back(i);
+    }
+
+    size_t firstComponent = connectedComponents.size();
+    connectedComponents.resize(firstComponent + roots.size());
 
-       std::queue<VERTEX*> exploreQueue;
-       (*iter)->setColor(GC_GRAY); // queued color
-       exploreQueue.push(*iter);
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+#endif
+    for(int64_t c = 0; c < (int64_t)roots.size(); ++c)
+    {
+        VertexPtrVector& currComponent = connectedComponents[firstComponent + c];
 
-       while(!exploreQueue.empty())
-       {
+        std::queue<VERTEX*> exploreQueue;
+        VERTEX* pRoot = allVertices[roots[c]];
+        pRoot->setColor(GC_GRAY); // queued color
+        exploreQueue.push(pRoot);
+
+        while(!exploreQueue.empty())
+        {
             VERTEX* pCurr = exploreQueue.front();
             exploreQueue.pop();
 
@@ -544,7 +629,7 @@ void GraphSearchTree<VERTEX,EDGE,DISTANCE>::connectedComponents(VertexPtrVector
             pCurr->setColor(GC_BLACK); //done with this vertex
 
             // Enqueue edges if they havent been visited already
-            std::vector<EDGE*> edges = pCurr->getEdges();
+            typename VERTEX::EdgeRange edges = pCurr->getEdges();
             for(size_t i = 0; i < edges.size(); ++i)
             {
                 EDGE* pEdge = edges[i];
@@ -555,27 +640,22 @@ void GraphSearchTree<VERTEX,EDGE,DISTANCE>::connectedComponents(VertexPtrVector
                     exploreQueue.push(pNext);
                 }
             }
-       }
-
-        connectedComponents.push_back(currComponent);
-    }
+        }
 
-    iter = allVertices.begin();
-    for(; iter != allVertices.end(); ++iter)
-    {
-        (*iter)->setColor(GC_WHITE);
+        for(size_t i = 0; i < currComponent.size(); ++i)
+            currComponent[i]->setColor(GC_WHITE);
     }
 
     // Sanity check
     size_t totalVertices = allVertices.size();
     size_t totalInComponents = 0;
 
-    for(size_t i = 0; i < connectedComponents.size(); ++i)
+    for(size_t i = firstComponent; i < connectedComponents.size(); ++i)
     {
         totalInComponents += connectedComponents[i].size();
     }
     assert(totalVertices == totalInComponents);
-    std::cout << "[CC] total: " << totalVertices << " num components: " << connectedComponents.size() << "\n";
+    std::cout << "[CC] total: " << totalVertices << " num components: " << connectedComponents.size() - firstComponent << "\n";
     std::cout << "[CC] total vertices in components: " << totalInComponents << "\n";
 }
 
@@ -110,7 +110,7 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
 
     // Enqueue the initial overlaps of pX to the queue if they are longer than the shortest overlap
     EdgeDir dirX = pRemovalEdge->getDir();
-    EdgePtrVec edges = pVertex->getEdges(dirX);
+    EdgePtrRange edges = pVertex->getEdges(dirX);
     for(size_t i = 0; i < edges.size(); ++i)
     {
         Edge* pEdge = edges[i];
@@ -190,7 +190,7 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
 void RemovalAlgorithm::enqueueEdges(const Vertex* pY, EdgeDir dirY, const Overlap& ovrXY, const EdgeDesc& /*edXY*/, int minOverlap, 
                                     ExploreQueue& outQueue, EdgeDescSet* pSeenSet)
 {
-    EdgePtrVec edges = pY->getEdges(dirY);
+    EdgePtrRange edges = pY->getEdges(dirY);
     for(size_t i = 0; i < edges.size(); ++i)
     {
         Edge* pEdge = edges[i];
@@ -134,7 +134,7 @@ void SGSearch::findVariantWalks(Vertex* pX,
 
     // Ensure that all the vertices linked to the start vertex
     // in the specified dir are present in the set.
-    EdgePtrVec epv = pX->getEdges(initialDir);
+    EdgePtrRange epv = pX->getEdges(initialDir);
     cleanlyRemovable = checkEndpointsInSet(epv, completeVertexSet);
 
     // Ensure that all the vertex linked to the last vertex
@@ -161,7 +161,7 @@ void SGSearch::findVariantWalks(Vertex* pX,
 
 // Check that all the endpoints of the edges in the edge pointer vector
 // are members of the set
-bool SGSearch::checkEndpointsInSet(EdgePtrVec& epv, std::set<Vertex*>& vertexSet)
+bool SGSearch::checkEndpointsInSet(const EdgePtrRange& epv, std::set<Vertex*>& vertexSet)
 {
     for(size_t i = 0; i < epv.size(); ++i)
     {
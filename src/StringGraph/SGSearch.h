@@ -76,7 +76,7 @@ namespace SGSearch
     int countSpanningCoverage(Edge* pXY, size_t maxQueue);
 
     // Returns true if all the endpoints of the edges in epv are in vertexSet
-    bool checkEndpointsInSet(EdgePtrVec& epv, std::set<Vertex*>& vertexSet);
+    bool checkEndpointsInSet(const EdgePtrRange& epv, std::set<Vertex*>& vertexSet);
 };
 
 #endif
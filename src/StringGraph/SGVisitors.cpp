@@ -51,7 +51,7 @@ bool SGTransitiveReductionVisitor::visit(StringGraph* /*pGraph*/, Vertex* pVerte
     for(size_t idx = 0; idx < ED_COUNT; idx++)
     {
         EdgeDir dir = EDGE_DIRECTIONS[idx];
-        EdgePtrVec edges = pVertex->getEdges(dir); // These edges are already sorted
+        EdgePtrRange edges = pVertex->getEdges(dir); // These edges are already sorted
         if(edges.size() == 0)
             continue;
 
@@ -70,7 +70,7 @@ bool SGTransitiveReductionVisitor::visit(StringGraph* /*pGraph*/, Vertex* pVerte
             EdgeDir transDir = !pVWEdge->getTwinDir();
             if(pWVert->getColor() == GC_GRAY)
             {
-                EdgePtrVec w_edges = pWVert->getEdges(transDir);
+                EdgePtrRange w_edges = pWVert->getEdges(transDir);
                 for(size_t j = 0; j < w_edges.size(); ++j)
                 {
                     Edge* pWXEdge = w_edges[j];
@@ -96,7 +96,7 @@ bool SGTransitiveReductionVisitor::visit(StringGraph* /*pGraph*/, Vertex* pVerte
             Vertex* pWVert = pVWEdge->getEnd();
 
             EdgeDir transDir = !pVWEdge->getTwinDir();
-            EdgePtrVec w_edges = pWVert->getEdges(transDir);
+            EdgePtrRange w_edges = pWVert->getEdges(transDir);
             for(size_t j = 0; j < w_edges.size(); ++j)
             {
                 Edge* pWXEdge = w_edges[j];
@@ -169,7 +169,7 @@ bool SGIdenticalRemoveVisitor::visit(StringGraph* /*pGraph*/, Vertex* pVertex)
         return false;
 
     // Check if this vertex is identical to any other vertex
-    EdgePtrVec neighborEdges = pVertex->getEdges();
+    EdgePtrRange neighborEdges = pVertex->getEdges();
     for(size_t i = 0; i < neighborEdges.size(); ++i)
     {
         Edge* pEdge = neighborEdges[i];
@@ -218,7 +218,7 @@ bool SGContainRemoveVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
         return false;
     // Add any new irreducible edges that exist when pToRemove is deleted
     // from the graph
-    EdgePtrVec neighborEdges = pVertex->getEdges();
+    EdgePtrVec neighborEdges = pVertex->getEdges().toVector();
     
     // If the graph has been transitively reduced, we have to check all
     // the neighbors to see if any new edges need to be added. If the graph is a
@@ -386,7 +386,7 @@ bool SGSmallRepeatResolveVisitor::visit(StringGraph* /*pGraph*/, Vertex* pX)
     for(size_t idx = 0; idx < ED_COUNT; idx++)
     {
         EdgeDir dir = EDGE_DIRECTIONS[idx];
-        EdgePtrVec x_edges = pX->getEdges(dir); // These edges are already sorted
+        EdgePtrRange x_edges = pX->getEdges(dir); // These edges are already sorted
 
         if(x_edges.size() < 2 || x_edges.size() > MAX_EDGES)
             continue;
@@ -404,7 +404,7 @@ bool SGSmallRepeatResolveVisitor::visit(StringGraph* /*pGraph*/, Vertex* pX)
         Edge* pYX = pXY->getTwin();
         Vertex* pY = pXY->getEnd();
 
-        EdgePtrVec y_edges = pY->getEdges(pYX->getDir());
+        EdgePtrRange y_edges = pY->getEdges(pYX->getDir());
         if(y_edges.size() > MAX_EDGES)
             continue;
 
@@ -464,7 +464,7 @@ bool SGOverlapRatioVisitor::visit(StringGraph* /*pGraph*/, Vertex* pX)
     for(size_t idx = 0; idx < ED_COUNT; idx++)
     {
         EdgeDir dir = EDGE_DIRECTIONS[idx];
-        EdgePtrVec x_edges = pX->getEdges(dir); // These edges are already sorted
+        EdgePtrRange x_edges = pX->getEdges(dir); // These edges are already sorted
 
         if(x_edges.size() < 2)
             continue;
@@ -542,7 +542,7 @@ bool SGSmoothingVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
     for(size_t idx = 0; idx < ED_COUNT; idx++)
     {
         EdgeDir dir = EDGE_DIRECTIONS[idx];
-        EdgePtrVec edges = pVertex->getEdges(dir);
+        EdgePtrRange edges = pVertex->getEdges(dir);
         if(edges.size() <= 1)
             continue;
 
@@ -826,7 +826,7 @@ bool SGGraphStatsVisitor::visit(StringGraph* /*pGraph*/, Vertex* pVertex)
     num_edges += (s_count + as_count);
     ++num_vertex;
 
-    EdgePtrVec edges = pVertex->getEdges();
+    EdgePtrRange edges = pVertex->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
         sum_edgeLen += edges[i]->getSeqLen();
 
@@ -6,6 +6,9 @@
 //
 // bwt_algorithms.cpp - Algorithms for aligning to a bwt structure
 //
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
 #include "BWTAlgorithms.h"
 
 // Find the interval in pBWT corresponding to w
@@ -157,10 +160,15 @@ size_t BWTAlgorithms::countSequenceOccurrencesWithCache(const std::string& w, co
 size_t BWTAlgorithms::countSequenceOccurrences(const std::string& w, const BWTIndexSet& indices)
 {
     assert(indices.pBWT != NULL);
+    size_t count = 0;
     if(indices.pCache != NULL)
-        return countSequenceOccurrencesWithCache(w, indices.pBWT, indices.pCache);
+        count = countSequenceOccurrencesWithCache(w, indices.pBWT, indices.pCache);
     else
-        return countSequenceOccurrences(w, indices.pBWT);
+        count = countSequenceOccurrences(w, indices.pBWT);
+
+    if(indices.pDeltaBWT != NULL)
+        count += countSequenceOccurrences(w, indices.pDeltaBWT);
+    return count;
 }
 
 size_t BWTAlgorithms::countSequenceOccurrencesSingleStrand(const std::string& w, const BWTIndexSet& indices)
@@ -169,10 +177,138 @@ size_t BWTAlgorithms::countSequenceOccurrencesSingleStrand(const std::string& w,
     assert(indices.pCache != NULL);
 
     BWTInterval interval = findIntervalWithCache(indices.pBWT, indices.pCache, w);
-    return interval.isValid() ? interval.size() : 0;
+    size_t count = interval.isValid() ? interval.size() : 0;
+
+    if(indices.pDeltaBWT != NULL)
+    {
+        interval = findInterval(indices.pDeltaBWT, w);
+        count += interval.isValid() ? interval.size() : 0;
+    }
+    return count;
 }
 
 
+// Add the count of each k-mer of w in pBWT, not including the reverse
+// complement, to out. If bReverseOrder is set the count of the k-mer starting
+// at i is added to out[nk - 1 - i]. Once a substring is found to be absent
+// every k-mer containing it is skipped.
+static void addKmerProfileSingleIndex(const std::string& w, size_t k, const BWT* pBWT,
+                                      const BWTIntervalCache* pCache, bool bReverseOrder,
+                                      std::vector<size_t>& out)
+{
+    int nk = w.size() - k + 1;
+    int cacheLen = pCache != NULL ? pCache->getCachedLength() : 0;
+    if(cacheLen > (int)k)
+        cacheLen = 0;
+
+    // The k-mers starting at or before this position contain an absent substring
+    int absentUntil = -1;
+    for(int i = 0; i < nk; ++i)
+    {
+        if(i <= absentUntil)
+            continue;
+
+        // Search backwards from the end of the k-mer as findIntervalWithCache does
+        int j = i + k - 1;
+        BWTInterval interval;
+        if(cacheLen > 0 && memchr(w.c_str() + j + 1 - cacheLen, '$', cacheLen) == NULL)
+        {
+            j = j + 1 - cacheLen;
+            interval = pCache->lookup(w.c_str() + j);
+        }
+        else
+        {
+            BWTAlgorithms::initInterval(interval, w[j], pBWT);
+        }
+
+        while(interval.isValid() && j > i)
+            BWTAlgorithms::updateInterval(interval, w[--j], pBWT);
+
+        if(interval.isValid())
+            out[bReverseOrder ? nk - 1 - i : i] += interval.size();
+        else
+            absentUntil = j;
+    }
+}
+
+// Add the count of each k-mer of w in pBWT to out using the bidirectional
+// index. The k-mers are processed in blocks of b. The k-mers of a block share
+// a core of k - b + 1 bases which is found once. Each k-mer is then
+// made by extending the core to the left with pBWT and to the right
+// with pRevBWT, for about k / b + b / 2 extensions per k-mer instead of k.
+static void addKmerProfileBidirectional(const std::string& w, size_t k, const BWT* pBWT,
+                                        const BWT* pRevBWT, std::vector<size_t>& out)
+{
+    int nk = w.size() - k + 1;
+    int b = std::max(1, std::min((int)k, (int)sqrt(2.0 * k)));
+
+    for(int t = 0; t < nk; t += b)
+    {
+        int last = std::min(t + b, nk) - 1;
+        int coreEnd = t + k - 1;
+        BWTIntervalPair left = BWTAlgorithms::findIntervalPair(pBWT, pRevBWT, w.substr(last, coreEnd - last + 1));
+        if(!left.isValid())
+            continue;
+
+        for(int i = last; i >= t; --i)
+        {
+            // The k-mers left of i contain w[i, coreEnd] so they are
+            // absent when it is
+            if(i < last)
+            {
+                BWTAlgorithms::updateBothL(left, w[i], pBWT);
+                if(!left.isValid())
+                    break;
+            }
+
+            BWTIntervalPair ip = left;
+            for(int j = coreEnd + 1; j < i + (int)k && ip.isValid(); ++j)
+                BWTAlgorithms::updateBothR(ip, w[j], pRevBWT);
+
+            if(ip.isValid())
+                out[i] += ip.interval[0].size();
+        }
+    }
+}
+
+// The reverse complement strand is counted on the complement of w. Its
+// k-mers are searched backwards in pRBWT, which finds the reverse
+// complement of each k-mer of w in pBWT.
+std::vector<size_t> BWTAlgorithms::countKmerProfile(const std::string& w, size_t k, const BWTIndexSet& indices)
+{
+    assert(indices.pBWT != NULL);
+    std::vector<size_t> out;
+    if(k == 0 || w.size() < k)
+        return out;
+    out.resize(w.size() - k + 1, 0);
+
+    if(indices.pRBWT != NULL)
+    {
+        addKmerProfileBidirectional(w, k, indices.pBWT, indices.pRBWT, out);
+        addKmerProfileBidirectional(complement(w), k, indices.pRBWT, indices.pBWT, out);
+    }
+    else
+    {
+        addKmerProfileSingleIndex(w, k, indices.pBWT, indices.pCache, false, out);
+        addKmerProfileSingleIndex(reverseComplement(w), k, indices.pBWT, indices.pCache, true, out);
+    }
+
+    if(indices.pDeltaBWT != NULL)
+    {
+        addKmerProfileSingleIndex(w, k, indices.pDeltaBWT, NULL, false, out);
+        addKmerProfileSingleIndex(reverseComplement(w), k, indices.pDeltaBWT, NULL, true, out);
+    }
+    return out;
+}
+
+//
+std::vector<size_t> BWTAlgorithms::countKmerProfile(const std::string& w, size_t k, const BWT* pBWT)
+{
+    BWTIndexSet indices;
+    indices.pBWT = pBWT;
+    return countKmerProfile(w, k, indices);
+}
+
 // Return the count of all the possible one base extensions of the string w.
 // This returns the number of times the suffix w[i, l]A, w[i, l]C, etc 
 // appears in the FM-index for all i s.t. length(w[i, l]) == overlapLen.
@@ -384,6 +520,49 @@ std::string BWTAlgorithms::sampleRandomString(const BWT* pBWT)
     return extractString(pBWT, idx);
 }
 
+// Two draws are combined so that more than RAND_MAX strings can be chosen
+std::string BWTAlgorithms::sampleRandomString(const BWT* pBWT, unsigned int* pSeed)
+{
+    size_t n = pBWT->getNumStrings();
+    uint64_t r = ((uint64_t)rand_r(pSeed) << 31) | (uint64_t)rand_r(pSeed);
+    return extractString(pBWT, r % n);
+}
+
+//
+size_t BWTAlgorithms::sampleKmerCounts(const BWTIndexSet& indices, size_t k, size_t n, unsigned int seed,
+                                       int numThreads, KmerDistribution& distribution)
+{
+    static const size_t JOB_SIZE = 500;
+    int numJobs = (n + JOB_SIZE - 1) / JOB_SIZE;
+    size_t sumLength = 0;
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads) if(numThreads > 1)
+    for(int j = 0; j < numJobs; ++j)
+    {
+        unsigned int jobSeed = seed + j * 2654435761U;
+        size_t start = j * JOB_SIZE;
+        size_t end = std::min(n, start + JOB_SIZE);
+
+        KmerDistribution jobDistribution;
+        size_t jobLength = 0;
+        for(size_t i = start; i < end; ++i)
+        {
+            std::string s = sampleRandomString(indices.pBWT, &jobSeed);
+            std::vector<size_t> counts = countKmerProfile(s, k, indices);
+            for(size_t c = 0; c < counts.size(); ++c)
+                jobDistribution.add(counts[c]);
+            jobLength += s.size();
+        }
+
+#pragma omp critical(sampleKmerCounts)
+        {
+            distribution.merge(jobDistribution);
+            sumLength += jobLength;
+        }
+    }
+    return sumLength;
+}
+
 // Return a random string from the BWT
 std::string BWTAlgorithms::sampleRandomSubstring(const BWT* pBWT, size_t len)
 {
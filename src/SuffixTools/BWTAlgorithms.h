@@ -13,6 +13,7 @@
 #include "BWTIndexSet.h"
 #include "BWTInterval.h"
 #include "GraphCommon.h"
+#include "KmerDistribution.h"
 
 #include <queue>
 #include <list>
@@ -56,6 +57,13 @@ size_t countSequenceOccurrences(const std::string& w, const BWTIndexSet& indices
 // Count the occurrences of w, not including the reverse complement
 size_t countSequenceOccurrencesSingleStrand(const std::string& w, const BWTIndexSet& indices);
 
+// Count the occurrences of every k-mer of w, including the reverse complement.
+// Element i of the result is the count of w.substr(i, k). Neighbouring k-mers
+// share work so this is faster than counting each k-mer separately, in
+// particular when the reverse index is loaded.
+std::vector<size_t> countKmerProfile(const std::string& w, size_t k, const BWTIndexSet& indices);
+std::vector<size_t> countKmerProfile(const std::string& w, size_t k, const BWT* pBWT);
+
 // Update the given interval using backwards search
 // If the interval corrsponds to string S, it will be updated 
 // for string bS
@@ -189,6 +197,17 @@ std::string extractUntilInterval(const BWT* pBWT, int64_t start, const BWTInterv
 // Returns a randomly chosen string from the BWT
 std::string sampleRandomString(const BWT* pBWT);
 
+// Return a random string from the BWT using the generator state in pSeed, as rand_r
+// does. Threads with their own state can sample concurrently and reproducibly.
+std::string sampleRandomString(const BWT* pBWT, unsigned int* pSeed);
+
+// Sample n strings at random from indices.pBWT and add the counts of all their k-mers,
+// including the reverse complement, to distribution. The samples are split into jobs
+// with their own generator seeded from seed, so the result is the same for any
+// number of threads. Returns the total length of the sampled strings.
+size_t sampleKmerCounts(const BWTIndexSet& indices, size_t k, size_t n, unsigned int seed,
+                        int numThreads, KmerDistribution& distribution);
+
 // Returns a randomly chosen substring from the BWT 
 std::string sampleRandomSubstring(const BWT* pBWT, size_t len);
 
@@ -14,6 +14,9 @@
 #include "BWTWriterBinary.h"
 #include "BWTWriterAscii.h"
 #include "SAWriter.h"
+#include <pthread.h>
+#include <queue>
+#include <algorithm>
 
 static unsigned char seq_nt6_table[128] = {
     0, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
@@ -26,50 +29,143 @@ static unsigned char seq_nt6_table[128] = {
     5, 5, 5, 5, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5
 };
 
-void BWTCA::runRopebwt(const std::string& input_filename, const std::string& bwt_out_name, 
-                       bool use_threads, bool do_reverse)
+// Number of bases to encode before a batch is handed to ropebwt
+static const size_t ROPEBWT_BATCH_BASES = 1 << 22;
+
+// Maximum number of batches waiting to be appended for each direction
+static const size_t ROPEBWT_MAX_QUEUED_BATCHES = 4;
+
+// A batch of reads encoded in the nt6 alphabet. The batch is shared
+// between the forward and reverse constructions and deleted by the
+// last one to release it.
+struct RopebwtBatch
 {
-    // Initialize ropebwt
-    std::string tmp_name = bwt_out_name + ".tmp";
-    bcr_t* bcr = bcr_init(use_threads, tmp_name.c_str());
+    RopebwtBatch() : num_users(0) {}
 
-    size_t num_sequences = 0;
-    size_t num_bases = 0;
-    SeqReader reader(input_filename);
-    SeqRecord record;
-    while(reader.get(record))
+    std::vector<uint8_t> symbols;
+    std::vector<int> lengths;
+    int num_users;
+};
+
+// State for the construction of one BWT
+struct RopebwtJob
+{
+    RopebwtJob() : bcr(NULL), do_reverse(false), num_sequences(0), num_bases(0), done(false) {}
+
+    bcr_t* bcr;
+    bool do_reverse;
+    std::string bwt_out_name;
+    size_t num_sequences;
+    size_t num_bases;
+
+    // Queue of batches waiting to be appended to bcr. 
+    // A NULL batch is never queued, the reader sets done instead.
+    std::queue<RopebwtBatch*> queue;
+    bool done;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+};
+
+//
+static void releaseBatch(RopebwtBatch* pBatch)
+{
+    if(__sync_sub_and_fetch(&pBatch->num_users, 1) == 0)
+        delete pBatch;
+}
+
+// Append every read in the batch to the ropebwt structure
+static void appendBatch(RopebwtJob* pJob, const RopebwtBatch* pBatch, std::vector<uint8_t>& scratch)
+{
+    const uint8_t* p = &pBatch->symbols[0];
+    for(size_t i = 0; i < pBatch->lengths.size(); ++i)
     {
-        if(do_reverse)
-            record.seq.reverse();
+        int l = pBatch->lengths[i];
+        if(pJob->do_reverse)
+        {
+            scratch.assign(p, p + l);
+            std::reverse(scratch.begin(), scratch.end());
+            bcr_append(pJob->bcr, l, &scratch[0]);
+        }
+        else
+        {
+            // bcr_append does not modify the sequence
+            bcr_append(pJob->bcr, l, const_cast<uint8_t*>(p));
+        }
+        p += l;
+        pJob->num_sequences += 1;
+        pJob->num_bases += l;
+    }
+}
 
-        size_t l = record.seq.length();
+// Thread entry point to append batches to one of the BWTs
+static void* appendThread(void* obj)
+{
+    RopebwtJob* pJob = reinterpret_cast<RopebwtJob*>(obj);
+    std::vector<uint8_t> scratch;
+    while(1)
+    {
+        pthread_mutex_lock(&pJob->mutex);
+        while(pJob->queue.empty() && !pJob->done)
+            pthread_cond_wait(&pJob->cond, &pJob->mutex);
 
-        // Convert the string into the alphabet encoding expected by ropebwt
-        uint8_t* s = new uint8_t[l];
-        for(size_t i = 0; i < l; ++i) {
-            char c = record.seq.get(i);
-            s[i] = seq_nt6_table[(int)c];
+        if(pJob->queue.empty())
+        {
+            // No more input
+            pthread_mutex_unlock(&pJob->mutex);
+            break;
         }
-        
-        // Send the sequence to ropebwt
-        bcr_append(bcr, l, s);
 
-        num_sequences += 1;
-        num_bases += l;
-        delete [] s;
+        RopebwtBatch* pBatch = pJob->queue.front();
+        pJob->queue.pop();
+        pthread_cond_signal(&pJob->cond);
+        pthread_mutex_unlock(&pJob->mutex);
+
+        appendBatch(pJob, pBatch, scratch);
+        releaseBatch(pBatch);
+    }
+    return NULL;
+}
+
+// Hand a batch to every job, blocking while a job's queue is full.
+// Without append threads the batch is appended by the calling thread.
+static void dispatchBatch(std::vector<RopebwtJob*>& jobs, RopebwtBatch* pBatch, 
+                          bool use_append_threads, std::vector<uint8_t>& scratch)
+{
+    if(!use_append_threads)
+    {
+        for(size_t i = 0; i < jobs.size(); ++i)
+            appendBatch(jobs[i], pBatch, scratch);
+        delete pBatch;
+        return;
     }
 
-    // Build the BWT
-    bcr_build(bcr);
+    pBatch->num_users = jobs.size();
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        RopebwtJob* pJob = jobs[i];
+        pthread_mutex_lock(&pJob->mutex);
+        while(pJob->queue.size() >= ROPEBWT_MAX_QUEUED_BATCHES)
+            pthread_cond_wait(&pJob->cond, &pJob->mutex);
+        pJob->queue.push(pBatch);
+        pthread_cond_signal(&pJob->cond);
+        pthread_mutex_unlock(&pJob->mutex);
+    }
+}
+
+// Build the BWT and write it to disk
+static void buildAndWrite(RopebwtJob* pJob)
+{
+    bcr_build(pJob->bcr);
     
-    // write the BWT and SAI
-    bcritr_t* itr = bcr_itr_init(bcr);
+    // write the BWT
+    bcritr_t* itr = bcr_itr_init(pJob->bcr);
     const uint8_t* s;
     int l;
 
-    BWTWriterBinary* out_bwt = new BWTWriterBinary(bwt_out_name);
-    size_t num_symbols = num_bases + num_sequences;
-    out_bwt->writeHeader(num_sequences, num_symbols, BWF_NOFMI);
+    BWTWriterBinary* out_bwt = new BWTWriterBinary(pJob->bwt_out_name);
+    size_t num_symbols = pJob->num_bases + pJob->num_sequences;
+    out_bwt->writeHeader(pJob->num_sequences, num_symbols, BWF_NOFMI);
 
     // Write each run
     while( (s = bcr_itr_next(itr, &l)) != 0 ) {
@@ -86,5 +182,129 @@ void BWTCA::runRopebwt(const std::string& input_filename, const std::string& bwt
     delete out_bwt;
 
     // Cleanup
-    bcr_destroy(bcr);
+    bcr_destroy(pJob->bcr);
+    pJob->bcr = NULL;
+}
+
+//
+static void* buildThread(void* obj)
+{
+    buildAndWrite(reinterpret_cast<RopebwtJob*>(obj));
+    return NULL;
+}
+
+//
+static void startThread(pthread_t* pThread, void* (*func)(void*), RopebwtJob* pJob)
+{
+    int ret = pthread_create(pThread, 0, func, pJob);
+    if(ret != 0)
+    {
+        std::cerr << "Thread creation failed with error " << ret << ", aborting" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//
+static void joinThread(pthread_t thread)
+{
+    int ret = pthread_join(thread, NULL);
+    if(ret != 0)
+    {
+        std::cerr << "Thread join failed with error " << ret << ", aborting" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+void BWTCA::runRopebwt(const std::string& input_filename, 
+                       const std::string& bwt_out_name, 
+                       const std::string& rbwt_out_name,
+                       int num_threads)
+{
+    // With a single thread the reads are appended by the reading
+    // thread and the BWTs are built one after the other. Otherwise 
+    // each BWT gets an append thread and the BWTs are built concurrently.
+    // Only one of the concurrent builds uses ropebwt's internal threads.
+    int num_jobs = (bwt_out_name.empty() ? 0 : 1) + (rbwt_out_name.empty() ? 0 : 1);
+    bool use_append_threads = num_threads >= 2;
+    bool concurrent = num_jobs == 2 && num_threads >= 2;
+
+    // Set up a job for each BWT that is requested
+    std::vector<RopebwtJob*> jobs;
+    for(size_t i = 0; i < 2; ++i)
+    {
+        const std::string& out_name = i == 0 ? bwt_out_name : rbwt_out_name;
+        if(out_name.empty())
+            continue;
+
+        RopebwtJob* pJob = new RopebwtJob;
+        pJob->do_reverse = i == 1;
+        pJob->bwt_out_name = out_name;
+
+        // Initialize ropebwt
+        std::string tmp_name = out_name + ".tmp";
+        bool use_bcr_threads = num_threads >= 4 && (jobs.empty() || !concurrent);
+        pJob->bcr = bcr_init(use_bcr_threads, tmp_name.c_str());
+        pthread_mutex_init(&pJob->mutex, NULL);
+        pthread_cond_init(&pJob->cond, NULL);
+        if(use_append_threads)
+            startThread(&pJob->thread, appendThread, pJob);
+        jobs.push_back(pJob);
+    }
+
+    // Parse the input once, encoding the reads into batches
+    // that are appended to each BWT
+    SeqReader reader(input_filename);
+    SeqRecord record;
+    std::vector<uint8_t> scratch;
+    RopebwtBatch* pBatch = new RopebwtBatch;
+    while(reader.get(record))
+    {
+        size_t l = record.seq.length();
+
+        // Convert the string into the alphabet encoding expected by ropebwt
+        for(size_t i = 0; i < l; ++i) {
+            char c = record.seq.get(i);
+            pBatch->symbols.push_back(seq_nt6_table[(int)c]);
+        }
+        pBatch->lengths.push_back(l);
+
+        if(pBatch->symbols.size() >= ROPEBWT_BATCH_BASES)
+        {
+            dispatchBatch(jobs, pBatch, use_append_threads, scratch);
+            pBatch = new RopebwtBatch;
+        }
+    }
+
+    if(!pBatch->lengths.empty())
+        dispatchBatch(jobs, pBatch, use_append_threads, scratch);
+    else
+        delete pBatch;
+
+    // Signal the end of the input and wait for the appends to finish
+    for(size_t i = 0; i < jobs.size() && use_append_threads; ++i)
+    {
+        pthread_mutex_lock(&jobs[i]->mutex);
+        jobs[i]->done = true;
+        pthread_cond_signal(&jobs[i]->cond);
+        pthread_mutex_unlock(&jobs[i]->mutex);
+        joinThread(jobs[i]->thread);
+    }
+
+    // Build the BWTs
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        if(concurrent)
+            startThread(&jobs[i]->thread, buildThread, jobs[i]);
+        else
+            buildAndWrite(jobs[i]);
+    }
+
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        if(concurrent)
+            joinThread(jobs[i]->thread);
+        pthread_mutex_destroy(&jobs[i]->mutex);
+        pthread_cond_destroy(&jobs[i]->cond);
+        delete jobs[i];
+    }
 }
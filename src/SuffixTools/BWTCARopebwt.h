@@ -5,7 +5,9 @@
 //-----------------------------------------------
 //
 // BWTCARopebwt - Construct the BWT for a set of reads
-// using Heng Li's ropebwt implementation
+// using Heng Li's ropebwt implementation. The reads
+// are parsed and encoded once and fed to the forward
+// and reverse constructions in large batches.
 //
 #ifndef BWTCA_ROPEBWT_H
 #define BWTCA_ROPEBWT_H
@@ -14,8 +16,17 @@
 
 namespace BWTCA
 {
-    void runRopebwt(const std::string& input_filename, const std::string& bwt_out_name, 
-                    bool use_threads, bool do_reverse);
+    // Build the BWT of the reads in input_filename and write it to bwt_out_name
+    // and the BWT of the reversed reads to rbwt_out_name. Either output can be
+    // disabled by passing an empty filename. When both are requested they are
+    // built from a single pass over the input and both ropebwt structures are
+    // held in memory at once. With num_threads >= 2 the two BWTs are built
+    // concurrently and with num_threads >= 4 ropebwt uses its threaded
+    // construction for one of them.
+    void runRopebwt(const std::string& input_filename, 
+                    const std::string& bwt_out_name, 
+                    const std::string& rbwt_out_name,
+                    int num_threads);
 };
 
 #endif
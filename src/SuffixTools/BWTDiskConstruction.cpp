@@ -19,11 +19,14 @@
 #include "RankProcess.h"
 #include "SequenceProcessFramework.h"
 #include "BWTCABauerCoxRosone.h"
+#include "config.h"
 
 // Definitions and structures
 static const bool USE_GZ = false;
 static const int BWT_SAMPLE_RATE = 512;
 
+// The index files of a block of reads. The forward or reverse
+// filenames are empty if that index is not being built.
 struct MergeItem
 {
     int64_t start_index;
@@ -31,11 +34,14 @@ struct MergeItem
     std::string reads_filename;
     std::string bwt_filename;
     std::string sai_filename;
+    std::string rbwt_filename;
+    std::string rsai_filename;
 
     friend std::ostream& operator<<(std::ostream& out, const MergeItem& item)
     {
         out << "[" << item.start_index << "," << item.end_index << "] " << item.bwt_filename;
-        out << " " << item.sai_filename << " " << item.reads_filename;
+        out << " " << item.sai_filename << " " << item.rbwt_filename << " " << item.rsai_filename;
+        out << " " << item.reads_filename;
         return out;
     }
 };
@@ -43,29 +49,46 @@ typedef std::vector<MergeItem> MergeVector;
 
 // Function declarations
 int64_t merge(SeqReader* pReader, 
-              const MergeItem& item1, const MergeItem& item2, 
-              const std::string& bwt_outname, const std::string& sai_outname,
-              bool doReverse, int numThreads, int storageLevel);
+              const MergeItem& item1, const MergeItem& item2, const MergeItem& outItem,
+              int numThreads, int storageLevel, size_t maxGapArrayBytes);
 
 // Initial BWT construction algorithms
 MergeVector computeInitialSAIS(const BWTDiskParameters& parameters); 
 MergeVector computeInitialBCR(const BWTDiskParameters& parameters); 
 
 //
-void writeMergedIndex(const BWT* pBWTInternal, const MergeItem& externalItem, 
-                      const MergeItem& internalItem, const std::string& bwt_outname,
-                      const std::string& sai_outname, const GapArray* pGapArray);
+void writeMergedIndex(const BWT* pBWTInternal, const std::string& bwt_ext_name, 
+                      const std::string& sai_ext_name, const std::string& sai_int_name,
+                      const std::string& bwt_outname, const std::string& sai_outname, 
+                      const GapArray* pGapArray);
 
 void writeRemovalIndex(const BWT* pBWTInternal, const std::string& sai_inname,
                        const std::string& bwt_outname, const std::string& sai_outname, 
                        size_t num_strings_remove, size_t num_symbols_remove,
                        const GapArray* pGapArray);
 
+void writeAppendedIndex(const std::string& bwt_inname, const std::string& sai_inname,
+                        const std::string& bwt_newname, const std::string& sai_newname,
+                        const std::string& bwt_outname, const std::string& sai_outname, 
+                        const GapArray* pGapArray);
+
+size_t copyBWSymbols(IBWTReader* pBWTReader, SAReader* pSAIReader, size_t count, uint64_t id_offset,
+                     IBWTWriter* pBWTWriter, SAWriter* pSAIWriter, size_t& num_sai_wrote);
+
 void computeGapArray(SeqReader* pReader, size_t n, const BWT* pBWT, bool doReverse, 
-                     int numThreads, GapArray* pGapArray, bool removeMode,
+                     int numThreads, GapArray* pGapArray, RankMode mode,
                      size_t& num_strings_read, size_t& num_symbols_read);
 
+void computeGapArrays(SeqReader* pReader, size_t n, 
+                      const BWT* pBWT, GapArray* pGapArray,
+                      const BWT* pRBWT, GapArray* pRGapArray,
+                      int numThreads, RankMode mode,
+                      size_t& num_strings_read, size_t& num_symbols_read);
+
 //
+void writeInitialIndex(const ReadTable* pRT, const std::string& bwt_filename, const std::string& sai_filename);
+void setIndexFiles(MergeItem& item, bool doReverse, const std::string& bwt_filename, const std::string& sai_filename);
+void removeIndexFiles(const MergeItem& item);
 std::string makeTempName(const std::string& prefix, int id, const std::string& extension);
 std::string makeFilename(const std::string& prefix, const std::string& extension);
 
@@ -73,7 +96,9 @@ std::string makeFilename(const std::string& prefix, const std::string& extension
 // The algorithm is as follows. We create M BWTs for subsets of 
 // the input reads. These are created independently and written
 // to disk. They are then merged either sequentially or pairwise
-// to create the final BWT
+// to create the final BWT. When both the forward and reverse
+// BWTs are requested they are built together, so the reads are
+// only parsed once per round.
 void buildBWTDisk(const BWTDiskParameters& parameters)
 {
     // Build the initial bwts for subsets of the data
@@ -97,16 +122,28 @@ void buildBWTDisk(const BWTDiskParameters& parameters)
         {
             if(i + 1 != mergeVector.size())
             {
-                std::string bwt_merged_name = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
-                std::string sai_merged_name = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
-
                 MergeItem item1 = mergeVector[i];
                 MergeItem item2 = mergeVector[i+1];
 
+                MergeItem merged;
+                merged.start_index = item1.start_index;
+                merged.end_index = item2.end_index;
+                if(parameters.bBuildForward)
+                {
+                    merged.bwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
+                    merged.sai_filename = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
+                }
+
+                if(parameters.bBuildReverse)
+                {
+                    merged.rbwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.rbwtExtension);
+                    merged.rsai_filename = makeTempName(parameters.outPrefix, groupID, parameters.rsaiExtension);
+                }
+
                 // Perform the actual merge
-                int64_t curr_idx = merge(pReader, item1, item2, 
-                                         bwt_merged_name, sai_merged_name, 
-                                         parameters.bBuildReverse, parameters.numThreads, parameters.storageLevel);
+                int64_t curr_idx = merge(pReader, item1, item2, merged,
+                                         parameters.numThreads, parameters.storageLevel,
+                                         parameters.maxGapArrayBytes);
 
                 // pReader now points to the end of item1's block of 
                 // reads. Skip item2's reads
@@ -119,19 +156,12 @@ void buildBWTDisk(const BWTDiskParameters& parameters)
                     ++curr_idx;
                 }
 
-                // Create the merged mergeItem to use in the next round
-                MergeItem merged;
-                merged.start_index = item1.start_index;
-                merged.end_index = item2.end_index;
-                merged.bwt_filename = bwt_merged_name;
-                merged.sai_filename = sai_merged_name;
+                // Use the merged item in the next round
                 nextMergeRound.push_back(merged);
 
                 // Done with the temp files, remove them
-                unlink(item1.bwt_filename.c_str());
-                unlink(item2.bwt_filename.c_str());
-                unlink(item1.sai_filename.c_str());
-                unlink(item2.sai_filename.c_str());
+                removeIndexFiles(item1);
+                removeIndexFiles(item2);
 
                 ++groupID;
             }
@@ -149,15 +179,18 @@ void buildBWTDisk(const BWTDiskParameters& parameters)
     assert(mergeVector.size() == 1);
 
     // Done, rename the files to their final name
-    std::stringstream bwt_ss;
-    bwt_ss << parameters.outPrefix << parameters.bwtExtension << (USE_GZ ? ".gz" : "");
-    std::string bwt_final_filename = bwt_ss.str();
-    rename(mergeVector.front().bwt_filename.c_str(), bwt_final_filename.c_str());
-
-    std::stringstream sai_ss;
-    sai_ss << parameters.outPrefix << parameters.saiExtension << (USE_GZ ? ".gz" : "");
-    std::string sai_final_filename = sai_ss.str();
-    rename(mergeVector.front().sai_filename.c_str(), sai_final_filename.c_str());
+    const MergeItem& final = mergeVector.front();
+    if(parameters.bBuildForward)
+    {
+        rename(final.bwt_filename.c_str(), makeFilename(parameters.outPrefix, parameters.bwtExtension).c_str());
+        rename(final.sai_filename.c_str(), makeFilename(parameters.outPrefix, parameters.saiExtension).c_str());
+    }
+
+    if(parameters.bBuildReverse)
+    {
+        rename(final.rbwt_filename.c_str(), makeFilename(parameters.outPrefix, parameters.rbwtExtension).c_str());
+        rename(final.rsai_filename.c_str(), makeFilename(parameters.outPrefix, parameters.rsaiExtension).c_str());
+    }
 }
 
 // Compute the initial BWTs for the input file split into blocks of records using the SAIS algorithm
@@ -175,6 +208,8 @@ MergeVector computeInitialSAIS(const BWTDiskParameters& parameters)
 
     // Phase 1: Compute the initial BWTs
     ReadTable* pCurrRT = new ReadTable;
+    ReadTable* pCurrRevRT = new ReadTable;
+    size_t numBatchReads = 0;
     bool done = false;
     while(!done)
     {
@@ -184,41 +219,68 @@ MergeVector computeInitialSAIS(const BWTDiskParameters& parameters)
         {
             // the read is valid
             SeqItem item = record.toSeqItem();
+            if(parameters.bBuildForward)
+                pCurrRT->addRead(item);
+
             if(parameters.bBuildReverse)
+            {
                 item.seq.reverse();
-            pCurrRT->addRead(item);
+                pCurrRevRT->addRead(item);
+            }
             ++numReadTotal;
+            ++numBatchReads;
         }
 
-        if(pCurrRT->getCount() >= parameters.numReadsPerBatch || (done && pCurrRT->getCount() > 0))
+        if(numBatchReads >= parameters.numReadsPerBatch || (done && numBatchReads > 0))
         {
-            // Compute the SA and BWT for this group
-            SuffixArray* pSA = new SuffixArray(pCurrRT, 1);
-
-            // Write the BWT to disk                
-            std::string bwt_temp_filename = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
-            pSA->writeBWT(bwt_temp_filename, pCurrRT);
-
-            std::string sai_temp_filename = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
-            pSA->writeIndex(sai_temp_filename);
-
             // Push the merge info
             mergeItem.end_index = numReadTotal - 1; // inclusive
             mergeItem.reads_filename = parameters.inFile;
-            mergeItem.bwt_filename = bwt_temp_filename;
-            mergeItem.sai_filename = sai_temp_filename;
-            mergeVector.push_back(mergeItem);
+            if(parameters.bBuildForward)
+            {
+                mergeItem.bwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
+                mergeItem.sai_filename = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
+            }
 
-            // Cleanup
-            delete pSA;
+            if(parameters.bBuildReverse)
+            {
+                mergeItem.rbwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.rbwtExtension);
+                mergeItem.rsai_filename = makeTempName(parameters.outPrefix, groupID, parameters.rsaiExtension);
+            }
+
+            // Compute the SA and BWT for this group in both directions
+#if HAVE_OPENMP
+            #pragma omp parallel sections num_threads(2) if(parameters.numThreads > 1)
+#endif
+            {
+#if HAVE_OPENMP
+                #pragma omp section
+#endif
+                {
+                    if(parameters.bBuildForward)
+                        writeInitialIndex(pCurrRT, mergeItem.bwt_filename, mergeItem.sai_filename);
+                }
+
+#if HAVE_OPENMP
+                #pragma omp section
+#endif
+                {
+                    if(parameters.bBuildReverse)
+                        writeInitialIndex(pCurrRevRT, mergeItem.rbwt_filename, mergeItem.rsai_filename);
+                }
+            }
+            mergeVector.push_back(mergeItem);
 
             // Start the new group
             mergeItem.start_index = numReadTotal;
             ++groupID;
+            numBatchReads = 0;
             pCurrRT->clear();
+            pCurrRevRT->clear();
         }
     }
     delete pCurrRT;
+    delete pCurrRevRT;
     delete pReader;
     return mergeVector;
 }
@@ -238,6 +300,8 @@ MergeVector computeInitialBCR(const BWTDiskParameters& parameters)
 
     // Phase 1: Compute the initial BWTs
     DNAEncodedStringVector readSequences;
+    DNAEncodedStringVector revReadSequences;
+    size_t numBatchReads = 0;
     bool done = false;
     while(!done)
     {
@@ -247,29 +311,44 @@ MergeVector computeInitialBCR(const BWTDiskParameters& parameters)
         {
             // the read is valid
             SeqItem item = record.toSeqItem();
+            if(parameters.bBuildForward)
+                readSequences.push_back(item.seq.toString());
+
             if(parameters.bBuildReverse)
+            {
                 item.seq.reverse();
-            readSequences.push_back(item.seq.toString());
+                revReadSequences.push_back(item.seq.toString());
+            }
             ++numReadTotal;
+            ++numBatchReads;
         }
 
-        if(readSequences.size() >= parameters.numReadsPerBatch || (done && readSequences.size() > 0))
+        if(numBatchReads >= parameters.numReadsPerBatch || (done && numBatchReads > 0))
         {
-            std::string bwt_temp_filename = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
-            std::string sai_temp_filename = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
-            BWTCA::runBauerCoxRosone(&readSequences, bwt_temp_filename, sai_temp_filename);
-
             // Push the merge info
             mergeItem.end_index = numReadTotal - 1; // inclusive
             mergeItem.reads_filename = parameters.inFile;
-            mergeItem.bwt_filename = bwt_temp_filename;
-            mergeItem.sai_filename = sai_temp_filename;
+            if(parameters.bBuildForward)
+            {
+                mergeItem.bwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.bwtExtension);
+                mergeItem.sai_filename = makeTempName(parameters.outPrefix, groupID, parameters.saiExtension);
+                BWTCA::runBauerCoxRosone(&readSequences, mergeItem.bwt_filename, mergeItem.sai_filename);
+            }
+
+            if(parameters.bBuildReverse)
+            {
+                mergeItem.rbwt_filename = makeTempName(parameters.outPrefix, groupID, parameters.rbwtExtension);
+                mergeItem.rsai_filename = makeTempName(parameters.outPrefix, groupID, parameters.rsaiExtension);
+                BWTCA::runBauerCoxRosone(&revReadSequences, mergeItem.rbwt_filename, mergeItem.rsai_filename);
+            }
             mergeVector.push_back(mergeItem);
 
             // Start the new group
             mergeItem.start_index = numReadTotal;
             ++groupID;
+            numBatchReads = 0;
             readSequences.clear();
+            revReadSequences.clear();
         }
     }
     delete pReader;
@@ -279,21 +358,20 @@ MergeVector computeInitialBCR(const BWTDiskParameters& parameters)
 // Merge the indices for the two independent sets of reads in readsFile1 and readsFile2
 void mergeIndependentIndices(const std::string& readsFile1, const std::string& readsFile2, 
                              const std::string& outPrefix, const std::string& bwt_extension, 
-                             const std::string& sai_extension, bool doReverse, int numThreads, int storageLevel)
+                             const std::string& sai_extension, bool doReverse, int numThreads, int storageLevel,
+                             size_t maxGapArrayBytes)
 {
     MergeItem item1;
     std::string prefix1 = stripGzippedExtension(readsFile1);
     item1.reads_filename = readsFile1;
-    item1.bwt_filename = makeFilename(prefix1, bwt_extension);
-    item1.sai_filename = makeFilename(prefix1, sai_extension);
+    setIndexFiles(item1, doReverse, makeFilename(prefix1, bwt_extension), makeFilename(prefix1, sai_extension));
     item1.start_index = 0;
     item1.end_index = -1; // this tells merge to read the entire file
 
     MergeItem item2;
     std::string prefix2 = stripGzippedExtension(readsFile2);
     item2.reads_filename = readsFile2;
-    item2.bwt_filename = makeFilename(prefix2, bwt_extension);
-    item2.sai_filename = makeFilename(prefix2, sai_extension);
+    setIndexFiles(item2, doReverse, makeFilename(prefix2, bwt_extension), makeFilename(prefix2, sai_extension));
     item2.start_index = 0;
     item2.end_index = -1;
 
@@ -301,14 +379,95 @@ void mergeIndependentIndices(const std::string& readsFile1, const std::string& r
     SeqReader* pReader = new SeqReader(item1.reads_filename);
     
     // Build the outnames
-    std::string bwt_merged_name = makeFilename(outPrefix, bwt_extension);
-    std::string sai_merged_name = makeFilename(outPrefix, sai_extension);
+    MergeItem merged;
+    setIndexFiles(merged, doReverse, makeFilename(outPrefix, bwt_extension), makeFilename(outPrefix, sai_extension));
 
     // Perform the actual merge
-    merge(pReader, item1, item2, bwt_merged_name, sai_merged_name, doReverse, numThreads, storageLevel);
+    merge(pReader, item1, item2, merged, numThreads, storageLevel, maxGapArrayBytes);
     delete pReader;
 }
 
+// Merge the index of the new reads in parameters.inFile, with files starting with newPrefix, into
+// the existing index with files starting with indexPrefix. The new reads are ordered after the
+// existing reads. Only the new reads are parsed: their suffixes are ranked against the existing
+// index to compute gap arrays over it, then the existing index is streamed to the output with the
+// new symbols inserted. The ranking work is proportional to the number of new symbols.
+void appendToIndex(const BWTDiskParameters& parameters, const std::string& indexPrefix, const std::string& newPrefix)
+{
+    bool doForward = parameters.bBuildForward;
+    bool doReverse = parameters.bBuildReverse;
+
+    // Load the existing bwts into memory to rank the new reads against
+    BWT* pBWT = doForward ? new BWT(makeFilename(indexPrefix, parameters.bwtExtension), BWT_SAMPLE_RATE) : NULL;
+    BWT* pRBWT = doReverse ? new BWT(makeFilename(indexPrefix, parameters.rbwtExtension), BWT_SAMPLE_RATE) : NULL;
+
+    // The gap arrays count the number of new suffixes that are inserted
+    // before each symbol of the existing bwts. The memory budget is split
+    // between the directions as in merge().
+    size_t gapArrayBytes = doForward && doReverse ? parameters.maxGapArrayBytes / 2 : parameters.maxGapArrayBytes;
+    if(parameters.maxGapArrayBytes > 0 && gapArrayBytes == 0)
+        gapArrayBytes = 1;
+
+    std::string bwt_outname = makeFilename(parameters.outPrefix, parameters.bwtExtension);
+    std::string rbwt_outname = makeFilename(parameters.outPrefix, parameters.rbwtExtension);
+
+    GapArray* pGapArray = NULL;
+    if(doForward)
+        pGapArray = createGapArray(parameters.storageLevel, pBWT->getBWLen() + 1, 
+                                   gapArrayBytes, parameters.numThreads, bwt_outname);
+
+    GapArray* pRGapArray = NULL;
+    if(doReverse)
+        pRGapArray = createGapArray(parameters.storageLevel, pRBWT->getBWLen() + 1, 
+                                    gapArrayBytes, parameters.numThreads, rbwt_outname);
+
+    SeqReader* pReader = new SeqReader(parameters.inFile);
+    size_t num_strings_read = 0;
+    size_t num_symbols_read = 0;
+    computeGapArrays(pReader, (size_t)-1, pBWT, pGapArray, pRBWT, pRGapArray, 
+                     parameters.numThreads, RM_APPEND, num_strings_read, num_symbols_read);
+    delete pReader;
+
+    // The existing bwts are streamed from disk from here on
+    delete pBWT;
+    delete pRBWT;
+
+    // Write the merged BWTs/SAIs to disk
+#if HAVE_OPENMP
+    #pragma omp parallel sections num_threads(2) if(parameters.numThreads > 1)
+#endif
+    {
+#if HAVE_OPENMP
+        #pragma omp section
+#endif
+        {
+            if(doForward)
+                writeAppendedIndex(makeFilename(indexPrefix, parameters.bwtExtension), 
+                                   makeFilename(indexPrefix, parameters.saiExtension),
+                                   makeFilename(newPrefix, parameters.bwtExtension), 
+                                   makeFilename(newPrefix, parameters.saiExtension),
+                                   bwt_outname, makeFilename(parameters.outPrefix, parameters.saiExtension), 
+                                   pGapArray);
+        }
+
+#if HAVE_OPENMP
+        #pragma omp section
+#endif
+        {
+            if(doReverse)
+                writeAppendedIndex(makeFilename(indexPrefix, parameters.rbwtExtension), 
+                                   makeFilename(indexPrefix, parameters.rsaiExtension),
+                                   makeFilename(newPrefix, parameters.rbwtExtension), 
+                                   makeFilename(newPrefix, parameters.rsaiExtension),
+                                   rbwt_outname, makeFilename(parameters.outPrefix, parameters.rsaiExtension), 
+                                   pRGapArray);
+        }
+    }
+
+    delete pGapArray;
+    delete pRGapArray;
+}
+
 // Construct new indices without the reads in readsToRemove
 void removeReadsFromIndices(const std::string& allReadsPrefix, const std::string& readsToRemove,
                              const std::string& outPrefix, const std::string& bwt_extension, 
@@ -332,7 +491,7 @@ void removeReadsFromIndices(const std::string& allReadsPrefix, const std::string
 
     size_t num_strings_remove;
     size_t num_symbols_remove;
-    computeGapArray(pReader, (size_t)-1, pBWT, doReverse, numThreads, pGapArray, true, num_strings_remove, num_symbols_remove);
+    computeGapArray(pReader, (size_t)-1, pBWT, doReverse, numThreads, pGapArray, RM_REMOVE, num_strings_remove, num_symbols_remove);
 
     //writeRemovalIndex();
     writeRemovalIndex(pBWT, sai_filename, bwt_out_name, sai_out_name, num_strings_remove, num_symbols_remove, pGapArray);
@@ -349,17 +508,20 @@ void removeReadsFromIndices(const std::string& allReadsPrefix, const std::string
 void mergeReadFiles(const std::string& readsFile1, const std::string& readsFile2, const std::string& outPrefix)
 {
     // If the outfile is the empty string, append the reads in readsFile2 into readsFile1
-    // otherwise cat the files together
+    // otherwise cat the files together. The records are written as fasta
+    // unless the output is a fastq file.
     std::ostream* pWriter;
+    bool out_fastq;
     if(outPrefix.empty())
     {
+        out_fastq = isFastq(readsFile1);
         pWriter = createWriter(readsFile1, std::ios_base::out | std::ios_base::app);
     }
     else
     {
-        bool both_fastq = isFastq(readsFile1) && isFastq(readsFile2);
+        out_fastq = isFastq(readsFile1) && isFastq(readsFile2);
         bool both_gzip = isGzip(readsFile1) && isGzip(readsFile2);
-        std::string extension = both_fastq ? ".fastq" : ".fa";
+        std::string extension = out_fastq ? ".fastq" : ".fa";
         if(both_gzip)
             extension.append(".gz");
         std::string out_filename = outPrefix + extension;
@@ -369,77 +531,138 @@ void mergeReadFiles(const std::string& readsFile1, const std::string& readsFile2
         SeqReader reader(readsFile1);
         SeqRecord record;
         while(reader.get(record))
+        {
+            if(!out_fastq)
+                record.qual.clear();
             record.write(*pWriter);
+        }
     }
 
     // Copy reads2 to writer
     SeqReader reader(readsFile2);
     SeqRecord record;
     while(reader.get(record))
+    {
+        if(!out_fastq)
+            record.qual.clear();
         record.write(*pWriter);
+    }
     delete pWriter;
 }
 
 // Compute the gap array for the first n items in pReader
 void computeGapArray(SeqReader* pReader, size_t n, const BWT* pBWT, bool doReverse, int numThreads, GapArray* pGapArray, 
-                     bool removeMode, size_t& num_strings_read, size_t& num_symbols_read)
+                     RankMode mode, size_t& num_strings_read, size_t& num_symbols_read)
 {
-    // Create the gap array
-    size_t gap_array_size = pBWT->getBWLen() + 1;
-    pGapArray->resize(gap_array_size);
-
-    // The rank processor calculates the rank of every suffix of a given sequence
-    // and returns a vector of ranks. The postprocessor takes in the vector
-    // and updates the gap array
-    RankPostProcess postProcessor(pGapArray);
+    if(!doReverse)
+        computeGapArrays(pReader, n, pBWT, pGapArray, NULL, NULL, numThreads, mode, num_strings_read, num_symbols_read);
+    else
+        computeGapArrays(pReader, n, NULL, NULL, pBWT, pGapArray, numThreads, mode, num_strings_read, num_symbols_read);
+}
+
+// Compute the gap arrays of the forward and reverse BWTs for the first n items in pReader
+// from a single pass over the reads. Either BWT may be NULL.
+void computeGapArrays(SeqReader* pReader, size_t n, 
+                      const BWT* pBWT, GapArray* pGapArray,
+                      const BWT* pRBWT, GapArray* pRGapArray,
+                      int numThreads, RankMode mode,
+                      size_t& num_strings_read, size_t& num_symbols_read)
+{
+    // Create the gap arrays
+    if(pBWT != NULL)
+        pGapArray->resize(pBWT->getBWLen() + 1);
+    if(pRBWT != NULL)
+        pRGapArray->resize(pRBWT->getBWLen() + 1);
+
+    // The rank processors calculate the rank of every suffix of a given sequence
+    // and return a vector of ranks. The postprocessors take in the vector
+    // and update the gap arrays
+    RankPostProcess* pPostForward = pBWT != NULL ? new RankPostProcess(pGapArray) : NULL;
+    RankPostProcess* pPostReverse = pRBWT != NULL ? new RankPostProcess(pRGapArray) : NULL;
+    RankPostProcessPair postProcessor(pPostForward, pPostReverse);
+
+    // If a gap array buffers its updates, each rank process
+    // updates its own buffer
+    std::vector<GapArray*> threadGapArrays;
+    int numProcesses = std::max(numThreads, 1);
+    std::vector<RankProcess*> rankProcesses;
+    std::vector<RankProcessPair*> rankProcVec;
+    for(int i = 0; i < numProcesses; ++i)
+    {
+        RankProcess* pForward = NULL;
+        if(pBWT != NULL)
+        {
+            GapArray* pBuffer = pGapArray->createThreadBuffer();
+            threadGapArrays.push_back(pBuffer);
+            pForward = new RankProcess(pBWT, pBuffer != NULL ? pBuffer : pGapArray, false, mode);
+            rankProcesses.push_back(pForward);
+        }
+
+        RankProcess* pReverse = NULL;
+        if(pRBWT != NULL)
+        {
+            GapArray* pBuffer = pRGapArray->createThreadBuffer();
+            threadGapArrays.push_back(pBuffer);
+            pReverse = new RankProcess(pRBWT, pBuffer != NULL ? pBuffer : pRGapArray, true, mode);
+            rankProcesses.push_back(pReverse);
+        }
+        rankProcVec.push_back(new RankProcessPair(pForward, pReverse));
+    }
+
     size_t numProcessed = 0;
     if(numThreads <= 1)
     {
-        RankProcess processor(pBWT, pGapArray, doReverse, removeMode);
-
         numProcessed = 
            SequenceProcessFramework::processSequencesSerial<SequenceWorkItem,
-                                                            RankResult, 
-                                                            RankProcess, 
-                                                            RankPostProcess>(*pReader, &processor, &postProcessor, n);
+                                                            RankResultPair, 
+                                                            RankProcessPair, 
+                                                            RankPostProcessPair>(*pReader, rankProcVec[0], &postProcessor, n);
     }
     else
     {
-        typedef std::vector<RankProcess*> RankProcessVector;
-        RankProcessVector rankProcVec;
-        for(int i = 0; i < numThreads; ++i)
-        {
-            RankProcess* pProcess = new RankProcess(pBWT, pGapArray, doReverse, removeMode);
-            rankProcVec.push_back(pProcess);
-        }
-    
         numProcessed = 
            SequenceProcessFramework::processSequencesParallel<SequenceWorkItem,
-                                                              RankResult, 
-                                                              RankProcess, 
-                                                              RankPostProcess>(*pReader, rankProcVec, &postProcessor, n);
-
-        for(int i = 0; i < numThreads; ++i)
-            delete rankProcVec[i];
+                                                              RankResultPair, 
+                                                              RankProcessPair, 
+                                                              RankPostProcessPair>(*pReader, rankProcVec, &postProcessor, n);
     }
 
-    num_strings_read = postProcessor.getNumStringsProcessed();
-    num_symbols_read = postProcessor.getNumSymbolsProcessed();
+    for(size_t i = 0; i < rankProcVec.size(); ++i)
+        delete rankProcVec[i];
+    for(size_t i = 0; i < rankProcesses.size(); ++i)
+        delete rankProcesses[i];
+
+    // Write any buffered updates
+    for(size_t i = 0; i < threadGapArrays.size(); ++i)
+        delete threadGapArrays[i];
+
+    // Both post processors see every string
+    const RankPostProcess* pCounts = pPostForward != NULL ? pPostForward : pPostReverse;
+    num_strings_read = pCounts->getNumStringsProcessed();
+    num_symbols_read = pCounts->getNumSymbolsProcessed();
     assert(n == (size_t)-1 || (numProcessed == n));
+    (void)numProcessed;
+
+    delete pPostForward;
+    delete pPostReverse;
 }
 
-// Merge a pair of BWTs using disk storage
+// Merge a pair of BWTs using disk storage. The forward and reverse indices
+// named in outItem are built from the same pass over the reads.
 // Precondition: pReader is positioned at the start of the read block for item1
 int64_t merge(SeqReader* pReader,
-              const MergeItem& item1, const MergeItem& item2,
-              const std::string& bwt_outname, const std::string& sai_outname,
-              bool doReverse, int numThreads, int storageLevel)
+              const MergeItem& item1, const MergeItem& item2, const MergeItem& outItem,
+              int numThreads, int storageLevel, size_t maxGapArrayBytes)
 {
     std::cout << "Merge1: " << item1 << "\n";
     std::cout << "Merge2: " << item2 << "\n";
 
-    // Load the bwt of item2 into memory as the internal bwt
-    BWT* pBWTInternal = new BWT(item2.bwt_filename, BWT_SAMPLE_RATE);
+    bool doForward = !outItem.bwt_filename.empty();
+    bool doReverse = !outItem.rbwt_filename.empty();
+
+    // Load the bwts of item2 into memory as the internal bwts
+    BWT* pBWTInternal = doForward ? new BWT(item2.bwt_filename, BWT_SAMPLE_RATE) : NULL;
+    BWT* pRBWTInternal = doReverse ? new BWT(item2.rbwt_filename, BWT_SAMPLE_RATE) : NULL;
     
     // If end_index is -1, calculate the ranks for every sequence in the file
     // otherwise only calculate the rank for the next (end_index - start_index + 1) sequences
@@ -449,12 +672,27 @@ int64_t merge(SeqReader* pReader,
     // and increment the gap counts
     int64_t curr_idx = item1.start_index;
     
-    // Compute the gap/rank array
-    GapArray* pGapArray = createGapArray(storageLevel);
+    // Compute the gap/rank arrays. A gap array is spilled to temporary files 
+    // next to its output if it does not fit in its share of maxGapArrayBytes.
+    // When both directions are built the budget is split between them.
+    size_t gapArrayBytes = doForward && doReverse ? maxGapArrayBytes / 2 : maxGapArrayBytes;
+    if(maxGapArrayBytes > 0 && gapArrayBytes == 0)
+        gapArrayBytes = 1;
+
+    GapArray* pGapArray = NULL;
+    if(doForward)
+        pGapArray = createGapArray(storageLevel, pBWTInternal->getBWLen() + 1, 
+                                   gapArrayBytes, numThreads, outItem.bwt_filename);
+
+    GapArray* pRGapArray = NULL;
+    if(doReverse)
+        pRGapArray = createGapArray(storageLevel, pRBWTInternal->getBWLen() + 1, 
+                                    gapArrayBytes, numThreads, outItem.rbwt_filename);
+
     size_t num_strings_read = 0;
     size_t num_symbols_read = 0;
-    computeGapArray(pReader, n, pBWTInternal, doReverse, numThreads, pGapArray, 
-                    false, num_strings_read, num_symbols_read);
+    computeGapArrays(pReader, n, pBWTInternal, pGapArray, pRBWTInternal, pRGapArray, 
+                     numThreads, RM_ADD, num_strings_read, num_symbols_read);
 
     assert(n == (size_t)-1 || (num_strings_read == n));
 
@@ -462,25 +700,49 @@ int64_t merge(SeqReader* pReader,
     curr_idx += num_strings_read;
     assert(item1.end_index == -1 || (curr_idx == item1.end_index + 1 && curr_idx == item2.start_index));
 
-    // Write the merged BWT/SAI to disk
-    writeMergedIndex(pBWTInternal, item1, item2, bwt_outname, sai_outname, pGapArray);
+    // Write the merged BWTs/SAIs to disk
+#if HAVE_OPENMP
+    #pragma omp parallel sections num_threads(2) if(numThreads > 1)
+#endif
+    {
+#if HAVE_OPENMP
+        #pragma omp section
+#endif
+        {
+            if(doForward)
+                writeMergedIndex(pBWTInternal, item1.bwt_filename, item1.sai_filename, item2.sai_filename,
+                                 outItem.bwt_filename, outItem.sai_filename, pGapArray);
+        }
+
+#if HAVE_OPENMP
+        #pragma omp section
+#endif
+        {
+            if(doReverse)
+                writeMergedIndex(pRBWTInternal, item1.rbwt_filename, item1.rsai_filename, item2.rsai_filename,
+                                 outItem.rbwt_filename, outItem.rsai_filename, pRGapArray);
+        }
+    }
 
     delete pBWTInternal;
+    delete pRBWTInternal;
     delete pGapArray;
+    delete pRGapArray;
     return curr_idx;
 }
 
 // Merge the internal and external BWTs and the SAIs
-void writeMergedIndex(const BWT* pBWTInternal, const MergeItem& externalItem, 
-                      const MergeItem& internalItem, const std::string& bwt_outname,
-                      const std::string& sai_outname, const GapArray* pGapArray)
+void writeMergedIndex(const BWT* pBWTInternal, const std::string& bwt_ext_name, 
+                      const std::string& sai_ext_name, const std::string& sai_int_name,
+                      const std::string& bwt_outname, const std::string& sai_outname, 
+                      const GapArray* pGapArray)
 {
     IBWTWriter* pBWTWriter = BWTWriter::createWriter(bwt_outname);
-    IBWTReader* pBWTExtReader = BWTReader::createReader(externalItem.bwt_filename);
+    IBWTReader* pBWTExtReader = BWTReader::createReader(bwt_ext_name);
     
     SAWriter saiWriter(sai_outname);
-    SAReader saiExtReader(externalItem.sai_filename);
-    SAReader saiIntReader(internalItem.sai_filename);
+    SAReader saiExtReader(sai_ext_name);
+    SAReader saiIntReader(sai_int_name);
 
     // Calculate and write header values
     size_t disk_strings;
@@ -510,22 +772,10 @@ void writeMergedIndex(const BWT* pBWTInternal, const MergeItem& externalItem,
     size_t num_sai_wrote = 0;
     for(size_t i = 0; i < pGapArray->size(); ++i)
     {
-        size_t v = pGapArray->get(i);
-        for(size_t j = 0; j < v; ++j)
-        {
-            char b = pBWTExtReader->readBWChar();
-            assert(b != '\n');
-            pBWTWriter->writeBWChar(b);
-            ++num_bwt_wrote;
-            
-            if(b == '$')
-            {
-                // The external indices only need to be copied
-                SAElem e = saiExtReader.readElem(); 
-                saiWriter.writeElem(e);
-                ++num_sai_wrote;
-            }
-        }
+        // Copy the external symbols a run at a time. The external
+        // indices only need to be copied.
+        num_bwt_wrote += copyBWSymbols(pBWTExtReader, &saiExtReader, pGapArray->get(i), 0,
+                                       pBWTWriter, &saiWriter, num_sai_wrote);
         
         // If this is the last entry in the gap array, do not output a symbol from
         // the internal BWT
@@ -570,6 +820,106 @@ void writeMergedIndex(const BWT* pBWTInternal, const MergeItem& externalItem,
     delete pBWTWriter;
 }
 
+// Merge a new BWT and SAI into an existing BWT and SAI. The gap array is indexed
+// by the existing BWT and gives the number of new symbols to write before each
+// existing symbol. Both BWTs are streamed from disk. The new reads follow the
+// existing reads so the IDs in the new SAI are offset by the number of existing strings.
+void writeAppendedIndex(const std::string& bwt_inname, const std::string& sai_inname,
+                        const std::string& bwt_newname, const std::string& sai_newname,
+                        const std::string& bwt_outname, const std::string& sai_outname, 
+                        const GapArray* pGapArray)
+{
+    IBWTWriter* pBWTWriter = BWTWriter::createWriter(bwt_outname);
+    IBWTReader* pBWTInReader = BWTReader::createReader(bwt_inname);
+    IBWTReader* pBWTNewReader = BWTReader::createReader(bwt_newname);
+    
+    SAWriter saiWriter(sai_outname);
+    SAReader saiInReader(sai_inname);
+    SAReader saiNewReader(sai_newname);
+
+    // Calculate and write header values
+    size_t in_strings, in_symbols;
+    size_t new_strings, new_symbols;
+    BWFlag flag;
+    pBWTInReader->readHeader(in_strings, in_symbols, flag);
+    pBWTNewReader->readHeader(new_strings, new_symbols, flag);
+    assert(pGapArray->size() == in_symbols + 1);
+
+    size_t total_strings = in_strings + new_strings;
+    size_t total_symbols = in_symbols + new_symbols;
+    pBWTWriter->writeHeader(total_strings, total_symbols, BWF_NOFMI);
+
+    size_t discard1, discard2;
+    saiInReader.readHeader(discard1, discard2);
+    saiNewReader.readHeader(discard1, discard2);
+    saiWriter.writeHeader(total_strings, total_strings);
+
+    // Most entries of the gap array are zero so the existing
+    // symbols between two insertion points are copied as a block
+    size_t num_bwt_wrote = 0;
+    size_t num_sai_wrote = 0;
+    size_t i = 0;
+    while(i < pGapArray->size())
+    {
+        num_bwt_wrote += copyBWSymbols(pBWTNewReader, &saiNewReader, pGapArray->get(i), in_strings,
+                                       pBWTWriter, &saiWriter, num_sai_wrote);
+
+        size_t j = i + 1;
+        while(j < pGapArray->size() && pGapArray->get(j) == 0)
+            ++j;
+
+        // The last entry of the gap array has no existing symbol
+        size_t num_existing = std::min(j, in_symbols) - std::min(i, in_symbols);
+        num_bwt_wrote += copyBWSymbols(pBWTInReader, &saiInReader, num_existing, 0,
+                                       pBWTWriter, &saiWriter, num_sai_wrote);
+        i = j;
+    }
+
+    if(num_bwt_wrote != total_symbols)
+    {
+        printf("Error expected to write %zu symbols, actually wrote %zu\n", total_symbols, num_bwt_wrote);
+        assert(num_bwt_wrote == total_symbols);
+    }
+    assert(num_sai_wrote == total_strings);
+
+    // Finalize the BWT disk file
+    pBWTWriter->finalize();
+
+    delete pBWTNewReader;
+    delete pBWTInReader;
+    delete pBWTWriter;
+}
+
+// Copy count symbols from pBWTReader to pBWTWriter a run at a time. For each '$'
+// the next element of the SAI is copied with its ID offset by id_offset.
+// Returns the number of symbols copied, which is less than count if the input is truncated.
+size_t copyBWSymbols(IBWTReader* pBWTReader, SAReader* pSAIReader, size_t count, uint64_t id_offset,
+                     IBWTWriter* pBWTWriter, SAWriter* pSAIWriter, size_t& num_sai_wrote)
+{
+    size_t num_copied = 0;
+    while(num_copied < count)
+    {
+        char b;
+        size_t n = pBWTReader->readBWRun(b, count - num_copied);
+        if(n == 0)
+            break; // truncated input, caught by the caller's symbol count
+        pBWTWriter->writeBWRun(b, n);
+        num_copied += n;
+
+        if(b == '$')
+        {
+            for(size_t j = 0; j < n; ++j)
+            {
+                SAElem e = pSAIReader->readElem(); 
+                e.setID(e.getID() + id_offset);
+                pSAIWriter->writeElem(e);
+                ++num_sai_wrote;
+            }
+        }
+    }
+    return num_copied;
+}
+
 // Write a new BWT and SAI that skips the elements marked
 // by the gap array. This is used to remove entire strings from the 
 // index
@@ -691,6 +1041,47 @@ void writeRemovalIndex(const BWT* pBWTInternal, const std::string& sai_inname,
     delete pBWTWriter;
 }
 
+// Build the SA of the reads in pRT and write the BWT and SAI
+void writeInitialIndex(const ReadTable* pRT, const std::string& bwt_filename, const std::string& sai_filename)
+{
+    SuffixArray* pSA = new SuffixArray(pRT, 1);
+    pSA->writeBWT(bwt_filename, pRT);
+    std::string sai_out = sai_filename;
+    pSA->writeIndex(sai_out);
+    delete pSA;
+}
+
+// Set the forward or reverse index files of item
+void setIndexFiles(MergeItem& item, bool doReverse, const std::string& bwt_filename, const std::string& sai_filename)
+{
+    if(!doReverse)
+    {
+        item.bwt_filename = bwt_filename;
+        item.sai_filename = sai_filename;
+    }
+    else
+    {
+        item.rbwt_filename = bwt_filename;
+        item.rsai_filename = sai_filename;
+    }
+}
+
+// Remove the temporary index files of item
+void removeIndexFiles(const MergeItem& item)
+{
+    if(!item.bwt_filename.empty())
+    {
+        unlink(item.bwt_filename.c_str());
+        unlink(item.sai_filename.c_str());
+    }
+
+    if(!item.rbwt_filename.empty())
+    {
+        unlink(item.rbwt_filename.c_str());
+        unlink(item.rsai_filename.c_str());
+    }
+}
+
 //
 std::string makeTempName(const std::string& prefix, int id, const std::string& extension)
 {
@@ -18,15 +18,21 @@
 #include "SuffixArray.h"
 #include "BWT.h"
 
+// The forward and reverse indices are built together
+// from a single pass over the reads if both are requested
 struct BWTDiskParameters
 {
     std::string inFile;
     std::string outPrefix;
     std::string bwtExtension;
     std::string saiExtension;
+    std::string rbwtExtension;
+    std::string rsaiExtension;
     size_t numReadsPerBatch;
     int numThreads;
     int storageLevel;
+    size_t maxGapArrayBytes; // zero for no limit
+    bool bBuildForward;
     bool bBuildReverse;
     bool bUseBCR;
 };
@@ -38,13 +44,21 @@ void buildBWTDisk(const BWTDiskParameters& parameters);
 // Merge the indices for the readsFile1 and readsFile2
 void mergeIndependentIndices(const std::string& readsFile1, const std::string& readsFile2, 
                              const std::string& outPrefix, const std::string& bwt_extension, 
-                             const std::string& sai_extension, bool doReverse, int numThreads, int storageLevel);
+                             const std::string& sai_extension, bool doReverse, int numThreads, int storageLevel,
+                             size_t maxGapArrayBytes);
+
+// Merge the index of the new reads in parameters.inFile, with files starting with newPrefix,
+// into the existing index with files starting with indexPrefix and write the result to
+// parameters.outPrefix. The new reads follow the existing reads and only the new reads
+// are parsed. numReadsPerBatch and bUseBCR are not used.
+void appendToIndex(const BWTDiskParameters& parameters, const std::string& indexPrefix, const std::string& newPrefix);
 
 // Compute new indices from allReadsFile without the reads in readsToRemove
 void removeReadsFromIndices(const std::string& allReadsFile, const std::string& readsToRemove,
                              const std::string& outPrefix, const std::string& bwt_extension, 
                              const std::string& sai_extension, bool doReverse, int numThreads);
 
-//
+// Merge the reads files into outPrefix, or append readsFile2 to readsFile1 if outPrefix is empty.
+// The qualities are dropped unless the output is a fastq file.
 void mergeReadFiles(const std::string& readsFile1, const std::string& readsFile2, const std::string& outPrefix);
 #endif
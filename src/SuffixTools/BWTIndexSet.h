@@ -24,11 +24,16 @@
 struct BWTIndexSet
 {
     // Constructor
-    BWTIndexSet() : pBWT(NULL), pRBWT(NULL), pCache(NULL), pSSA(NULL), pPopIdx(NULL), pQualityTable(NULL) {}
+    BWTIndexSet() : pBWT(NULL), pRBWT(NULL), pDeltaBWT(NULL), pCache(NULL), pSSA(NULL), pPopIdx(NULL), pQualityTable(NULL) {}
 
     // Data
     const BWT* pBWT;
     const BWT* pRBWT;
+
+    // Index of reads appended after pBWT was built. If set, it is
+    // included in the sequence counts of BWTAlgorithms. Interval
+    // queries use pBWT alone. Only sga correct loads it.
+    const BWT* pDeltaBWT;
     const BWTIntervalCache* pCache;
     const SampledSuffixArray* pSSA;
     const PopulationIndex* pPopIdx;
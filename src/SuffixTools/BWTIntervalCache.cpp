@@ -9,6 +9,7 @@
 //
 #include "BWTIntervalCache.h"
 #include "BWTAlgorithms.h"
+#include "NumaUtil.h"
 
 BWTIntervalCache::BWTIntervalCache(size_t k, const BWT* pBWT) : m_kmer(k)
 {
@@ -54,3 +55,21 @@ size_t BWTIntervalCache::getCachedLength() const
 {
     return m_kmer;
 }
+
+//
+bool BWTIntervalCache::interleaveMemory() const
+{
+    return NumaUtil::interleaveMemory(&m_table[0], m_table.size() * sizeof(BWTInterval));
+}
+
+//
+bool BWTIntervalCache::bindMemory(int node) const
+{
+    return NumaUtil::bindMemory(&m_table[0], m_table.size() * sizeof(BWTInterval), node);
+}
+
+//
+void BWTIntervalCache::addMemoryByNode(std::vector<size_t>& nodeBytes) const
+{
+    NumaUtil::addMemoryByNode(&m_table[0], m_table.size() * sizeof(BWTInterval), nodeBytes);
+}
@@ -12,6 +12,7 @@
 
 #include "BWT.h"
 #include "BWTInterval.h"
+#include "HugePageAllocator.h"
 
 class BWTIntervalCache
 {
@@ -31,6 +32,11 @@ class BWTIntervalCache
         // 
         size_t getCachedLength() const;
 
+        // Place the table on the NUMA nodes, see NumaUtil.h
+        bool interleaveMemory() const;
+        bool bindMemory(int node) const;
+        void addMemoryByNode(std::vector<size_t>& nodeBytes) const;
+
     private:
 
         // Build the array for the given BWt
@@ -52,7 +58,7 @@ class BWTIntervalCache
         std::string int2string(size_t i) const;
 
         size_t m_kmer;
-        std::vector<BWTInterval> m_table;
+        std::vector<BWTInterval, HugePageAllocator<BWTInterval> > m_table;
 };
 
 #endif
@@ -46,6 +46,16 @@ class IBWTReader
         virtual void read(RLBWT* pRLBWT) = 0;
         virtual void readHeader(size_t& num_strings, size_t& num_symbols, BWFlag& flag) = 0; 
         virtual char readBWChar() = 0;
+
+        // Read up to maxCount copies of the next symbol of the BW string into b.
+        // Returns the number of symbols read, which is zero at the end of the string.
+        virtual size_t readBWRun(char& b, size_t maxCount)
+        {
+            assert(maxCount > 0);
+            (void)maxCount;
+            b = readBWChar();
+            return b != '\n' ? 1 : 0;
+        }
 };
 
 namespace BWTReader
@@ -108,3 +108,29 @@ char BWTReaderBinary::readBWChar()
     m_currRun.decrementCount();
     return m_currRun.getChar();
 }
+
+// Read symbols from the current run, up to maxCount of them. If
+// the current run is exhausted the next run is read from disk.
+size_t BWTReaderBinary::readBWRun(char& b, size_t maxCount)
+{
+    assert(m_stage == IOS_BWSTR);
+    assert(maxCount > 0);
+
+    if(m_currRun.isEmpty())
+    {
+        if(m_numRunsRead == m_numRunsOnDisk)
+        {
+            b = '\n';
+            return 0;
+        }
+
+        m_pReader->read(reinterpret_cast<char*>(&m_currRun), sizeof(RLUnit));
+        ++m_numRunsRead;
+    }
+
+    b = m_currRun.getChar();
+    size_t n = std::min<size_t>(m_currRun.getCount(), maxCount);
+    for(size_t i = 0; i < n; ++i)
+        m_currRun.decrementCount();
+    return n;
+}
@@ -31,6 +31,7 @@ class BWTReaderBinary : public IBWTReader
 
         virtual void readHeader(size_t& num_strings, size_t& num_symbols, BWFlag& flag);
         virtual char readBWChar();
+        virtual size_t readBWRun(char& b, size_t maxCount);
         virtual void readRuns(RLVector& out, size_t numRuns);
 
     private:
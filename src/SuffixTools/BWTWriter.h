@@ -27,6 +27,13 @@ class IBWTWriter
         void write(const SuffixArray* pSA, const ReadTable* pRT);
         virtual void writeHeader(const size_t& num_strings, const size_t& num_symbols, const BWFlag& flag) = 0;
         virtual void writeBWChar(char b) = 0;
+
+        // Write count copies of b
+        virtual void writeBWRun(char b, size_t count)
+        {
+            for(size_t i = 0; i < count; ++i)
+                writeBWChar(b);
+        }
         virtual void finalize() = 0;
 };
 
@@ -70,6 +70,35 @@ void BWTWriterBinary::writeBWChar(char b)
     }
 }
 
+// Write count copies of b, extending the current run if it has the same symbol
+void BWTWriterBinary::writeBWRun(char b, size_t count)
+{
+    if(count == 0)
+        return;
+
+    if(!m_currRun.isInitialized() || m_currRun.getChar() != b || m_currRun.isFull())
+    {
+        if(m_currRun.isInitialized())
+            writeRun(m_currRun);
+        m_currRun = RLUnit(b);
+        --count;
+    }
+
+    while(count > 0)
+    {
+        if(m_currRun.isFull())
+        {
+            writeRun(m_currRun);
+            m_currRun = RLUnit(b);
+        }
+        else
+        {
+            m_currRun.incrementCount();
+        }
+        --count;
+    }
+}
+
 //
 void BWTWriterBinary::writeRun(RLUnit& unit)
 {
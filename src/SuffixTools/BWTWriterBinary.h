@@ -29,6 +29,7 @@ class BWTWriterBinary : public IBWTWriter
         // Write an RLBWT file directly from a suffix array and read table
         virtual void writeHeader(const size_t& num_strings, const size_t& num_symbols, const BWFlag& flag);
         virtual void writeBWChar(char b);
+        virtual void writeBWRun(char b, size_t count);
         virtual void finalize(); // this method must be called after writing the BW string
 
     private:
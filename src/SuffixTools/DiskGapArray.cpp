@@ -0,0 +1,268 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// DiskGapArray - A gap array with bounded memory usage.
+// See DiskGapArray.h
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "DiskGapArray.h"
+
+// The ranges are never narrower than this to bound the number
+// of temporary files
+static const size_t MIN_RANGE_WIDTH = 1 << 20;
+
+// Offsets within a range are stored in 32 bits
+static const size_t MAX_RANGE_WIDTH = (size_t)1 << 32;
+
+// Number of offsets read from or written to a range file at a time
+static const size_t CHUNK_SIZE = 1 << 20;
+
+//
+DiskGapArray::DiskGapArray(int storage, size_t maxBytes, int numThreads,
+                           const std::string& tempPrefix) : m_storage(storage),
+                                                            m_tempPrefix(tempPrefix),
+                                                            m_size(0),
+                                                            m_rangeWidth(0),
+                                                            m_numRanges(0),
+                                                            m_pRange(NULL),
+                                                            m_loadedRange(0)
+{
+    // Half of the budget is used for the loaded range, the rest is
+    // split between the thread buffers and the serial buffer
+    size_t rangeBytes = maxBytes / 2;
+    m_maxRangeWidth = std::max(MIN_RANGE_WIDTH, std::min(MAX_RANGE_WIDTH, rangeBytes * 8 / storage));
+    m_bufferCapacity = std::max((size_t)1024, (maxBytes - rangeBytes) / ((numThreads + 1) * sizeof(uint64_t)));
+
+    int ret = pthread_mutex_init(&m_mutex, NULL);
+    if(ret != 0)
+    {
+        std::cerr << "Mutex initialization failed with error " << ret << ", aborting" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//
+DiskGapArray::~DiskGapArray()
+{
+    removeRangeFiles();
+    delete m_pRange;
+
+    int ret = pthread_mutex_destroy(&m_mutex);
+    if(ret != 0)
+    {
+        std::cerr << "Mutex destruction failed with error " << ret << ", aborting" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//
+void DiskGapArray::resize(size_t n)
+{
+    removeRangeFiles();
+    delete m_pRange;
+    m_pRange = NULL;
+    m_serialUpdates.clear();
+
+    m_size = n;
+    m_rangeWidth = std::max((size_t)1, std::min(n, m_maxRangeWidth));
+    m_numRanges = (n + m_rangeWidth - 1) / m_rangeWidth;
+    m_rangeUpdates.assign(m_numRanges, 0);
+}
+
+//
+bool DiskGapArray::attemptBaseIncrement(size_t /*i*/)
+{
+    return false;
+}
+
+//
+void DiskGapArray::incrementOverflowSerial(size_t i)
+{
+    assert(i < m_size);
+    m_serialUpdates.push_back(i);
+    if(m_serialUpdates.size() >= m_bufferCapacity)
+        writeUpdates(m_serialUpdates);
+}
+
+// The counts are materialized one range at a time so the
+// array must be read in increasing order of i
+size_t DiskGapArray::get(size_t i) const
+{
+    assert(i < m_size);
+    if(!m_serialUpdates.empty())
+        writeUpdates(m_serialUpdates);
+
+    size_t k = i / m_rangeWidth;
+    if(m_pRange == NULL || k != m_loadedRange)
+        loadRange(k);
+    return m_pRange->get(i - k * m_rangeWidth);
+}
+
+//
+size_t DiskGapArray::size() const
+{
+    return m_size;
+}
+
+//
+GapArray* DiskGapArray::createThreadBuffer()
+{
+    return new DiskGapArrayBuffer(this, m_bufferCapacity);
+}
+
+//
+void DiskGapArray::writeUpdates(std::vector<uint64_t>& ranks) const
+{
+    std::sort(ranks.begin(), ranks.end());
+
+    std::vector<uint32_t> offsets;
+    pthread_mutex_lock(&m_mutex);
+    size_t i = 0;
+    while(i < ranks.size())
+    {
+        // Collect the run of ranks that fall in the same range
+        size_t k = ranks[i] / m_rangeWidth;
+        size_t rangeStart = k * m_rangeWidth;
+        size_t rangeEnd = rangeStart + m_rangeWidth;
+
+        std::string filename = getRangeFilename(k);
+        FILE* pFile = fopen(filename.c_str(), "ab");
+        bool failed = pFile == NULL;
+        while(!failed && i < ranks.size() && ranks[i] < rangeEnd)
+        {
+            offsets.clear();
+            while(i < ranks.size() && ranks[i] < rangeEnd && offsets.size() < CHUNK_SIZE)
+                offsets.push_back(ranks[i++] - rangeStart);
+            failed = fwrite(&offsets[0], sizeof(uint32_t), offsets.size(), pFile) != offsets.size();
+            m_rangeUpdates[k] += offsets.size();
+        }
+
+        if(failed)
+        {
+            std::cerr << "Error: could not write gap array updates to " << filename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        fclose(pFile);
+    }
+    pthread_mutex_unlock(&m_mutex);
+    ranks.clear();
+}
+
+// Build the counts of range k by applying all of its updates
+void DiskGapArray::loadRange(size_t k) const
+{
+    delete m_pRange;
+    m_pRange = createGapArray(m_storage);
+    m_loadedRange = k;
+
+    size_t rangeStart = k * m_rangeWidth;
+    m_pRange->resize(std::min(m_rangeWidth, m_size - rangeStart));
+    if(m_rangeUpdates[k] == 0)
+        return;
+
+    std::string filename = getRangeFilename(k);
+    FILE* pFile = fopen(filename.c_str(), "rb");
+    if(pFile == NULL)
+    {
+        std::cerr << "Error: could not read gap array updates from " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<uint32_t> offsets(CHUNK_SIZE);
+    size_t numRead = 0;
+    size_t n;
+    while((n = fread(&offsets[0], sizeof(uint32_t), offsets.size(), pFile)) > 0)
+    {
+        for(size_t j = 0; j < n; ++j)
+        {
+            if(!m_pRange->attemptBaseIncrement(offsets[j]))
+                m_pRange->incrementOverflowSerial(offsets[j]);
+        }
+        numRead += n;
+    }
+    fclose(pFile);
+
+    if(numRead != m_rangeUpdates[k])
+    {
+        std::cerr << "Error: expected " << m_rangeUpdates[k] << " gap array updates in "
+                  << filename << " but read " << numRead << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+
+//
+std::string DiskGapArray::getRangeFilename(size_t k) const
+{
+    std::stringstream ss;
+    ss << m_tempPrefix << ".gap-" << k << ".tmp";
+    return ss.str();
+}
+
+//
+void DiskGapArray::removeRangeFiles()
+{
+    for(size_t k = 0; k < m_rangeUpdates.size(); ++k)
+    {
+        if(m_rangeUpdates[k] > 0)
+            unlink(getRangeFilename(k).c_str());
+    }
+    m_rangeUpdates.clear();
+}
+
+//
+// DiskGapArrayBuffer
+//
+DiskGapArrayBuffer::DiskGapArrayBuffer(const DiskGapArray* pParent, size_t capacity) : m_pParent(pParent),
+                                                                                       m_capacity(capacity)
+{
+    m_ranks.reserve(m_capacity);
+}
+
+//
+DiskGapArrayBuffer::~DiskGapArrayBuffer()
+{
+    if(!m_ranks.empty())
+        m_pParent->writeUpdates(m_ranks);
+}
+
+//
+void DiskGapArrayBuffer::resize(size_t /*n*/)
+{
+    assert(false);
+}
+
+//
+bool DiskGapArrayBuffer::attemptBaseIncrement(size_t i)
+{
+    assert(i < m_pParent->size());
+    m_ranks.push_back(i);
+    if(m_ranks.size() >= m_capacity)
+        m_pParent->writeUpdates(m_ranks);
+    return true;
+}
+
+//
+void DiskGapArrayBuffer::incrementOverflowSerial(size_t i)
+{
+    attemptBaseIncrement(i);
+}
+
+// The buffered counts are not readable
+size_t DiskGapArrayBuffer::get(size_t /*i*/) const
+{
+    assert(false);
+    return 0;
+}
+
+//
+size_t DiskGapArrayBuffer::size() const
+{
+    return m_pParent->size();
+}
@@ -0,0 +1,106 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// DiskGapArray - A gap array with bounded memory usage.
+// Rank updates are collected in per-thread buffers. When
+// a buffer is full it is sorted, split into fixed-size
+// ranges of the rank space and appended to one temporary
+// file per range. The counts for a range are only
+// materialized, in a SparseGapArray, when the range
+// is read. The array must be read in increasing
+// rank order, as writeMergedIndex does.
+//
+#ifndef DISKGAPARRAY_H
+#define DISKGAPARRAY_H
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "GapArray.h"
+
+class DiskGapArray : public GapArray
+{
+    public:
+
+        // storage is the number of bits per element used for a range
+        // when it is loaded, as in createGapArray. maxBytes is the
+        // memory budget for the loaded range and the update buffers of
+        // numThreads threads. The range files are named with tempPrefix.
+        DiskGapArray(int storage, size_t maxBytes, int numThreads, const std::string& tempPrefix);
+        ~DiskGapArray();
+
+        void resize(size_t n);
+
+        // Updates to the shared array are not buffered per thread
+        // so this always fails and the update must be made with
+        // incrementOverflowSerial. Use createThreadBuffer instead.
+        bool attemptBaseIncrement(size_t i);
+        void incrementOverflowSerial(size_t i);
+
+        size_t get(size_t i) const;
+        size_t size() const;
+
+        GapArray* createThreadBuffer();
+
+        // Sort the ranks and append them to the files of the ranges they fall in.
+        // The vector is cleared. Thread safe.
+        void writeUpdates(std::vector<uint64_t>& ranks) const;
+
+    private:
+
+        // Not copyable
+        DiskGapArray(const DiskGapArray&);
+        DiskGapArray& operator=(const DiskGapArray&);
+
+        //
+        void loadRange(size_t k) const;
+        std::string getRangeFilename(size_t k) const;
+        void removeRangeFiles();
+
+        //
+        int m_storage;
+        size_t m_bufferCapacity;
+        size_t m_maxRangeWidth;
+        std::string m_tempPrefix;
+
+        size_t m_size;
+        size_t m_rangeWidth;
+        size_t m_numRanges;
+
+        // Number of updates written to the file of each range
+        mutable std::vector<size_t> m_rangeUpdates;
+        mutable pthread_mutex_t m_mutex;
+
+        // Updates made through incrementOverflowSerial that
+        // have not been written yet
+        mutable std::vector<uint64_t> m_serialUpdates;
+
+        // The counts of the range being read
+        mutable GapArray* m_pRange;
+        mutable size_t m_loadedRange;
+};
+
+// Per-thread update buffer for a DiskGapArray. Updates always
+// succeed. The buffer is written when it is full and when it is destroyed,
+// which must happen before the gap array is read.
+class DiskGapArrayBuffer : public GapArray
+{
+    public:
+        DiskGapArrayBuffer(const DiskGapArray* pParent, size_t capacity);
+        ~DiskGapArrayBuffer();
+
+        void resize(size_t n);
+        bool attemptBaseIncrement(size_t i);
+        void incrementOverflowSerial(size_t i);
+        size_t get(size_t i) const;
+        size_t size() const;
+
+    private:
+        const DiskGapArray* m_pParent;
+        size_t m_capacity;
+        std::vector<uint64_t> m_ranks;
+};
+
+#endif
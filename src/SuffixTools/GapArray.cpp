@@ -9,6 +9,7 @@
 //
 #include "GapArray.h"
 #include "SparseGapArray.h"
+#include "DiskGapArray.h"
 #if 0
 // SimpleGapArray
 SimpleGapArray::SimpleGapArray()
@@ -67,6 +68,16 @@ GapArray* createGapArray(int storage)
     }
 }
 
+// Construct a gap array that fits within maxBytes, if given. The memory
+// of an in-memory array is estimated from the base storage only
+GapArray* createGapArray(int storage, size_t n, size_t maxBytes, int numThreads, const std::string& tempPrefix)
+{
+    size_t baseBytes = (n / 8 + 1) * storage;
+    if(maxBytes == 0 || baseBytes <= maxBytes)
+        return createGapArray(storage);
+    return new DiskGapArray(storage, maxBytes, numThreads, tempPrefix);
+}
+
 // Increment the gap array for each suffix of seq. Not thread safe.
 void updateGapArray(const DNAString& w, const BWT* pBWTInternal, GapArray* pGapArray)
 {
@@ -34,6 +34,11 @@ class GapArray
         virtual size_t get(size_t i) const = 0;
         virtual size_t size() const = 0;
 
+        // Gap arrays that buffer their updates return a new buffer
+        // that one thread can update without synchronization. The buffer
+        // must be deleted before the gap array is read. Returns NULL if
+        // the gap array is updated directly.
+        virtual GapArray* createThreadBuffer() { return NULL; }
 };
 
 #if 0
@@ -61,6 +66,11 @@ class SimpleGapArray : public GapArray
 //typedef uint32_t GAP_TYPE;
 //typedef std::vector<GAP_TYPE> GapArray;
 GapArray* createGapArray(int storage);
+
+// Construct a gap array for n elements that uses roughly maxBytes of memory.
+// If an in-memory gap array would not fit, the updates are spilled to
+// temporary files starting with tempPrefix. A maxBytes of zero means no limit.
+GapArray* createGapArray(int storage, size_t n, size_t maxBytes, int numThreads, const std::string& tempPrefix);
 void updateGapArray(const DNAString& w, const BWT* pBWTInternal, GapArray* pGapArray);
 void analyzeGapArray(GapArray* pGapArray);
 
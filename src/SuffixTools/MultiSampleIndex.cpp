@@ -0,0 +1,125 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// MultiSampleIndex - A federated index over the
+// independent FM-indices of a set of samples.
+// See MultiSampleIndex.h
+//
+#include <iostream>
+#include <sstream>
+#include "MultiSampleIndex.h"
+#include "BWTAlgorithms.h"
+#include "config.h"
+
+//
+MultiSampleIndex::MultiSampleIndex(int numThreads) : m_numThreads(numThreads)
+{
+
+}
+
+//
+MultiSampleIndex::~MultiSampleIndex()
+{
+    for(size_t i = 0; i < m_samples.size(); ++i)
+    {
+        delete m_samples[i].pCache;
+        delete m_samples[i].pBWT;
+    }
+}
+
+//
+void MultiSampleIndex::addSample(const std::string& name, const std::string& bwtFilename,
+                                 int sampleRate, size_t cacheLength)
+{
+    BWTIndexSet indices;
+    BWT* pBWT = new BWT(bwtFilename, sampleRate);
+    indices.pBWT = pBWT;
+    if(cacheLength > 0)
+        indices.pCache = new BWTIntervalCache(cacheLength, pBWT);
+
+    m_names.push_back(name);
+    m_samples.push_back(indices);
+}
+
+//
+void MultiSampleIndex::addSamplesFromFile(const std::string& filename, int sampleRate, size_t cacheLength)
+{
+    std::istream* pReader = createReader(filename);
+    std::string line;
+    while(getline(*pReader, line))
+    {
+        if(line.empty())
+            continue;
+
+        std::stringstream parser(line);
+        std::string name;
+        std::string bwtFilename;
+        parser >> name >> bwtFilename;
+        if(bwtFilename.empty())
+        {
+            std::cerr << "Error: expected a sample name and BWT file on line: " << line << "\n";
+            exit(EXIT_FAILURE);
+        }
+        addSample(name, bwtFilename, sampleRate, cacheLength);
+    }
+    delete pReader;
+}
+
+// A single query is split between the samples
+void MultiSampleIndex::findIntervals(const std::string& w, std::vector<BWTInterval>& out) const
+{
+    int n = m_samples.size();
+    out.resize(n);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for num_threads(m_numThreads) if(m_numThreads > 1 && n > 1)
+#endif
+    for(int i = 0; i < n; ++i)
+        out[i] = BWTAlgorithms::findInterval(m_samples[i], w);
+}
+
+//
+void MultiSampleIndex::countSequenceOccurrences(const std::string& w, std::vector<size_t>& out) const
+{
+    int n = m_samples.size();
+    out.resize(n);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for num_threads(m_numThreads) if(m_numThreads > 1 && n > 1)
+#endif
+    for(int i = 0; i < n; ++i)
+        out[i] = BWTAlgorithms::countSequenceOccurrences(w, m_samples[i]);
+}
+
+//
+size_t MultiSampleIndex::countTotalOccurrences(const std::string& w) const
+{
+    std::vector<size_t> counts;
+    countSequenceOccurrences(w, counts);
+
+    size_t total = 0;
+    for(size_t i = 0; i < counts.size(); ++i)
+        total += counts[i];
+    return total;
+}
+
+// The queries, rather than the samples, are split between the threads
+// so each thread works on a larger unit
+void MultiSampleIndex::countSequenceOccurrences(const StringVector& queries,
+                                                std::vector<std::vector<size_t> >& out) const
+{
+    int numQueries = queries.size();
+    out.resize(numQueries);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(m_numThreads) if(m_numThreads > 1)
+#endif
+    for(int i = 0; i < numQueries; ++i)
+    {
+        out[i].resize(m_samples.size());
+        for(size_t j = 0; j < m_samples.size(); ++j)
+            out[i][j] = BWTAlgorithms::countSequenceOccurrences(queries[i], m_samples[j]);
+    }
+}
@@ -0,0 +1,72 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// MultiSampleIndex - A federated index over the
+// independent FM-indices of a set of samples. Queries
+// are answered for every sample in one call and return
+// per-sample results, in the order the samples were added.
+// Unlike a merged index with a PopulationIndex, a sample
+// can be added without rebuilding the other indices.
+//
+#ifndef MULTISAMPLEINDEX_H
+#define MULTISAMPLEINDEX_H
+
+#include "Util.h"
+#include "BWTIndexSet.h"
+#include "BWTInterval.h"
+
+class MultiSampleIndex
+{
+    public:
+
+        // Queries are dispatched to the samples using numThreads threads
+        MultiSampleIndex(int numThreads = 1);
+        ~MultiSampleIndex();
+
+        // Load the BWT in bwtFilename as a new sample. If cacheLength is
+        // greater than zero an interval cache of that length is built for it.
+        void addSample(const std::string& name, const std::string& bwtFilename,
+                       int sampleRate, size_t cacheLength);
+
+        // Load the samples listed in filename. Each line holds the name of a sample
+        // and the path to its BWT file, separated by whitespace.
+        void addSamplesFromFile(const std::string& filename, int sampleRate, size_t cacheLength);
+
+        //
+        size_t getNumSamples() const { return m_samples.size(); }
+        const std::string& getSampleName(size_t i) const { return m_names[i]; }
+        StringVector getSamples() const { return m_names; }
+
+        // The indices of sample i, usable with BWTAlgorithms
+        const BWTIndexSet& getSampleIndex(size_t i) const { return m_samples[i]; }
+
+        // Find the interval of w in the index of each sample
+        void findIntervals(const std::string& w, std::vector<BWTInterval>& out) const;
+
+        // Count the occurrences of w and its reverse complement in each sample
+        void countSequenceOccurrences(const std::string& w, std::vector<size_t>& out) const;
+
+        // Count the occurrences of w and its reverse complement over all samples
+        size_t countTotalOccurrences(const std::string& w) const;
+
+        // Count the occurrences of each query in each sample. out[i][j]
+        // is the count of queries[i] in sample j. The queries are
+        // distributed between the threads.
+        void countSequenceOccurrences(const StringVector& queries,
+                                      std::vector<std::vector<size_t> >& out) const;
+
+    private:
+
+        // Not copyable
+        MultiSampleIndex(const MultiSampleIndex&);
+        MultiSampleIndex& operator=(const MultiSampleIndex&);
+
+        //
+        int m_numThreads;
+        StringVector m_names;
+        std::vector<BWTIndexSet> m_samples;
+};
+
+#endif
@@ -0,0 +1,125 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// NumaIndexPlacement - Place read-only FM-indices
+// on the nodes of a NUMA machine.
+// See NumaIndexPlacement.h
+//
+#include <iostream>
+#include "NumaIndexPlacement.h"
+#include "NumaUtil.h"
+#include "Timer.h"
+
+// Place pIndex according to policy. The first element of the
+// returned vector is pIndex, the others are the copies for the
+// other nodes. T is a BWT or a BWTIntervalCache.
+template<typename T>
+static std::vector<const T*> placeIndex(const T* pIndex, NumaPlacementPolicy policy, int numNodes)
+{
+    Timer timer("NumaIndexPlacement", policy == NPP_NONE);
+    std::vector<const T*> copies(1, pIndex);
+    bool placed = true;
+
+    if(policy == NPP_INTERLEAVE)
+    {
+        placed = pIndex->interleaveMemory();
+    }
+    else if(policy == NPP_REPLICATE)
+    {
+        // The copy is first allocated on the node of this thread, then moved
+        placed = pIndex->bindMemory(0);
+        for(int n = 1; n < numNodes; ++n)
+        {
+            T* pCopy = new T(*pIndex);
+            placed = pCopy->bindMemory(n) && placed;
+            copies.push_back(pCopy);
+        }
+    }
+
+    if(!placed)
+        std::cerr << "Warning: the FM-index could not be placed on the NUMA nodes\n";
+    return copies;
+}
+
+//
+NumaIndexPlacement::NumaIndexPlacement(NumaPlacementPolicy policy) : m_policy(policy)
+{
+    m_numNodes = NumaUtil::getNumNodes();
+}
+
+//
+NumaIndexPlacement::~NumaIndexPlacement()
+{
+    for(size_t i = 0; i < m_copies.size(); ++i)
+    {
+        for(size_t n = 1; n < m_copies[i].size(); ++n)
+            delete m_copies[i][n];
+    }
+
+    for(size_t i = 0; i < m_cacheCopies.size(); ++i)
+    {
+        for(size_t n = 1; n < m_cacheCopies[i].size(); ++n)
+            delete m_cacheCopies[i][n];
+    }
+}
+
+//
+NumaPlacementPolicy NumaIndexPlacement::parsePolicy(const std::string& name)
+{
+    if(name == "none")
+        return NPP_NONE;
+    else if(name == "interleave")
+        return NPP_INTERLEAVE;
+    else if(name == "replicate")
+        return NPP_REPLICATE;
+
+    std::cerr << "Error: unknown NUMA placement policy: " << name << "\n";
+    std::cerr << "The policy must be one of none, interleave or replicate\n";
+    exit(EXIT_FAILURE);
+}
+
+//
+void NumaIndexPlacement::addBWT(const BWT* pBWT)
+{
+    m_copies.push_back(placeIndex(pBWT, m_policy, m_numNodes));
+}
+
+//
+void NumaIndexPlacement::addCache(const BWTIntervalCache* pCache)
+{
+    m_cacheCopies.push_back(placeIndex(pCache, m_policy, m_numNodes));
+}
+
+// Without replication every node uses the single copy
+const BWT* NumaIndexPlacement::getBWT(size_t i, int node) const
+{
+    const std::vector<const BWT*>& copies = m_copies[i];
+    return copies[node % copies.size()];
+}
+
+//
+const BWTIntervalCache* NumaIndexPlacement::getCache(size_t i, int node) const
+{
+    const std::vector<const BWTIntervalCache*>& copies = m_cacheCopies[i];
+    return copies[node % copies.size()];
+}
+
+//
+void NumaIndexPlacement::printMemoryUsage() const
+{
+    std::vector<size_t> nodeBytes;
+    for(size_t i = 0; i < m_copies.size(); ++i)
+    {
+        for(size_t n = 0; n < m_copies[i].size(); ++n)
+            m_copies[i][n]->addMemoryByNode(nodeBytes);
+    }
+
+    for(size_t i = 0; i < m_cacheCopies.size(); ++i)
+    {
+        for(size_t n = 0; n < m_cacheCopies[i].size(); ++n)
+            m_cacheCopies[i][n]->addMemoryByNode(nodeBytes);
+    }
+    NumaUtil::printMemoryByNode("[NumaIndexPlacement] FM-index memory", nodeBytes);
+}
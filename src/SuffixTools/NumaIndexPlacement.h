@@ -0,0 +1,75 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// NumaIndexPlacement - Place read-only FM-indices
+// on the nodes of a NUMA machine. By default the
+// pages of an index are on the node of the thread
+// that loaded it, so every query from another node
+// pays the remote access latency. The index can
+// instead be interleaved across the nodes, or
+// copied to every node so that worker threads
+// pinned to a node (see NumaUtil) query a local copy.
+//
+#ifndef NUMAINDEXPLACEMENT_H
+#define NUMAINDEXPLACEMENT_H
+
+#include <string>
+#include <vector>
+#include "BWT.h"
+#include "BWTIntervalCache.h"
+
+enum NumaPlacementPolicy
+{
+    NPP_NONE,
+    NPP_INTERLEAVE,
+    NPP_REPLICATE
+};
+
+class NumaIndexPlacement
+{
+    public:
+
+        NumaIndexPlacement(NumaPlacementPolicy policy);
+
+        // The copies made for the other nodes are deleted, the added indices and caches are not
+        ~NumaIndexPlacement();
+
+        // Parse one of "none", "interleave" or "replicate". Exits on an invalid name.
+        static NumaPlacementPolicy parsePolicy(const std::string& name);
+
+        // Place pBWT according to the policy. With NPP_REPLICATE, pBWT is
+        // moved to node 0 and a copy is made on each of the other nodes.
+        void addBWT(const BWT* pBWT);
+
+        // Return the copy of the i-th added index to be used by threads on node
+        const BWT* getBWT(size_t i, int node) const;
+
+        // Place an interval cache of an added index in the same way.
+        // The copies of an index share its intervals so one cache serves all of them.
+        void addCache(const BWTIntervalCache* pCache);
+        const BWTIntervalCache* getCache(size_t i, int node) const;
+
+        // Returns true if the threads using the indices should be pinned to their nodes
+        bool isPinningRequired() const { return m_policy != NPP_NONE; }
+
+        // Write the memory used by the indices on each node to stdout
+        void printMemoryUsage() const;
+
+    private:
+
+        // Not copyable
+        NumaIndexPlacement(const NumaIndexPlacement&);
+        NumaIndexPlacement& operator=(const NumaIndexPlacement&);
+
+        //
+        NumaPlacementPolicy m_policy;
+        int m_numNodes;
+
+        // m_copies[i][n] is the copy of index i for node n
+        std::vector<std::vector<const BWT*> > m_copies;
+        std::vector<std::vector<const BWTIntervalCache*> > m_cacheCopies;
+};
+
+#endif
@@ -9,78 +9,57 @@
 //
 #include "PopulationIndex.h"
 #include "Util.h"
-#include <algorithm>
 
 PopulationIndex::PopulationIndex(const std::string& filename)
 {
     std::istream* reader = createReader(filename);
     std::string line;
+    std::vector<size_t> starts;
+    size_t num_reads = 0;
+    m_nameOffsets.push_back(0);
     while(getline(*reader, line))
     {
         PopulationMember member = str2member(line);
-        m_population.push_back(member);
+
+        // Make sure the index is properly formatted
+        assert(member.start == num_reads);
+        assert(member.end >= member.start);
+
+        starts.push_back(member.start);
+        num_reads = member.end + 1;
+        m_namePool.append(member.name);
+        m_nameOffsets.push_back(m_namePool.size());
     }
     delete reader;
     reader = NULL;
+    assert(!starts.empty());
 
-    // Make sure the index is properly formatted
-    assert(m_population.size() != 0);
-    assert(m_population[0].start == 0);
-    for(size_t i = 1; i < m_population.size(); ++i)
-    {
-        assert(m_population[i].start > m_population[i-1].start);
-        assert(m_population[i].start == m_population[i-1].end + 1);
-    }
-    
-    /* Test the index
-    size_t start = 0;
-    size_t end = m_population.back().end + 2;
-    for(size_t i = start; i <= end; ++i)
-    {
-        std::string name = getName(i);
-        printf("%zu = %s\n", i, name.c_str());
-    }
-    */
+    m_sampleStarts.resize(num_reads);
+    for(size_t i = 0; i < starts.size(); ++i)
+        m_sampleStarts.set(starts[i]);
+    m_sampleStarts.initializeRank();
 }
 
 //
 std::string PopulationIndex::getName(size_t read_index) const
 {
-    std::vector<PopulationMember>::const_iterator iter = getIterByReadIndex(read_index);
-    return iter->name;
-}
-
-//
-size_t PopulationIndex::getSampleIndex(size_t read_index) const
-{
-    std::vector<PopulationMember>::const_iterator iter = getIterByReadIndex(read_index);
-    return iter - m_population.begin();
+    return getSampleName(getSampleIndex(read_index));
 }
 
 //
-std::vector<PopulationMember>::const_iterator PopulationIndex::getIterByReadIndex(size_t read_index) const
+std::string PopulationIndex::getSampleName(size_t sample_index) const
 {
-    assert(read_index <= m_population.back().end);
-    // Perform a binary search to identify the first element of the population
-    // that is strictly greater than the index. This returns an iterator that is 
-    // guarenteed to be one past the individual that index belongs to.
-    PopulationMember search = { read_index, read_index, "" };
-    std::vector<PopulationMember>::const_iterator iter = std::upper_bound(m_population.begin(), 
-                                                                          m_population.end(), 
-                                                                          search, 
-                                                                          PopulationMember::compareByStart);
-    assert(iter != m_population.begin());
-    iter--;
-    assert(read_index >= iter->start && read_index <= iter->end);
-    return iter;
+    assert(sample_index + 1 < m_nameOffsets.size());
+    size_t offset = m_nameOffsets[sample_index];
+    return m_namePool.substr(offset, m_nameOffsets[sample_index + 1] - offset);
 }
 
 //
 StringVector PopulationIndex::getSamples() const
 {
     StringVector out;
-    for(size_t i = 0; i < m_population.size(); ++i)
-        out.push_back(m_population[i].name);
+    for(size_t i = 0; i < getNumSamples(); ++i)
+        out.push_back(getSampleName(i));
     return out;
 }
 
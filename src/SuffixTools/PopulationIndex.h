@@ -5,13 +5,19 @@
 //-----------------------------------------------
 //
 // PopulationIndex - A structure mapping a read
-// index to a member of a population
+// index to a member of a population. The first
+// read of each member is marked in a bit vector
+// so a read index is resolved to its member with
+// a single rank query. Member names are kept in
+// a contiguous string pool.
 //
 #ifndef POPULATION_INDEX_H
 #define POPULATION_INDEX_H
 
 #include <vector>
 #include <string>
+#include <assert.h>
+#include "RankBitVector.h"
 
 typedef std::vector<std::string> StringVector;
 
@@ -20,13 +26,6 @@ struct PopulationMember
     size_t start;
     size_t end;
     std::string name;
-
-    //
-    static bool compareByStart(const PopulationMember& a,
-                               const PopulationMember& b)
-    {
-        return a.start < b.start;
-    }
 };
 
 class PopulationIndex
@@ -38,27 +37,37 @@ class PopulationIndex
         std::string getName(size_t read_index) const;
         
         // Return the index of the sample containing the given read index
-        size_t getSampleIndex(size_t read_index) const;
+        inline size_t getSampleIndex(size_t read_index) const
+        {
+            assert(read_index < m_sampleStarts.size());
+            return m_sampleStarts.rank(read_index) - 1;
+        }
+
+        // Return the name of the sample at the given sample index
+        std::string getSampleName(size_t sample_index) const;
         
         // Get the names of all samples in the collection
         StringVector getSamples() const;
         
         // Returns the number of samples in the population
-        size_t getNumSamples() const { return m_population.size(); }
+        size_t getNumSamples() const { return m_nameOffsets.size() - 1; }
 
         // Merge two population index files into a new one
         static void mergeIndexFiles(const std::string& file1, const std::string& file2, const std::string& outfile);
 
     private:
-        
-        // Returns an iterator pointing to the sample that the contains the given index
-        std::vector<PopulationMember>::const_iterator getIterByReadIndex(size_t index) const;
 
         // Parse a string from a .popidx file into a population member
         static PopulationMember str2member(const std::string& line);
         
         // Data
-        std::vector<PopulationMember> m_population;
+
+        // Bit i is set if read i is the first read of a sample
+        RankBitVector m_sampleStarts;
+
+        // The name of sample j is m_namePool[m_nameOffsets[j], m_nameOffsets[j+1])
+        std::string m_namePool;
+        std::vector<size_t> m_nameOffsets;
 };
 
 #endif
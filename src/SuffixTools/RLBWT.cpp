@@ -11,6 +11,7 @@
 #include "BWTReader.h"
 #include "BWTWriter.h"
 #include "BWTReader.h"
+#include "NumaUtil.h"
 #include <istream>
 #include <queue>
 #include <inttypes.h>
@@ -297,6 +298,44 @@ void RLBWT::printInfo() const
     printf("N: %zu Bytes per symbol: %lf\n\n", m_numSymbols, (double)total_size / m_numSymbols);
 }
 
+// The storage of an index array for the NUMA functions.
+// An empty vector has no storage to place.
+template<typename V>
+static const void* getVectorData(const V& v)
+{
+    return v.empty() ? NULL : &v[0];
+}
+
+template<typename V>
+static size_t getVectorBytes(const V& v)
+{
+    return v.empty() ? 0 : v.capacity() * sizeof(typename V::value_type);
+}
+
+//
+bool RLBWT::interleaveMemory() const
+{
+    return NumaUtil::interleaveMemory(getVectorData(m_rlString), getVectorBytes(m_rlString)) &&
+           NumaUtil::interleaveMemory(getVectorData(m_largeMarkers), getVectorBytes(m_largeMarkers)) &&
+           NumaUtil::interleaveMemory(getVectorData(m_smallMarkers), getVectorBytes(m_smallMarkers));
+}
+
+//
+bool RLBWT::bindMemory(int node) const
+{
+    return NumaUtil::bindMemory(getVectorData(m_rlString), getVectorBytes(m_rlString), node) &&
+           NumaUtil::bindMemory(getVectorData(m_largeMarkers), getVectorBytes(m_largeMarkers), node) &&
+           NumaUtil::bindMemory(getVectorData(m_smallMarkers), getVectorBytes(m_smallMarkers), node);
+}
+
+//
+void RLBWT::addMemoryByNode(std::vector<size_t>& nodeBytes) const
+{
+    NumaUtil::addMemoryByNode(getVectorData(m_rlString), getVectorBytes(m_rlString), nodeBytes);
+    NumaUtil::addMemoryByNode(getVectorData(m_largeMarkers), getVectorBytes(m_largeMarkers), nodeBytes);
+    NumaUtil::addMemoryByNode(getVectorData(m_smallMarkers), getVectorBytes(m_smallMarkers), nodeBytes);
+}
+
 // Print the run length distribution of the BWT
 void RLBWT::printRunLengths() const
 {
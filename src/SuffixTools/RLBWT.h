@@ -254,6 +254,14 @@ class RLBWT
         void print() const;
         void printRunLengths() const;
 
+        // Place the run-length string and markers on NUMA nodes, see NumaUtil.
+        // Returns false if the memory could not be placed.
+        bool interleaveMemory() const;
+        bool bindMemory(int node) const;
+
+        // Add the number of bytes of the string and markers resident on each node
+        void addMemoryByNode(std::vector<size_t>& nodeBytes) const;
+
         // IO
         friend class BWTReaderBinary;
         friend class BWTWriterBinary;
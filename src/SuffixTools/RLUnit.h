@@ -9,6 +9,8 @@
 #ifndef RLUNIT_H
 #define RLUNIT_H
 
+#include "HugePageAllocator.h"
+
 //
 #define RL_COUNT_MASK 0x1F  //00011111
 #define RL_SYMBOL_MASK 0xE0 //11100000
@@ -148,6 +150,6 @@ struct RLUnit
     friend class RLBWTReader;
     friend class RLBWTWriter;
 };
-typedef std::vector<RLUnit> RLVector;
+typedef std::vector<RLUnit, HugePageAllocator<RLUnit> > RLVector;
 
 #endif
@@ -15,10 +15,10 @@
 RankProcess::RankProcess(const BWT* pBWT, 
                          GapArray* pSharedGapArray, 
                          bool doReverse, 
-                         bool removeMode) : m_pBWT(pBWT), 
-                                            m_pSharedGapArray(pSharedGapArray),
-                                            m_doReverse(doReverse), 
-                                            m_removeMode(removeMode)
+                         RankMode mode) : m_pBWT(pBWT), 
+                                          m_pSharedGapArray(pSharedGapArray),
+                                          m_doReverse(doReverse), 
+                                          m_mode(mode)
 {
 
 }
@@ -49,13 +49,19 @@ RankResult RankProcess::process(const SequenceWorkItem& workItem)
     // for the last base of the sequence using just C(a). In remove
     // mode we use the index of the read (in the original read table) as
     // the rank so that ranks calculate correspond to the correct
-    // entries in the BWT for the read to remove.
+    // entries in the BWT for the read to remove. In append mode the
+    // read follows every string in the BWT so its '$' suffix is ranked
+    // after all of their '$' suffixes.
     int64_t rank = 0; // add mode
-    if(m_removeMode)
+    if(m_mode == RM_REMOVE)
     {
         // Parse the read index from the read id
         rank = parseRankFromID(workItem.read.id);
     }
+    else if(m_mode == RM_APPEND)
+    {
+        rank = m_pBWT->getNumStrings();
+    }
 
     out.numRanksProcessed += 1;
     if(!m_pSharedGapArray->attemptBaseIncrement(rank))
@@ -136,3 +142,53 @@ void RankPostProcess::process(const SequenceWorkItem& /*item*/, const RankResult
         m_pGapArray->incrementOverflowSerial(*iter);
     num_serial_updates += result.overflowVec.size();
 }
+
+//
+//
+//
+RankProcessPair::RankProcessPair(RankProcess* pForward, RankProcess* pReverse) : m_pForward(pForward), 
+                                                                                 m_pReverse(pReverse)
+{
+
+}
+
+//
+RankProcessPair::~RankProcessPair()
+{
+
+}
+
+//
+RankResultPair RankProcessPair::process(const SequenceWorkItem& item)
+{
+    RankResultPair out;
+    if(m_pForward != NULL)
+        out.forward = m_pForward->process(item);
+    if(m_pReverse != NULL)
+        out.reverse = m_pReverse->process(item);
+    return out;
+}
+
+//
+//
+//
+RankPostProcessPair::RankPostProcessPair(RankPostProcess* pForward, RankPostProcess* pReverse) : m_pForward(pForward), 
+                                                                                                 m_pReverse(pReverse)
+{
+
+}
+
+//
+RankPostProcessPair::~RankPostProcessPair()
+{
+
+}
+
+//
+void RankPostProcessPair::process(const SequenceWorkItem& item, const RankResultPair& result)
+{
+    if(m_pForward != NULL)
+        m_pForward->process(item, result.forward);
+    if(m_pReverse != NULL)
+        m_pReverse->process(item, result.reverse);
+}
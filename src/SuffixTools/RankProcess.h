@@ -16,6 +16,14 @@
 #include "GapArray.h"
 
 typedef std::vector<int64_t> RankVector;
+
+// How the starting rank of a sequence is chosen
+enum RankMode
+{
+    RM_ADD,    // the sequence is ordered before the strings in the BWT
+    RM_APPEND, // the sequence is ordered after the strings in the BWT
+    RM_REMOVE  // the sequence is in the BWT, its rank is parsed from its ID
+};
 struct RankResult
 {
     RankResult() : numRanksProcessed(0) {}
@@ -28,7 +36,7 @@ struct RankResult
 class RankProcess
 {
     public:
-        RankProcess(const BWT* pBWT, GapArray* pSharedGapArray, bool doReverse, bool removeMode);
+        RankProcess(const BWT* pBWT, GapArray* pSharedGapArray, bool doReverse, RankMode mode);
         ~RankProcess();
 
         RankResult process(const SequenceWorkItem& item);
@@ -41,7 +49,7 @@ class RankProcess
         GapArray* m_pSharedGapArray;
 
         bool m_doReverse;
-        bool m_removeMode;
+        RankMode m_mode;
 };
 
 // Update the gap array with 
@@ -62,4 +70,40 @@ class RankPostProcess
         size_t num_serial_updates;
 };
 
+// Compute the ranks of each sequence in a forward and a reverse BWT
+// so that both gap arrays are built from one pass over the reads.
+// Either process may be NULL.
+struct RankResultPair
+{
+    RankResult forward;
+    RankResult reverse;
+};
+
+class RankProcessPair
+{
+    public:
+        RankProcessPair(RankProcess* pForward, RankProcess* pReverse);
+        ~RankProcessPair();
+
+        RankResultPair process(const SequenceWorkItem& item);
+
+    private:
+        RankProcess* m_pForward;
+        RankProcess* m_pReverse;
+};
+
+//
+class RankPostProcessPair
+{
+    public:
+        RankPostProcessPair(RankPostProcess* pForward, RankPostProcess* pReverse);
+        ~RankPostProcessPair();
+
+        void process(const SequenceWorkItem& item, const RankResultPair& result);
+
+    private:
+        RankPostProcess* m_pForward;
+        RankPostProcess* m_pReverse;
+};
+
 #endif
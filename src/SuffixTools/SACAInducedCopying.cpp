@@ -11,6 +11,12 @@
 #include "mkqs.h"
 #include "bucketSort.h"
 #include "Util.h"
+#include "config.h"
+#include <vector>
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
 
 unsigned char mask[]={0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x01};
 
@@ -18,31 +24,62 @@ unsigned char mask[]={0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x01};
 #define isLMS(i, j) ((j) > 0 && getBit(type_array, (i), (j)) && !getBit(type_array, (i), (j-1)))
 #define GET_BKT(c) getBaseRank((c))
 
+// Number of suffix array entries processed per block of the parallel induction
+static const size_t INDUCE_BLOCK_SIZE = 1 << 20;
+
+// Markers for the bucket field of InducedElem
+static const int8_t INDUCE_NONE = -1; // nothing is induced from this entry
+static const int8_t INDUCE_RECHECK = -2; // the entry was empty or has changed, recompute during the update
+
+// The suffix induced from one entry of the suffix array and the bucket it is placed in
+struct InducedElem
+{
+    SAElem elem;
+    int8_t bucket;
+};
+
+// Split the strings of the read table into num_chunks contiguous ranges.
+// The range of chunk c is [chunk_starts[c], chunk_starts[c+1])
+static void getStringChunks(size_t num_strings, int num_chunks, std::vector<size_t>& chunk_starts)
+{
+    chunk_starts.resize(num_chunks + 1);
+    for(int c = 0; c <= num_chunks; ++c)
+        chunk_starts[c] = num_strings * c / num_chunks;
+}
+
 // Implementation of induced copying algorithm by
 // Nong, Zhang, Chan
 // Follows implementation given as an appendix to their 2008 paper
 // '\0' is the sentinenl in this algorithm
+// The linear passes over the strings and the suffix array are
+// parallelized over numThreads threads. The output does not depend
+// on the number of threads.
 void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads, bool silent)
 {
+    if(numThreads < 1)
+        numThreads = 1;
+
+#if HAVE_OPENMP
+    omp_set_num_threads(numThreads);
+#endif
 
     // In the multiple strings case, we need a 2D bit array
     // to hold the L/S types for the suffixes
-    size_t num_strings = pRT->getCount();
+    int64_t num_strings = pRT->getCount();
     char** type_array = new char*[num_strings];
     
-    for(size_t i = 0; i < num_strings; ++i)
+    // Classify each suffix as being L or S type.
+    // The strings are independent so they are classified in parallel.
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 4096)
+#endif
+    for(int64_t i = 0; i < num_strings; ++i)
     {
         size_t s_len = pRT->getReadLength(i) + 1;
         size_t num_bytes = (s_len / 8) + 1;
         type_array[i] = new char[num_bytes];
         assert(type_array[i] != 0);
         memset(type_array[i], 0, num_bytes);
-    }
-
-    // Classify each suffix as being L or S type
-    for(size_t i = 0; i < num_strings; ++i)
-    {
-        size_t s_len = pRT->getReadLength(i) + 1;
 
         // The empty suffix ($) for each string is defined to be S type
         // and hence the next suffix must be L type
@@ -64,7 +101,7 @@ void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads
     int64_t buckets[ALPHABET_SIZE];
 
     // find the ends of the buckets
-    countBuckets(pRT, bucket_counts, ALPHABET_SIZE);
+    countBuckets(pRT, bucket_counts, ALPHABET_SIZE, numThreads);
     getBuckets(bucket_counts, buckets, ALPHABET_SIZE, true); 
 
     std::cout << "initializing SA\n";
@@ -74,32 +111,47 @@ void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads
     pSA->initialize(num_suffixes, pRT->getCount());
 
     // Copy all the LMS substrings into the first n1 places in the SA
-    size_t n1 = 0;
-    for(size_t i = 0; i < num_strings; ++i)
+    // The strings are split into chunks. The LMS suffixes of each chunk
+    // are counted in parallel to find where each chunk writes to.
+    std::vector<size_t> chunk_starts;
+    getStringChunks(num_strings, numThreads, chunk_starts);
+    std::vector<size_t> chunk_offsets(numThreads + 1, 0);
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int c = 0; c < numThreads; ++c)
     {
-        size_t s_len = pRT->getReadLength(i) + 1;
-        for(size_t j = 0; j < s_len; ++j)
+        size_t count = 0;
+        for(size_t i = chunk_starts[c]; i < chunk_starts[c + 1]; ++i)
         {
-            if(isLMS(i,j))
-                pSA->set(n1++, SAElem(i, j));
+            size_t s_len = pRT->getReadLength(i) + 1;
+            for(size_t j = 0; j < s_len; ++j)
+                count += isLMS(i,j);
         }
+        chunk_offsets[c + 1] = count;
     }
 
-    /*
-    //induceSAl(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, false);
-    //induceSAs(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, true);
-    
-    // Compact all the sorted substrings into the first portion of the SA
-    size_t n1 = 0;
-    for(size_t i = 0; i < num_suffixes; ++i)
+    for(int c = 0; c < numThreads; ++c)
+        chunk_offsets[c + 1] += chunk_offsets[c];
+    size_t n1 = chunk_offsets[numThreads];
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int c = 0; c < numThreads; ++c)
     {
-        SAElem elem = pSA->get(i);
-        if(!elem.isEmpty() && isLMS(elem.getID(), elem.getPos()))
+        size_t idx = chunk_offsets[c];
+        for(size_t i = chunk_starts[c]; i < chunk_starts[c + 1]; ++i)
         {
-            pSA->set(n1++, elem);
+            size_t s_len = pRT->getReadLength(i) + 1;
+            for(size_t j = 0; j < s_len; ++j)
+            {
+                if(isLMS(i,j))
+                    pSA->set(idx++, SAElem(i, j));
+            }
         }
     }
-    */
 
     double ratio = (double)n1 / (double)num_suffixes;
     if(!silent)
@@ -113,13 +165,22 @@ void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads
     if(numThreads <= 1)
         mkqs2(&pSA->m_data[0], n1, 0, radix_compare, index_compare);
     else
-        parallel_mkqs(&pSA->m_data[0], n1, numThreads, radix_compare, index_compare);
+    {
+        // The suffix array slots after the LMS suffixes are unused until the
+        // induction step. Use them as the scratch space of the radix partition 
+        // when there is enough room.
+        SAElem* pScratch = num_suffixes - n1 >= n1 ? &pSA->m_data[n1] : NULL;
+        parallel_mkqs(&pSA->m_data[0], n1, numThreads, radix_compare, index_compare, pScratch);
+    }
     
     if(!silent)
         std::cout << "[saca] mkqs finished\n";
 
     // Induction sort the remaining suffixes
-    for(size_t i = n1; i < num_suffixes; ++i)
+#if HAVE_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int64_t i = n1; i < (int64_t)num_suffixes; ++i)
         pSA->set(i, SAElem());
     
     // Find the ends of the buckets
@@ -133,52 +194,118 @@ void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads
         pSA->set(--buckets[GET_BKT(c)], elem_i);
     }
 
-    induceSAl(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, false);
-    induceSAs(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, true);
+    induceSAl(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, false, numThreads);
+    induceSAs(pRT, pSA, type_array, bucket_counts, buckets, num_suffixes, ALPHABET_SIZE, true, numThreads);
 
     // deallocate t array
-    for(size_t i = 0; i < num_strings; ++i)
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 4096)
+#endif
+    for(int64_t i = 0; i < num_strings; ++i)
     {
         delete [] type_array[i];
     }
     delete [] type_array;
 }
 
-void induceSAl(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end)
+// Compute the suffix induced from elem_i. If the preceding suffix has type s_type
+// it is returned in out with its bucket, otherwise the bucket is set to INDUCE_NONE
+static inline void induceElem(const ReadTable* pRT, char** p_array, const SAElem& elem_i, bool s_type, InducedElem& out)
 {
-    getBuckets(counts, buckets, K, end);
-    for(size_t i = 0; i < n; ++i)
+    out.bucket = INDUCE_NONE;
+    if(!elem_i.isEmpty() && elem_i.getPos() > 0)
+    {
+        SAElem elem_j(elem_i.getID(), elem_i.getPos() - 1);
+        if(getBit(p_array, elem_j.getID(), elem_j.getPos()) == s_type)
+        {
+            char c = GET_CHAR(elem_j.getID(),elem_j.getPos());
+            out.elem = elem_j;
+            out.bucket = GET_BKT(c);
+        }
+    }
+}
+
+// Compute the induced suffixes for the entries [lo, hi) of the suffix array in parallel.
+// Empty entries may be filled while the block is updated so they are marked to be rechecked.
+static void prepareInduceBlock(const ReadTable* pRT, const SuffixArray* pSA, char** p_array, 
+                               int64_t lo, int64_t hi, bool s_type, InducedElem* pBlock)
+{
+#if HAVE_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int64_t i = lo; i < hi; ++i)
     {
         const SAElem& elem_i = pSA->get(i);
-        if(!elem_i.isEmpty() && elem_i.getPos() > 0)
+        if(elem_i.isEmpty())
+            pBlock[i - lo].bucket = INDUCE_RECHECK;
+        else
+            induceElem(pRT, p_array, elem_i, s_type, pBlock[i - lo]);
+    }
+}
+
+// The induction passes scan the suffix array in blocks. The (random access) lookups
+// of the preceding suffix's type and character are done for the whole block in parallel, 
+// then the block is scanned sequentially to place the induced suffixes in their buckets.
+// A suffix placed into an entry of the current block that has not been scanned yet 
+// invalidates the prepared value of that entry, which is then recomputed during the scan.
+// This gives exactly the same result as the sequential algorithm.
+void induceSAl(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end, int numThreads)
+{
+#if HAVE_OPENMP
+    omp_set_num_threads(numThreads);
+#else
+    (void)numThreads;
+#endif
+    getBuckets(counts, buckets, K, end);
+    std::vector<InducedElem> block(std::min(n, INDUCE_BLOCK_SIZE));
+    for(size_t lo = 0; lo < n; lo += INDUCE_BLOCK_SIZE)
+    {
+        size_t hi = std::min(n, lo + INDUCE_BLOCK_SIZE);
+        prepareInduceBlock(pRT, pSA, p_array, lo, hi, false, &block[0]);
+
+        for(size_t i = lo; i < hi; ++i)
         {
-            //std::cout << "Curr: " << elem_i << "\n";
-            SAElem elem_j(elem_i.getID(), elem_i.getPos() - 1);
-            if(!getBit(p_array, elem_j.getID(), elem_j.getPos()))
+            InducedElem& ie = block[i - lo];
+            if(ie.bucket == INDUCE_RECHECK)
+                induceElem(pRT, p_array, pSA->get(i), false, ie);
+
+            if(ie.bucket != INDUCE_NONE)
             {
-                char c = GET_CHAR(elem_j.getID(),elem_j.getPos());
-                //std::cout << "<iSA1>Placing " << elem_j << " at position " << buckets[GET_BKT(c)] << "\n";
-                pSA->set(buckets[GET_BKT(c)]++, elem_j);
+                size_t p = buckets[ie.bucket]++;
+                pSA->set(p, ie.elem);
+                if(p > i && p < hi)
+                    block[p - lo].bucket = INDUCE_RECHECK;
             }
         }
     }
 }
 
-void induceSAs(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end)
+void induceSAs(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end, int numThreads)
 {
+#if HAVE_OPENMP
+    omp_set_num_threads(numThreads);
+#else
+    (void)numThreads;
+#endif
     getBuckets(counts, buckets, K, end);
-    for(int64_t i = n - 1; i >= 0; --i)
+    std::vector<InducedElem> block(std::min(n, INDUCE_BLOCK_SIZE));
+    for(int64_t hi = n; hi > 0; hi -= INDUCE_BLOCK_SIZE)
     {
-        const SAElem& elem_i = pSA->get(i);
-        if(!elem_i.isEmpty() && elem_i.getPos() > 0)
+        int64_t lo = std::max((int64_t)0, hi - (int64_t)INDUCE_BLOCK_SIZE);
+        prepareInduceBlock(pRT, pSA, p_array, lo, hi, true, &block[0]);
+
+        for(int64_t i = hi - 1; i >= lo; --i)
         {
-            //std::cout << "<isas>Curr: " << elem_i << "\n";
-            SAElem elem_j(elem_i.getID(), elem_i.getPos() - 1);
-            if(getBit(p_array, elem_j.getID(), elem_j.getPos()))
+            InducedElem& ie = block[i - lo];
+            if(ie.bucket == INDUCE_RECHECK)
+                induceElem(pRT, p_array, pSA->get(i), true, ie);
+
+            if(ie.bucket != INDUCE_NONE)
             {
-                char c = GET_CHAR(elem_j.getID(),elem_j.getPos());
-                //std::cout << "<iSAs>Placing " << elem_j << " at position " << buckets[GET_BKT(c)] - 1 << "\n";
-                pSA->set(--buckets[GET_BKT(c)], elem_j);
+                int64_t p = --buckets[ie.bucket];
+                pSA->set(p, ie.elem);
+                if(p < i && p >= lo)
+                    block[p - lo].bucket = INDUCE_RECHECK;
             }
         }
     }
@@ -186,19 +313,39 @@ void induceSAs(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t*
 
 
 // Calculate the number of items that should be in each bucket
-void countBuckets(const ReadTable* pRT, int64_t* counts, int K)
+// Each thread counts a chunk of the strings and the counts are summed
+void countBuckets(const ReadTable* pRT, int64_t* counts, int K, int numThreads)
 {
     for(int i = 0; i < K; ++i)
         counts[i] = 0;
 
-    for(size_t i = 0; i < pRT->getCount(); ++i)
+    if(numThreads < 1)
+        numThreads = 1;
+
+    std::vector<size_t> chunk_starts;
+    getStringChunks(pRT->getCount(), numThreads, chunk_starts);
+    std::vector<int64_t> chunk_counts(numThreads * K, 0);
+
+#if HAVE_OPENMP
+    omp_set_num_threads(numThreads);
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int c = 0; c < numThreads; ++c)
     {
-        size_t s_len = pRT->getReadLength(i);
-        for(size_t j = 0; j < s_len; ++j)
-            counts[getBaseRank(GET_CHAR(i,j))]++;
+        int64_t* local_counts = &chunk_counts[c * K];
+        for(size_t i = chunk_starts[c]; i < chunk_starts[c + 1]; ++i)
+        {
+            size_t s_len = pRT->getReadLength(i);
+            for(size_t j = 0; j < s_len; ++j)
+                local_counts[getBaseRank(GET_CHAR(i,j))]++;
 
-        counts[getBaseRank('\0')]++;
+            local_counts[getBaseRank('\0')]++;
+        }
     }
+
+    for(int c = 0; c < numThreads; ++c)
+        for(int i = 0; i < K; ++i)
+            counts[i] += chunk_counts[c * K + i];
 }
 
 // If end is true, calculate the end of the buckets, otherwise 
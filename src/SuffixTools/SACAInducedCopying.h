@@ -14,10 +14,10 @@
 
 void saca_induced_copying(SuffixArray* pSA, const ReadTable* pRT, int numThreads, bool silent = false);
 
-void induceSAl(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end);
-void induceSAs(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end);
+void induceSAl(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end, int numThreads = 1);
+void induceSAs(const ReadTable* pRT, SuffixArray* pSA, char** p_array, int64_t* counts, int64_t* buckets, size_t n, int K, bool end, int numThreads = 1);
 
-void countBuckets(const ReadTable* pRT, int64_t* buckets, int K);
+void countBuckets(const ReadTable* pRT, int64_t* buckets, int K, int numThreads = 1);
 void getBuckets(int64_t* counts, int64_t* buckets, int K, bool end);
 inline void setBit(char** p_array, size_t str_idx, size_t bit_idx, bool b);
 inline bool getBit(char** p_array, size_t str_idx, size_t bit_idx);
@@ -13,6 +13,7 @@
 #include "SAReader.h"
 #include "SAWriter.h"
 #include "config.h"
+#include <algorithm>
 
 #if HAVE_OPENMP
 #include <omp.h>
@@ -80,6 +81,89 @@ SAElem SampledSuffixArray::calcSA(int64_t idx, const BWT* pBWT) const
     return elem;
 }
 
+// Number of indices that are backtracked together by the batched calcSA
+static const size_t CALCSA_GROUP_SIZE = 16;
+
+//
+void SampledSuffixArray::calcSA(const int64_t* pIndices, size_t n, const BWT* pBWT, SAElem* pOut, int numThreads) const
+{
+    int64_t num_groups = (n + CALCSA_GROUP_SIZE - 1) / CALCSA_GROUP_SIZE;
+
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads) if(numThreads > 1)
+#else
+    (void)numThreads;
+#endif
+    for(int64_t g = 0; g < num_groups; ++g)
+    {
+        size_t start = g * CALCSA_GROUP_SIZE;
+        size_t group_size = std::min(CALCSA_GROUP_SIZE, n - start);
+
+        // The current position and the number of backtracking steps
+        // of the unresolved indices in the group
+        int64_t idx[CALCSA_GROUP_SIZE];
+        size_t offset[CALCSA_GROUP_SIZE];
+        size_t slot[CALCSA_GROUP_SIZE];
+        for(size_t i = 0; i < group_size; ++i)
+        {
+            idx[i] = pIndices[start + i];
+            offset[i] = 0;
+            slot[i] = start + i;
+        }
+
+        size_t num_active = group_size;
+        while(num_active > 0)
+        {
+            // Perform one step for every unresolved index. Resolved indices
+            // are swapped with the last active one.
+            size_t i = 0;
+            while(i < num_active)
+            {
+                SAElem elem;
+                bool resolved = false;
+                if(m_sampleRate > 0 && idx[i] % m_sampleRate == 0 && !m_saSamples[idx[i] / m_sampleRate].isEmpty())
+                {
+                    // A valid sample is stored for this idx
+                    elem = m_saSamples[idx[i] / m_sampleRate];
+                    resolved = true;
+                }
+                else
+                {
+                    char b = pBWT->getChar(idx[i]);
+                    idx[i] = pBWT->getPC(b) + pBWT->getOcc(b, idx[i] - 1);
+                    if(b == '$')
+                    {
+                        // idx (before the update) corresponds to the start of a read.
+                        assert(idx[i] < (int64_t)m_saLexoIndex.size());
+                        elem.setID(m_saLexoIndex[idx[i]]);
+                        elem.setPos(0);
+                        resolved = true;
+                    }
+                    else
+                    {
+                        offset[i] += 1;
+                    }
+                }
+
+                if(resolved)
+                {
+                    elem.setPos(elem.getPos() + offset[i]);
+                    pOut[slot[i]] = elem;
+
+                    num_active -= 1;
+                    idx[i] = idx[num_active];
+                    offset[i] = offset[num_active];
+                    slot[i] = slot[num_active];
+                }
+                else
+                {
+                    i += 1;
+                }
+            }
+        }
+    }
+}
+
 // Returns the ID of the read with lexicographic rank r
 size_t SampledSuffixArray::lookupLexoRank(size_t r) const
 {
@@ -15,6 +15,7 @@
 #include "SuffixArray.h"
 #include "BWT.h"
 #include "ReadInfoTable.h"
+#include "HugePageAllocator.h"
 
 typedef uint32_t SSA_INT_TYPE;
 
@@ -34,6 +35,11 @@ class SampledSuffixArray
         // Calculate the suffix array element for the given index
         SAElem calcSA(int64_t idx, const BWT* pBWT) const;
 
+        // Calculate the suffix array elements for a batch of indices, writing them to pOut.
+        // The backtracking steps of a group of indices are interleaved so their
+        // memory accesses overlap. The batch is split over numThreads threads.
+        void calcSA(const int64_t* pIndices, size_t n, const BWT* pBWT, SAElem* pOut, int numThreads = 1) const;
+
         // Returns the ID of the read with lexicographic rank r
         size_t lookupLexoRank(size_t r) const;
 
@@ -68,7 +74,7 @@ class SampledSuffixArray
 
         static const int DEFAULT_SA_SAMPLE_RATE = 64;
         int m_sampleRate;
-        SAElemVector m_saSamples;
+        std::vector<SAElem, HugePageAllocator<SAElem> > m_saSamples;
 };
 
 #endif
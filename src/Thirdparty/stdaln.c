@@ -525,8 +525,10 @@ int aln_global_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2
 /*************************************************
  * local alignment combined with banded strategy *
  *************************************************/
-int aln_local_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
-				   path_t *path, int *path_len, int _thres, int *_subo)
+/* If _end_i > 0 the forward pass is skipped and the best cell is taken to be
+ * (_end_i, _end_j) with score _score. _subo must be 0 in this case. */
+static int aln_local_core_aux(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
+							  path_t *path, int *path_len, int _thres, int *_subo, int _score, int _end_i, int _end_j)
 {
 	register NT_LOCAL_SCORE *s;
 	register int i;
@@ -574,6 +576,11 @@ int aln_local_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2,
 	--seq1; --seq2;
 	for (i = 0; i != N_MATRIX_ROW; ++i) --s_array[i];
 
+	if (_end_i > 0) { /* the forward pass was done by the caller */
+		score_f = _score; end_i = _end_i; end_j = _end_j;
+		goto end_forward;
+	}
+
 	/* forward dynamic programming */
 	for (i = 0, s = eh; i != tmp_len; ++i, ++s) *s = 0;
 	score_f = 0;
@@ -629,6 +636,7 @@ int aln_local_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2,
 	}
 	score_f += of_base;
 
+end_forward:
 	if (score_f < thres) { /* no matching residue at all, 090218 */
 		*path_len = 0;
 		goto end_func;
@@ -758,6 +766,16 @@ end_func:
 	free(s_array);
 	return score_f;
 }
+int aln_local_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
+				   path_t *path, int *path_len, int _thres, int *_subo)
+{
+	return aln_local_core_aux(seq1, len1, seq2, len2, ap, path, path_len, _thres, _subo, 0, 0, 0);
+}
+int aln_local_core_from_end(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
+							path_t *path, int *path_len, int _thres, int score, int end_i, int end_j)
+{
+	return aln_local_core_aux(seq1, len1, seq2, len2, ap, path, path_len, _thres, 0, score, end_i, end_j);
+}
 AlnAln *aln_stdaln_aux(const char *seq1, const char *seq2, const AlnParam *ap,
 					   int type, int thres, int len1, int len2)
 {
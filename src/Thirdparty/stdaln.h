@@ -128,6 +128,10 @@ extern "C" {
 						path_t *path, int *path_len);
 	int aln_local_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
 					   path_t *path, int *path_len, int _thres, int *_subo);
+	/* Same as aln_local_core but the forward pass has been computed elsewhere. (end_i, end_j) is
+	 * the 1-based first cell, in query-major order, that reaches the best local score. */
+	int aln_local_core_from_end(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
+								path_t *path, int *path_len, int _thres, int score, int end_i, int end_j);
 	int aln_extend_core(unsigned char *seq1, int len1, unsigned char *seq2, int len2, const AlnParam *ap,
 						path_t *path, int *path_len, int G0, uint8_t *_mem);
 	uint16_t *aln_path2cigar(const path_t *path, int path_len, int *n_cigar);
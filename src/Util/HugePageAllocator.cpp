@@ -0,0 +1,233 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// HugePageAllocator - STL allocator for the large
+// arrays of the FM-index.
+// See HugePageAllocator.h
+//
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "HugePageAllocator.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// The allocations are mapped in multiples of this size
+static const size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t GIANT_PAGE_SIZE = 1024 * 1024 * 1024;
+
+// Flags selecting the hugetlbfs page size, from linux/mman.h
+static const int HUGE_PAGE_SHIFT = 26;
+static const int HUGE_2MB_FLAG = 21 << HUGE_PAGE_SHIFT;
+static const int HUGE_1GB_FLAG = 30 << HUGE_PAGE_SHIFT;
+
+// The type of memory backing a mapped region
+enum HugePageType
+{
+    HPT_GIANT, // explicit 1 GB pages
+    HPT_LARGE, // explicit 2 MB pages
+    HPT_TRANSPARENT, // advised for transparent huge pages
+    HPT_NORMAL, // madvise failed
+    HPT_NUM_TYPES
+};
+
+struct MappedRegion
+{
+    size_t length;
+    HugePageType type;
+};
+typedef std::map<uintptr_t, MappedRegion> RegionMap;
+
+static HugePageMode s_mode = HPM_NONE;
+static RegionMap s_regions;
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t roundUp(size_t n, size_t multiple)
+{
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+#if defined(__linux__)
+// Map length bytes aligned to a 2 MB boundary. Returns NULL on failure.
+static void* mapAligned(size_t length)
+{
+    size_t padded = length + LARGE_PAGE_SIZE;
+    void* p = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED)
+        return NULL;
+
+    // Trim the unaligned head and the tail
+    uintptr_t start = (uintptr_t)p;
+    uintptr_t aligned = roundUp(start, LARGE_PAGE_SIZE);
+    if(aligned > start)
+        munmap(p, aligned - start);
+    uintptr_t end = aligned + length;
+    if(start + padded > end)
+        munmap((void*)end, start + padded - end);
+    return (void*)aligned;
+}
+
+// Try to map explicit huge pages of pageSize bytes
+static void* mapHugeTLB(size_t bytes, size_t pageSize, int sizeFlag, size_t& length)
+{
+    length = roundUp(bytes, pageSize);
+    void* p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeFlag, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+#endif
+
+namespace HugePages
+{
+
+//
+void setMode(HugePageMode mode)
+{
+    s_mode = mode;
+}
+
+//
+HugePageMode parseMode(const std::string& name)
+{
+    if(name == "none")
+        return HPM_NONE;
+    else if(name == "thp")
+        return HPM_TRANSPARENT;
+    else if(name == "hugetlb")
+        return HPM_HUGETLB;
+
+    std::cerr << "Error: unknown huge page mode: " << name << "\n";
+    std::cerr << "The mode must be one of none, thp or hugetlb\n";
+    exit(EXIT_FAILURE);
+}
+
+//
+void* allocate(size_t bytes)
+{
+#if defined(__linux__)
+    if(s_mode == HPM_NONE || bytes < LARGE_PAGE_SIZE)
+        return ::operator new(bytes);
+
+    void* p = NULL;
+    MappedRegion region;
+
+    if(s_mode == HPM_HUGETLB)
+    {
+        if(bytes >= GIANT_PAGE_SIZE)
+        {
+            p = mapHugeTLB(bytes, GIANT_PAGE_SIZE, HUGE_1GB_FLAG, region.length);
+            region.type = HPT_GIANT;
+        }
+
+        if(p == NULL)
+        {
+            p = mapHugeTLB(bytes, LARGE_PAGE_SIZE, HUGE_2MB_FLAG, region.length);
+            region.type = HPT_LARGE;
+        }
+    }
+
+    if(p == NULL)
+    {
+        region.length = roundUp(bytes, LARGE_PAGE_SIZE);
+        p = mapAligned(region.length);
+        if(p == NULL)
+            throw std::bad_alloc();
+        region.type = madvise(p, region.length, MADV_HUGEPAGE) == 0 ? HPT_TRANSPARENT : HPT_NORMAL;
+    }
+
+    pthread_mutex_lock(&s_mutex);
+    s_regions[(uintptr_t)p] = region;
+    pthread_mutex_unlock(&s_mutex);
+    return p;
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+// Memory that was not mapped by allocate came from operator new
+void deallocate(void* p, size_t bytes)
+{
+#if defined(__linux__)
+    if(bytes >= LARGE_PAGE_SIZE)
+    {
+        pthread_mutex_lock(&s_mutex);
+        RegionMap::iterator iter = s_regions.find((uintptr_t)p);
+        bool mapped = iter != s_regions.end();
+        size_t length = mapped ? iter->second.length : 0;
+        if(mapped)
+            s_regions.erase(iter);
+        pthread_mutex_unlock(&s_mutex);
+
+        if(mapped)
+        {
+            munmap(p, length);
+            return;
+        }
+    }
+#else
+    (void)bytes;
+#endif
+    ::operator delete(p);
+}
+
+//
+void printReport()
+{
+    size_t typeBytes[HPT_NUM_TYPES] = { 0, 0, 0, 0 };
+
+    pthread_mutex_lock(&s_mutex);
+    for(RegionMap::const_iterator iter = s_regions.begin(); iter != s_regions.end(); ++iter)
+        typeBytes[iter->second.type] += iter->second.length;
+
+    // Sum the huge pages of the mappings that overlap a transparent region.
+    // Neighbouring regions may have been merged into one mapping.
+    size_t backedBytes = 0;
+    std::ifstream reader("/proc/self/smaps");
+    std::string line;
+    bool inRegion = false;
+    while(getline(reader, line))
+    {
+        unsigned long start;
+        unsigned long end;
+        char dash;
+        std::stringstream parser(line);
+        if(line.compare(0, 14, "AnonHugePages:") == 0)
+        {
+            size_t kb = 0;
+            std::string label;
+            parser >> label >> kb;
+            if(inRegion)
+                backedBytes += kb * 1024;
+        }
+        else if(parser >> std::hex >> start >> dash >> end && dash == '-')
+        {
+            // A new mapping starts. Find the first region ending after its start.
+            inRegion = false;
+            RegionMap::const_iterator iter = s_regions.upper_bound(start);
+            if(iter != s_regions.begin())
+                --iter;
+            for(; iter != s_regions.end() && iter->first < end; ++iter)
+            {
+                if(iter->first + iter->second.length > start && iter->second.type == HPT_TRANSPARENT)
+                    inRegion = true;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    double mb = 1024 * 1024;
+    printf("[huge pages] index memory: %.1lf MB in 1 GB pages, %.1lf MB in 2 MB pages, "
+           "%.1lf MB advised for transparent huge pages (%.1lf MB backed), %.1lf MB in normal pages\n",
+           typeBytes[HPT_GIANT] / mb, typeBytes[HPT_LARGE] / mb, typeBytes[HPT_TRANSPARENT] / mb,
+           backedBytes / mb, typeBytes[HPT_NORMAL] / mb);
+}
+
+};
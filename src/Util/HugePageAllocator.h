@@ -0,0 +1,99 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// HugePageAllocator - STL allocator for the large
+// arrays of the FM-index. Random rank queries over
+// a large index miss the TLB on almost every access
+// when the arrays are backed by 4 KB pages. When
+// enabled, allocations of at least 2 MB are mapped
+// directly and either advised for transparent huge
+// pages or backed by explicit hugetlbfs pages, falling
+// back to the next option when a request fails.
+// Smaller allocations, and all allocations when huge
+// pages are not enabled, use operator new.
+//
+#ifndef HUGEPAGEALLOCATOR_H
+#define HUGEPAGEALLOCATOR_H
+
+#include <stddef.h>
+#include <new>
+#include <string>
+
+enum HugePageMode
+{
+    HPM_NONE, // use operator new
+    HPM_TRANSPARENT, // madvise the allocations for transparent huge pages
+    HPM_HUGETLB // use explicit 1 GB or 2 MB pages, falling back to transparent huge pages
+};
+
+namespace HugePages
+{
+
+// Set the mode used by subsequent allocations
+void setMode(HugePageMode mode);
+
+// Parse one of "none", "thp" or "hugetlb". Exits on an invalid name.
+HugePageMode parseMode(const std::string& name);
+
+//
+void* allocate(size_t bytes);
+void deallocate(void* p, size_t bytes);
+
+// Write the amount of live memory held in each type of page to stdout.
+// For transparent huge pages the amount actually backed by huge
+// pages is read from /proc/self/smaps.
+void printReport();
+
+};
+
+template<class T>
+class HugePageAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U>
+        struct rebind
+        {
+            typedef HugePageAllocator<U> other;
+        };
+
+        HugePageAllocator() {}
+        HugePageAllocator(const HugePageAllocator&) {}
+        template<class U> HugePageAllocator(const HugePageAllocator<U>&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* = 0)
+        {
+            return static_cast<pointer>(HugePages::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            HugePages::deallocate(p, n * sizeof(T));
+        }
+
+        size_type max_size() const { return (size_t)-1 / sizeof(T); }
+
+        void construct(pointer p, const T& val) { new(p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+};
+
+// The allocators are stateless so memory from one can be freed by any other
+template<class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return true; }
+
+template<class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return false; }
+
+#endif
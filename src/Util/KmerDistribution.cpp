@@ -23,6 +23,12 @@ void KmerDistribution::add(int kcount)
     m_data[kcount]++;
 }
 
+void KmerDistribution::merge(const KmerDistribution& other)
+{
+    for(std::map<int,int>::const_iterator iter = other.m_data.begin(); iter != other.m_data.end(); ++iter)
+        m_data[iter->first] += iter->second;
+}
+
 double KmerDistribution::getCumulativeProportionLEQ(int n) const
 {
     std::vector<int> countVector = toCountVector(1000);
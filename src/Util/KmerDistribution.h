@@ -44,6 +44,9 @@ class KmerDistribution
         //
         int findFirstLocalMinimum() const;
         void add(int count);
+
+        // Add the counts of another distribution to this one
+        void merge(const KmerDistribution& other);
         void print(int max) const; 
         void print(FILE* file, int max) const; 
 
@@ -0,0 +1,236 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// NumaUtil - Functions for placing memory and
+// threads on the nodes of a NUMA machine.
+// See NumaUtil.h
+//
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "NumaUtil.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+// Memory policy constants from linux/mempolicy.h
+static const int MPOL_BIND_MODE = 2;
+static const int MPOL_INTERLEAVE_MODE = 3;
+static const unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+
+// At most this many pages of a range are queried by addMemoryByNode
+static const size_t MAX_SAMPLED_PAGES = 1 << 16;
+
+static bool s_pinWorkers = false;
+
+// The number of nodes, read from sysfs on the first call to getNumNodes.
+// This is made on the main thread, see setWorkerPinning.
+static int s_numNodes = 0;
+
+// Parse a sysfs list like "0-3,8-11"
+static std::vector<int> parseList(const std::string& filename)
+{
+    std::vector<int> out;
+    std::ifstream reader(filename.c_str());
+    std::string list;
+    if(!reader || !getline(reader, list))
+        return out;
+
+    std::stringstream parser(list);
+    std::string range;
+    while(getline(parser, range, ','))
+    {
+        int first = 0;
+        int last = 0;
+        char dash;
+        std::stringstream rangeParser(range);
+        rangeParser >> first;
+        if(!(rangeParser >> dash >> last))
+            last = first;
+        for(int i = first; i <= last; ++i)
+            out.push_back(i);
+    }
+    return out;
+}
+
+// Expand [pData, pData + bytes) to whole pages
+static void getPageRange(const void* pData, size_t bytes, uintptr_t& start, size_t& length)
+{
+    uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    start = (uintptr_t)pData & ~(pageSize - 1);
+    uintptr_t end = ((uintptr_t)pData + bytes + pageSize - 1) & ~(pageSize - 1);
+    length = end - start;
+}
+
+#if defined(__linux__)
+// Set the memory policy of a range with the mbind system call
+static bool setMemoryPolicy(const void* pData, size_t bytes, int mode, const std::vector<int>& nodes)
+{
+    if(bytes == 0)
+        return true;
+
+    std::vector<unsigned long> mask(1, 0);
+    size_t bitsPerWord = 8 * sizeof(unsigned long);
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        size_t word = nodes[i] / bitsPerWord;
+        if(word >= mask.size())
+            mask.resize(word + 1, 0);
+        mask[word] |= 1UL << (nodes[i] % bitsPerWord);
+    }
+
+    uintptr_t start;
+    size_t length;
+    getPageRange(pData, bytes, start, length);
+    long ret = syscall(SYS_mbind, start, length, mode, &mask[0], mask.size() * bitsPerWord + 1, MPOL_MF_MOVE_FLAG);
+    return ret == 0;
+}
+#endif
+
+namespace NumaUtil
+{
+
+//
+int getNumNodes()
+{
+    if(s_numNodes == 0)
+    {
+        std::vector<int> nodes = parseList("/sys/devices/system/node/online");
+        s_numNodes = nodes.empty() ? 1 : nodes.back() + 1;
+    }
+    return s_numNodes;
+}
+
+//
+bool pinThreadToNode(int node)
+{
+#if defined(__linux__)
+    std::stringstream ss;
+    ss << "/sys/devices/system/node/node" << node << "/cpulist";
+    std::vector<int> cpus = parseList(ss.str());
+    if(cpus.empty())
+        return false;
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for(size_t i = 0; i < cpus.size(); ++i)
+        CPU_SET(cpus[i], &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+//
+int getWorkerNode(int workerID)
+{
+    return workerID % getNumNodes();
+}
+
+//
+void setWorkerPinning(bool enabled)
+{
+    // Read the node count now so the workers only read the cached value
+    getNumNodes();
+    s_pinWorkers = enabled;
+}
+
+//
+void pinWorkerThread(int workerID)
+{
+    if(!s_pinWorkers || workerID < 0)
+        return;
+
+    int node = getWorkerNode(workerID);
+    if(!pinThreadToNode(node))
+        std::cerr << "Warning: could not pin worker " << workerID << " to NUMA node " << node << "\n";
+}
+
+//
+bool interleaveMemory(const void* pData, size_t bytes)
+{
+#if defined(__linux__)
+    std::vector<int> nodes;
+    for(int i = 0; i < getNumNodes(); ++i)
+        nodes.push_back(i);
+    return setMemoryPolicy(pData, bytes, MPOL_INTERLEAVE_MODE, nodes);
+#else
+    (void)pData;
+    (void)bytes;
+    return false;
+#endif
+}
+
+//
+bool bindMemory(const void* pData, size_t bytes, int node)
+{
+#if defined(__linux__)
+    return setMemoryPolicy(pData, bytes, MPOL_BIND_MODE, std::vector<int>(1, node));
+#else
+    (void)pData;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+}
+
+// The node of each sampled page is found with the move_pages
+// system call, which only reports the location when no target
+// nodes are given
+void addMemoryByNode(const void* pData, size_t bytes, std::vector<size_t>& nodeBytes)
+{
+    size_t numNodes = getNumNodes();
+    if(nodeBytes.size() < numNodes)
+        nodeBytes.resize(numNodes, 0);
+    if(bytes == 0)
+        return;
+
+#if defined(__linux__)
+    uintptr_t start;
+    size_t length;
+    getPageRange(pData, bytes, start, length);
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t numPages = length / pageSize;
+    size_t stride = (numPages + MAX_SAMPLED_PAGES - 1) / MAX_SAMPLED_PAGES;
+
+    std::vector<void*> pages;
+    for(size_t i = 0; i < numPages; i += stride)
+        pages.push_back((void*)(start + i * pageSize));
+    std::vector<int> status(pages.size(), -1);
+
+    long ret = syscall(SYS_move_pages, 0, pages.size(), &pages[0], NULL, &status[0], 0);
+    if(ret == 0)
+    {
+        // Each sampled page stands for stride pages of the range
+        size_t sampleBytes = stride * pageSize;
+        for(size_t i = 0; i < status.size(); ++i)
+        {
+            if(status[i] >= 0 && (size_t)status[i] < nodeBytes.size())
+                nodeBytes[status[i]] += std::min(sampleBytes, length - i * sampleBytes);
+        }
+        return;
+    }
+#endif
+
+    // The location is unknown, attribute the range to the first node
+    nodeBytes[0] += bytes;
+}
+
+//
+void printMemoryByNode(const std::string& label, const std::vector<size_t>& nodeBytes)
+{
+    for(size_t i = 0; i < nodeBytes.size(); ++i)
+        printf("%s: node %zu uses %.2lf MB\n", label.c_str(), i, (double)nodeBytes[i] / (1024 * 1024));
+}
+
+};
@@ -0,0 +1,59 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// NumaUtil - Functions for placing memory and
+// threads on the nodes of a NUMA machine. The
+// topology is read from sysfs and the memory
+// policies are set with the kernel system calls
+// directly so libnuma is not required. On other
+// platforms, or if the calls fail, the machine
+// is treated as a single node.
+//
+#ifndef NUMAUTIL_H
+#define NUMAUTIL_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace NumaUtil
+{
+
+// Return the number of NUMA nodes that are online. The count is read once and
+// cached. The first call must not race with other threads, setWorkerPinning
+// makes it on the calling thread.
+int getNumNodes();
+
+// Pin the calling thread to the CPUs of node.
+// Returns false if the thread could not be pinned.
+bool pinThreadToNode(int node);
+
+// Worker threads are assigned to the nodes round-robin
+int getWorkerNode(int workerID);
+
+// If pinning has been enabled, pin the calling thread to the node of worker workerID.
+// The pthread workers of SequenceProcessFramework call this from each of their threads.
+// setWorkerPinning must be called before the workers are started.
+void setWorkerPinning(bool enabled);
+void pinWorkerThread(int workerID);
+
+// Interleave the pages of [pData, pData + bytes) across all the nodes,
+// moving the pages that are already allocated. Returns false on failure.
+bool interleaveMemory(const void* pData, size_t bytes);
+
+// Move the pages of [pData, pData + bytes) to node. Returns false on failure.
+bool bindMemory(const void* pData, size_t bytes, int node);
+
+// Add the number of bytes of [pData, pData + bytes) resident on each node to
+// nodeBytes, which is resized to the number of nodes if necessary. Large
+// ranges are estimated from a sample of their pages.
+void addMemoryByNode(const void* pData, size_t bytes, std::vector<size_t>& nodeBytes);
+
+// Print the number of bytes per node with a label
+void printMemoryByNode(const std::string& label, const std::vector<size_t>& nodeBytes);
+
+};
+
+#endif
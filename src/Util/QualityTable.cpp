@@ -9,21 +9,129 @@
 #include <iostream>
 #include <algorithm>
 #include "QualityTable.h"
-#include "QualityCodec.h"
 #include "SeqReader.h"
 
-// Read the sequences from a file
-QualityTable::QualityTable() : m_bytes_used(0)
+// Huffman codes over 8 symbols are at most 7 bits long
+static const int MAX_CODE_LENGTH = QUALITY_NUM_BINS - 1;
+static const size_t NO_BLOCK = (size_t)-1;
+
+// The Illumina 8-level binning. Each bin holds the scores
+// from its lower bound and is decoded to a single score.
+static const int BIN_LOWER_PHRED[QUALITY_NUM_BINS] = { 0, 3, 10, 20, 25, 30, 35, 40 };
+static const int BIN_DECODED_PHRED[QUALITY_NUM_BINS] = { 2, 6, 15, 22, 27, 33, 37, 40 };
+
+//
+static uint8_t char2bin(char b)
+{
+    int phred = Quality::char2phred(b);
+    uint8_t bin = QUALITY_NUM_BINS - 1;
+    while(bin > 0 && phred < BIN_LOWER_PHRED[bin])
+        --bin;
+    return bin;
+}
+
+//
+static char bin2char(uint8_t bin)
+{
+    return Quality::phred2char(BIN_DECODED_PHRED[bin]);
+}
+
+// Compute the Huffman code length of each bin from its count.
+// Unused bins get length 0.
+static void computeCodeLengths(const size_t* counts, uint8_t* lengths)
+{
+    // Each node is a set of bins. Merging two nodes
+    // adds one bit to the codes of all their bins.
+    std::vector<size_t> weights;
+    std::vector<int> members;
+    for(int s = 0; s < QUALITY_NUM_BINS; ++s)
+    {
+        lengths[s] = 0;
+        if(counts[s] > 0)
+        {
+            weights.push_back(counts[s]);
+            members.push_back(1 << s);
+        }
+    }
+
+    // A single used bin still needs a 1-bit code
+    if(weights.size() == 1)
+    {
+        for(int s = 0; s < QUALITY_NUM_BINS; ++s)
+            lengths[s] = counts[s] > 0 ? 1 : 0;
+        return;
+    }
+
+    while(weights.size() > 1)
+    {
+        // Find the two lightest nodes
+        size_t a = 0;
+        size_t b = 1;
+        if(weights[b] < weights[a])
+            std::swap(a, b);
+        for(size_t i = 2; i < weights.size(); ++i)
+        {
+            if(weights[i] < weights[a])
+            {
+                b = a;
+                a = i;
+            }
+            else if(weights[i] < weights[b])
+            {
+                b = i;
+            }
+        }
+
+        for(int s = 0; s < QUALITY_NUM_BINS; ++s)
+        {
+            if((members[a] | members[b]) & (1 << s))
+                lengths[s] += 1;
+        }
+
+        weights[a] += weights[b];
+        members[a] |= members[b];
+        weights.erase(weights.begin() + b);
+        members.erase(members.begin() + b);
+    }
+}
+
+// Assign the canonical codes for the code lengths
+static void computeCodes(const uint8_t* lengths, uint8_t* codes)
+{
+    int code = 0;
+    for(int len = 1; len <= MAX_CODE_LENGTH; ++len)
+    {
+        for(int s = 0; s < QUALITY_NUM_BINS; ++s)
+        {
+            if(lengths[s] == len)
+                codes[s] = code++;
+        }
+        code <<= 1;
+    }
+}
+
+//
+QualityBlockCacheEntry::QualityBlockCacheEntry() : blockIdx(NO_BLOCK)
+{
+
+}
+
+//
+QualityTable::QualityTable() : m_numStrings(0)
 {
     int missing_phred = 20;
     m_missingQualityChar = Quality::phred2char(missing_phred);
+    pthread_key_create(&m_cacheKey, NULL);
+    pthread_mutex_init(&m_cacheMutex, NULL);
 }
 
- 
+//
 QualityTable::~QualityTable()
 {
-    for(size_t i = 0; i < m_table.size(); ++i)
-        delete m_table[i].encoded_data;
+    for(size_t i = 0; i < m_caches.size(); ++i)
+        delete m_caches[i];
+    pthread_key_delete(m_cacheKey);
+    pthread_mutex_destroy(&m_cacheMutex);
 }
 
 //
@@ -35,34 +143,169 @@ void QualityTable::loadQualities(const std::string& filename)
         addQualityString(sr.qual);
 }
 
-//
+// Only full blocks are compressed so the block of a read
+// is given by its index. The reads of the last, partial
+// block are kept uncompressed.
 void QualityTable::addQualityString(const std::string& qual)
 {
-    size_t num_bytes_required = m_codec.getRequiredUnits(qual.size());
-    QualityString incoming;
-    incoming.encoded_data = new QualityStorageUnit[num_bytes_required];
-    incoming.num_encoded_symbols = qual.size();
+    if(qual.size() > 0xFFFF)
+    {
+        std::cerr << "Error: quality string of length " << qual.size() << " is too long for the quality table\n";
+        exit(EXIT_FAILURE);
+    }
+
     for(size_t i = 0; i < qual.size(); ++i)
-        m_codec.store(incoming.encoded_data, i, qual[i]);
-    m_table.push_back(incoming);
+        m_pendingBins.push_back(char2bin(qual[i]));
+    m_pendingLengths.push_back(qual.size());
+    m_numStrings += 1;
 
-    //std::cout << "Stored:  " << qual << "\n";
-    //std::cout << "Decoded: " << getQualityString(m_table.size() - 1, qual.size()) << "\n";
-    m_bytes_used += (sizeof(incoming) + num_bytes_required);
+    if(m_pendingLengths.size() == QUALITY_BLOCK_READS)
+        flushBlock();
+}
+
+//
+void QualityTable::flushBlock()
+{
+    QualityBlock block;
+    block.offset = m_data.size();
+
+    size_t counts[QUALITY_NUM_BINS] = { 0 };
+    for(size_t i = 0; i < m_pendingBins.size(); ++i)
+        counts[m_pendingBins[i]] += 1;
+
+    uint8_t codes[QUALITY_NUM_BINS];
+    computeCodeLengths(counts, block.codeLengths);
+    computeCodes(block.codeLengths, codes);
+
+    for(size_t i = 0; i < m_pendingLengths.size(); ++i)
+    {
+        m_data.push_back(m_pendingLengths[i] & 0xFF);
+        m_data.push_back(m_pendingLengths[i] >> 8);
+    }
+
+    // Write the codes most significant bit first. Bits above
+    // the ones still to be written are discarded.
+    uint64_t bits = 0;
+    int numBits = 0;
+    for(size_t i = 0; i < m_pendingBins.size(); ++i)
+    {
+        uint8_t bin = m_pendingBins[i];
+        bits = (bits << block.codeLengths[bin]) | codes[bin];
+        numBits += block.codeLengths[bin];
+        while(numBits >= 8)
+        {
+            m_data.push_back((bits >> (numBits - 8)) & 0xFF);
+            numBits -= 8;
+        }
+    }
+
+    if(numBits > 0)
+        m_data.push_back((bits << (8 - numBits)) & 0xFF);
+
+    m_blocks.push_back(block);
+    m_pendingBins.clear();
+    m_pendingLengths.clear();
+}
+
+//
+void QualityTable::decodeBlock(size_t blockIdx, QualityBlockCacheEntry& entry) const
+{
+    const QualityBlock& block = m_blocks[blockIdx];
+    const uint8_t* pData = &m_data[block.offset];
+    size_t end = blockIdx + 1 < m_blocks.size() ? m_blocks[blockIdx + 1].offset : m_data.size();
+
+    entry.starts.resize(QUALITY_BLOCK_READS + 1);
+    size_t total = 0;
+    for(size_t i = 0; i < QUALITY_BLOCK_READS; ++i)
+    {
+        entry.starts[i] = total;
+        total += pData[2 * i] | (pData[2 * i + 1] << 8);
+    }
+    entry.starts[QUALITY_BLOCK_READS] = total;
+
+    // Build a table giving the bin and code length
+    // for every value of the next MAX_CODE_LENGTH bits
+    uint8_t codes[QUALITY_NUM_BINS];
+    computeCodes(block.codeLengths, codes);
+
+    char tableChars[1 << MAX_CODE_LENGTH];
+    uint8_t tableLengths[1 << MAX_CODE_LENGTH];
+    for(int s = 0; s < QUALITY_NUM_BINS; ++s)
+    {
+        int len = block.codeLengths[s];
+        if(len == 0)
+            continue;
+        int first = codes[s] << (MAX_CODE_LENGTH - len);
+        int last = (codes[s] + 1) << (MAX_CODE_LENGTH - len);
+        for(int j = first; j < last; ++j)
+        {
+            tableChars[j] = bin2char(s);
+            tableLengths[j] = len;
+        }
+    }
+
+    const uint8_t* pBits = pData + 2 * QUALITY_BLOCK_READS;
+    size_t numBytes = end - block.offset - 2 * QUALITY_BLOCK_READS;
+    size_t bitPos = 0;
+    entry.qualities.resize(total);
+    for(size_t i = 0; i < total; ++i)
+    {
+        size_t byte = bitPos >> 3;
+        int window = pBits[byte] << 8;
+        if(byte + 1 < numBytes)
+            window |= pBits[byte + 1];
+        window = (window >> (16 - MAX_CODE_LENGTH - (bitPos & 7))) & ((1 << MAX_CODE_LENGTH) - 1);
+        entry.qualities[i] = tableChars[window];
+        bitPos += tableLengths[window];
+    }
+    entry.blockIdx = blockIdx;
+}
+
+//
+QualityBlockCache* QualityTable::getThreadCache() const
+{
+    QualityBlockCache* pCache = static_cast<QualityBlockCache*>(pthread_getspecific(m_cacheKey));
+    if(pCache == NULL)
+    {
+        pCache = new QualityBlockCache;
+        pthread_setspecific(m_cacheKey, pCache);
+        pthread_mutex_lock(&m_cacheMutex);
+        m_caches.push_back(pCache);
+        pthread_mutex_unlock(&m_cacheMutex);
+    }
+    return pCache;
 }
 
 //
 std::string QualityTable::getQualityString(size_t idx, size_t n) const
 {
     // If there is no quality string for this index, return default qualities
-    if(idx >= m_table.size())
+    if(idx >= m_numStrings)
         return std::string(n, m_missingQualityChar);
 
-    QualityString encoded = m_table[idx];
+    size_t blockIdx = idx / QUALITY_BLOCK_READS;
+    size_t offset = idx % QUALITY_BLOCK_READS;
     std::string out;
-    out.reserve(encoded.num_encoded_symbols);
-    for(size_t i = 0; i < encoded.num_encoded_symbols; ++i)
-        out.push_back(m_codec.get(encoded.encoded_data, i));
+
+    if(blockIdx < m_blocks.size())
+    {
+        QualityBlockCache* pCache = getThreadCache();
+        QualityBlockCacheEntry& entry = pCache->entries[blockIdx % QUALITY_CACHE_BLOCKS];
+        if(entry.blockIdx != blockIdx)
+            decodeBlock(blockIdx, entry);
+        out = entry.qualities.substr(entry.starts[offset], entry.starts[offset + 1] - entry.starts[offset]);
+    }
+    else
+    {
+        // The read is in the uncompressed partial block
+        size_t start = 0;
+        for(size_t i = 0; i < offset; ++i)
+            start += m_pendingLengths[i];
+        out.reserve(m_pendingLengths[offset]);
+        for(size_t i = 0; i < m_pendingLengths[offset]; ++i)
+            out.push_back(bin2char(m_pendingBins[start + i]));
+    }
+
     assert(out.length() == n);
     return out;
 }
@@ -70,12 +313,32 @@ std::string QualityTable::getQualityString(size_t idx, size_t n) const
 //
 size_t QualityTable::getCount() const
 {
-    return m_table.size();
+    return m_numStrings;
+}
+
+//
+void QualityTable::clear()
+{
+    std::vector<uint8_t>().swap(m_data);
+    QualityBlockVector().swap(m_blocks);
+    std::vector<uint8_t>().swap(m_pendingBins);
+    std::vector<uint16_t>().swap(m_pendingLengths);
+    m_numStrings = 0;
+
+    pthread_mutex_lock(&m_cacheMutex);
+    for(size_t i = 0; i < m_caches.size(); ++i)
+    {
+        for(size_t j = 0; j < QUALITY_CACHE_BLOCKS; ++j)
+            m_caches[i]->entries[j].blockIdx = NO_BLOCK;
+    }
+    pthread_mutex_unlock(&m_cacheMutex);
 }
 
 //
 void QualityTable::printSize() const
 {
-    printf("QualityTable: %.2lfGB\n", (double)m_bytes_used / (1000 * 1000 * 1000));
+    size_t bytes = m_data.capacity() + m_blocks.capacity() * sizeof(QualityBlock) +
+                   m_pendingBins.capacity() + m_pendingLengths.capacity() * sizeof(uint16_t);
+    printf("QualityTable: %.2lfGB in %zu blocks\n", (double)bytes / (1000 * 1000 * 1000), m_blocks.size());
 }
 
@@ -6,20 +6,52 @@
 //
 // QualityTable - A 0-indexed table of quality scores
 //
+// The qualities are reduced to the 8 Illumina bins
+// and stored in blocks of consecutive reads. Each
+// block is Huffman coded with its own code table and
+// is found through a small index of block offsets.
+// Blocks are decoded on demand into a small cache
+// held by each querying thread.
+//
 #ifndef QUALITYTABLE_H
 #define QUALITYTABLE_H
+#include <pthread.h>
 #include "Util.h"
 #include "SeqReader.h"
-#include "QualityCodec.h"
-#include <map>
 
-struct QualityString
+// The number of reads per compressed block
+#define QUALITY_BLOCK_READS 64
+
+// The number of quality bins
+#define QUALITY_NUM_BINS 8
+
+// The number of blocks held in the cache of each thread
+#define QUALITY_CACHE_BLOCKS 8
+
+// The position of a block in the compressed data
+// and the Huffman code lengths of its symbols
+struct QualityBlock
+{
+    size_t offset;
+    uint8_t codeLengths[QUALITY_NUM_BINS];
+};
+typedef std::vector<QualityBlock> QualityBlockVector;
+
+// A decoded block. starts[i] is the position of the
+// i-th read of the block in qualities.
+struct QualityBlockCacheEntry
 {
-    uint8_t num_encoded_symbols;
-    QualityStorageUnit* encoded_data;
+    QualityBlockCacheEntry();
+
+    size_t blockIdx;
+    std::string qualities;
+    std::vector<size_t> starts;
 };
 
-typedef std::vector<QualityString> QualityStringVector;
+struct QualityBlockCache
+{
+    QualityBlockCacheEntry entries[QUALITY_CACHE_BLOCKS];
+};
 
 class QualityTable
 {
@@ -32,6 +64,8 @@ class QualityTable
         //
         void loadQualities(const std::string& filename);
         void addQualityString(const std::string& qual);
+
+        // Safe to call from multiple threads once all the strings are added
         std::string getQualityString(size_t idx, size_t n) const;
         size_t getCount() const;
         void clear();
@@ -40,9 +74,35 @@ class QualityTable
         void printSize() const;
 
     private:
-        QualityCodec<4> m_codec;
-        QualityStringVector m_table;
-        size_t m_bytes_used;
+
+        // Not copyable
+        QualityTable(const QualityTable&);
+        QualityTable& operator=(const QualityTable&);
+
+        // Compress the pending reads into a new block
+        void flushBlock();
+
+        // Decode a block into a cache entry
+        void decodeBlock(size_t blockIdx, QualityBlockCacheEntry& entry) const;
+
+        // Return the cache of the calling thread, creating it if necessary
+        QualityBlockCache* getThreadCache() const;
+
+        // Compressed blocks. Each block starts with the lengths of its reads
+        // as 16-bit values followed by the coded bins of all its qualities.
+        std::vector<uint8_t> m_data;
+        QualityBlockVector m_blocks;
+        size_t m_numStrings;
+
+        // The bins and lengths of the reads not yet in a block
+        std::vector<uint8_t> m_pendingBins;
+        std::vector<uint16_t> m_pendingLengths;
+
+        // The caches of all threads that queried this table
+        pthread_key_t m_cacheKey;
+        mutable pthread_mutex_t m_cacheMutex;
+        mutable std::vector<QualityBlockCache*> m_caches;
+
         char m_missingQualityChar;
 };
 
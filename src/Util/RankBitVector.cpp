@@ -0,0 +1,90 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// RankBitVector - A static bit vector supporting
+// constant-time rank queries and select queries.
+//
+#include "RankBitVector.h"
+#include <algorithm>
+#include <assert.h>
+
+//
+RankBitVector::RankBitVector() : m_numBits(0)
+{
+
+}
+
+//
+RankBitVector::RankBitVector(size_t n) : m_numBits(0)
+{
+    resize(n);
+}
+
+//
+void RankBitVector::resize(size_t n)
+{
+    m_numBits = n;
+    size_t num_words = (n >> WORD_SHIFT) + 1;
+    m_words.assign(num_words, 0);
+    m_blockRanks.clear();
+}
+
+//
+void RankBitVector::set(size_t i)
+{
+    assert(i < m_numBits);
+    m_words[i >> WORD_SHIFT] |= ((uint64_t)1 << (i & WORD_MASK));
+}
+
+//
+void RankBitVector::initializeRank()
+{
+    size_t words_per_block = 1 << BLOCK_WORD_SHIFT;
+    size_t num_blocks = (m_words.size() + words_per_block - 1) / words_per_block;
+    m_blockRanks.resize(num_blocks + 1);
+
+    uint64_t count = 0;
+    for(size_t j = 0; j < num_blocks; ++j)
+    {
+        m_blockRanks[j] = count;
+        size_t end = std::min(m_words.size(), (j + 1) * words_per_block);
+        for(size_t w = j * words_per_block; w < end; ++w)
+            count += __builtin_popcountll(m_words[w]);
+    }
+    m_blockRanks[num_blocks] = count;
+}
+
+//
+size_t RankBitVector::select(size_t k) const
+{
+    assert(k > 0 && k <= getNumSetBits());
+
+    // Find the last block that starts with fewer than k set bits
+    std::vector<uint64_t>::const_iterator iter = std::lower_bound(m_blockRanks.begin(), m_blockRanks.end(), k);
+    assert(iter != m_blockRanks.begin());
+    size_t block = (iter - m_blockRanks.begin()) - 1;
+    size_t remaining = k - m_blockRanks[block];
+
+    // Scan the words of the block
+    size_t w = block << BLOCK_WORD_SHIFT;
+    size_t count = __builtin_popcountll(m_words[w]);
+    while(count < remaining)
+    {
+        remaining -= count;
+        count = __builtin_popcountll(m_words[++w]);
+    }
+
+    // Clear the lower set bits of the word until the target is the lowest set bit
+    uint64_t word = m_words[w];
+    for(size_t i = 1; i < remaining; ++i)
+        word &= word - 1;
+    return (w << WORD_SHIFT) + __builtin_ctzll(word);
+}
+
+//
+size_t RankBitVector::getMemoryUsage() const
+{
+    return sizeof(*this) + sizeof(uint64_t) * (m_words.capacity() + m_blockRanks.capacity());
+}
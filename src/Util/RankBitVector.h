@@ -0,0 +1,82 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// RankBitVector - A static bit vector supporting
+// constant-time rank queries and select queries.
+// The bits are packed into 64-bit words and a
+// cumulative count is stored every 512 bits.
+// The vector is built by setting bits then calling
+// initializeRank(). It is read-only afterwards.
+//
+#ifndef RANKBITVECTOR_H
+#define RANKBITVECTOR_H
+
+#include <vector>
+#include <stdint.h>
+#include <cstddef>
+
+class RankBitVector
+{
+    public:
+
+        RankBitVector();
+        RankBitVector(size_t n);
+
+        // Resize the vector to n bits, all bits are cleared
+        void resize(size_t n);
+
+        // Set bit i to 1. Invalidates the rank structure.
+        void set(size_t i);
+
+        // Build the rank/select support. Must be called after the last set()
+        void initializeRank();
+
+        // Test bit i
+        inline bool test(size_t i) const
+        {
+            return (m_words[i >> WORD_SHIFT] >> (i & WORD_MASK)) & 1;
+        }
+
+        // Returns the number of set bits in the range [0, i]
+        inline size_t rank(size_t i) const
+        {
+            size_t word = i >> WORD_SHIFT;
+            size_t block = word >> BLOCK_WORD_SHIFT;
+            size_t count = m_blockRanks[block];
+            for(size_t w = block << BLOCK_WORD_SHIFT; w < word; ++w)
+                count += __builtin_popcountll(m_words[w]);
+
+            // Mask off the bits after i in the last word
+            uint64_t mask = (~(uint64_t)0) >> (WORD_MASK - (i & WORD_MASK));
+            return count + __builtin_popcountll(m_words[word] & mask);
+        }
+
+        // Returns the position of the k-th set bit, 1-based in k
+        size_t select(size_t k) const;
+
+        // Returns the total number of set bits
+        size_t getNumSetBits() const { return m_blockRanks.empty() ? 0 : m_blockRanks.back(); }
+
+        // Returns the number of bits in the vector
+        size_t size() const { return m_numBits; }
+
+        // Returns the number of bytes used by the structure
+        size_t getMemoryUsage() const;
+
+    private:
+
+        static const size_t WORD_SHIFT = 6;
+        static const size_t WORD_MASK = 63;
+        static const size_t BLOCK_WORD_SHIFT = 3; // 8 words per rank block
+
+        size_t m_numBits;
+        std::vector<uint64_t> m_words;
+
+        // m_blockRanks[j] is the number of set bits before block j
+        // The final element holds the total number of set bits
+        std::vector<uint64_t> m_blockRanks;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include "StdAlnTools.h"
 #include "stdaln.h"
 #include "Alphabet.h"
+#include "StripedAlignment.h"
 
 // Perform a global alignment between the given strings
 int StdAlnTools::globalAlignment(const std::string& target, const std::string& query, bool bPrint)
@@ -54,10 +55,37 @@ void StdAlnTools::globalAlignment(const std::string& target, const std::string&
 }
 
 
+//
+LocalAlignmentProfile::LocalAlignmentProfile(const std::string& target) : m_target(target)
+{
+    GlobalAlnParams params;
+    AlnParam par;
+    int matrix[25];
+    StdAlnTools::setAlnParam(par, matrix, params);
+
+    m_pPackedTarget = StdAlnTools::createPacked(target);
+    m_pStripedProfile = new StripedLocalProfile(m_pPackedTarget, target.size(), par);
+}
+
+//
+LocalAlignmentProfile::~LocalAlignmentProfile()
+{
+    delete m_pStripedProfile;
+    delete [] m_pPackedTarget;
+}
+
 // Perform a local alignment
 LocalAlignmentResult StdAlnTools::localAlignment(const std::string& target, const std::string& query)
+{
+    LocalAlignmentProfile profile(target);
+    return localAlignment(profile, query);
+}
+
+// Perform a local alignment against a prepared target
+LocalAlignmentResult StdAlnTools::localAlignment(const LocalAlignmentProfile& profile, const std::string& query)
 {
     // Set up global alignment parameters and data structures
+    const std::string& target = profile.getTarget();
     GlobalAlnParams params;
     int max_path_length = target.size() + query.size();
     path_t *path = (path_t*)calloc(max_path_length, sizeof(path_t));
@@ -67,12 +95,19 @@ LocalAlignmentResult StdAlnTools::localAlignment(const std::string& target, cons
     int matrix[25];
     StdAlnTools::setAlnParam(par, matrix, params);
 
-    // Make a packed version of the query and target
+    // Make a packed version of the query
     uint8_t* pQueryT = createPacked(query);
-    uint8_t* pTargetT = createPacked(target);
+    uint8_t* pTargetT = const_cast<uint8_t*>(profile.getPackedTarget());
     
+    // Find the end of the best alignment with the SIMD profile then use
+    // stdaln to find the start and the path. If the profile cannot be used,
+    // or there is no positive-scoring cell, stdaln performs the full alignment.
     LocalAlignmentResult result;
-    result.score = aln_local_core(pTargetT, target.size(), pQueryT, query.size(), &par, path, &path_len, 1, 0);
+    int score, end_i, end_j;
+    if(profile.getStripedProfile()->findBestEnd(pQueryT, query.size(), score, end_i, end_j) && end_i > 0)
+        result.score = aln_local_core_from_end(pTargetT, target.size(), pQueryT, query.size(), &par, path, &path_len, 1, score, end_i, end_j);
+    else
+        result.score = aln_local_core(pTargetT, target.size(), pQueryT, query.size(), &par, path, &path_len, 1, 0);
     assert(path_len <= max_path_length);
 
     result.cigar = makeCigar(path, path_len);
@@ -104,7 +139,6 @@ LocalAlignmentResult StdAlnTools::localAlignment(const std::string& target, cons
 
     // Clean up
     delete [] pQueryT;
-    delete [] pTargetT;
     free(path);
 
     return result;
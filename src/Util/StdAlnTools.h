@@ -70,6 +70,31 @@ struct LocalAlignmentResult
 };
 typedef std::vector<LocalAlignmentResult> LocalAlignmentResultVector;
 
+class StripedLocalProfile;
+
+// A target sequence prepared for local alignment to many queries.
+// The packed target and its SIMD score profile are built once.
+class LocalAlignmentProfile
+{
+    public:
+        LocalAlignmentProfile(const std::string& target);
+        ~LocalAlignmentProfile();
+
+        const std::string& getTarget() const { return m_target; }
+        const uint8_t* getPackedTarget() const { return m_pPackedTarget; }
+        const StripedLocalProfile* getStripedProfile() const { return m_pStripedProfile; }
+
+    private:
+
+        // Not copyable
+        LocalAlignmentProfile(const LocalAlignmentProfile&);
+        LocalAlignmentProfile& operator=(const LocalAlignmentProfile&);
+
+        std::string m_target;
+        uint8_t* m_pPackedTarget;
+        StripedLocalProfile* m_pStripedProfile;
+};
+
 namespace StdAlnTools
 {
     // Perform a global alignment between target and query using stdaln
@@ -86,6 +111,9 @@ namespace StdAlnTools
     // Perform a local alignment
     LocalAlignmentResult localAlignment(const std::string& target, const std::string& query);
 
+    // Perform a local alignment between the profiled target and the query
+    LocalAlignmentResult localAlignment(const LocalAlignmentProfile& profile, const std::string& query);
+
     // Expand a Cigar string so there is one symbol per code
     std::string expandCigar(const std::string& cigar);
     
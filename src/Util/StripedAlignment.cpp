@@ -0,0 +1,368 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// StripedAlignment - SIMD computation of the forward
+// pass of the stdaln local alignment using the
+// striped layout of Farrar (2007).
+//
+// The recurrence is the one used by aln_local_core,
+// where sequence 1 is the target and sequence 2 the query:
+//   H(i,j) = max(0, H(i-1,j-1) + s(i,j), E(i,j), F(i,j))
+//   F(i,j) = max(F(i-1,j) - r, H(i-1,j) - (q + r))
+//   E(i,j) = max(E(i,j-1) - r, H(i,j-1) - (q + r)) if H(i,j-1) > q + r, 0 otherwise
+// The target is striped over the SIMD lanes and the
+// query is processed one base (column) at a time.
+//
+#include "StripedAlignment.h"
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+// aln_local_core rescales its scores once they exceed this value,
+// which can change the result. We only handle alignments below it.
+static const int STRIPED_MAX_LOCAL_SCORE = 32000;
+
+#ifdef __SSE2__
+
+static const int BYTE_LANES = 16;
+static const int WORD_LANES = 8;
+
+// Return the largest unsigned byte in the vector
+static inline int maxByte(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+// Return the largest signed word in the vector
+static inline int maxWord(__m128i v)
+{
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+    return (int16_t)_mm_extract_epi16(v, 0);
+}
+
+//
+StripedLocalProfile::StripedLocalProfile(const uint8_t* pTarget, int targetLen, const AlnParam& par) : m_targetLen(targetLen)
+{
+    m_numSymbols = par.row;
+    m_gapOpenExtend = par.gap_open + par.gap_ext;
+    m_gapExtend = par.gap_ext;
+
+    int minScore = 0;
+    m_maxScore = 0;
+    for(int i = 0; i < m_numSymbols * m_numSymbols; ++i)
+    {
+        minScore = std::min(minScore, par.matrix[i]);
+        m_maxScore = std::max(m_maxScore, par.matrix[i]);
+    }
+    m_bias = -minScore;
+
+    // Build the profiles. Segment k of lane l holds target position l * segments + k.
+    // Positions past the end of the target score as badly as possible.
+    m_byteSegments = (targetLen + BYTE_LANES - 1) / BYTE_LANES;
+    m_wordSegments = (targetLen + WORD_LANES - 1) / WORD_LANES;
+    m_pByteProfile = _mm_malloc(sizeof(__m128i) * std::max(1, m_numSymbols * m_byteSegments), sizeof(__m128i));
+    m_pWordProfile = _mm_malloc(sizeof(__m128i) * std::max(1, m_numSymbols * m_wordSegments), sizeof(__m128i));
+
+    uint8_t* pByte = (uint8_t*)m_pByteProfile;
+    int16_t* pWord = (int16_t*)m_pWordProfile;
+    for(int s = 0; s < m_numSymbols; ++s)
+    {
+        // stdaln scores query symbol s against target symbol t with matrix[s * row + t]
+        const int* pRow = par.matrix + s * m_numSymbols;
+        for(int k = 0; k < m_byteSegments; ++k)
+        {
+            for(int l = 0; l < BYTE_LANES; ++l)
+            {
+                int pos = l * m_byteSegments + k;
+                *pByte++ = pos < targetLen ? pRow[pTarget[pos]] + m_bias : 0;
+            }
+        }
+
+        for(int k = 0; k < m_wordSegments; ++k)
+        {
+            for(int l = 0; l < WORD_LANES; ++l)
+            {
+                int pos = l * m_wordSegments + k;
+                *pWord++ = pos < targetLen ? pRow[pTarget[pos]] : minScore;
+            }
+        }
+    }
+}
+
+//
+StripedLocalProfile::~StripedLocalProfile()
+{
+    _mm_free(m_pByteProfile);
+    _mm_free(m_pWordProfile);
+}
+
+//
+bool StripedLocalProfile::findBestEnd(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const
+{
+    if(m_targetLen == 0 || queryLen == 0)
+        return false;
+
+    // The byte kernel can only be used if a cell score plus a profile score fits in a byte
+    if(m_bias + m_maxScore < 255 && alignByte(pQuery, queryLen, score, end_i, end_j))
+        return true;
+    return alignWord(pQuery, queryLen, score, end_i, end_j);
+}
+
+// 8-bit kernel using unsigned saturating arithmetic. Negative
+// values of E and F saturate to zero, which does not change H.
+bool StripedLocalProfile::alignByte(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const
+{
+    int segLen = m_byteSegments;
+    const __m128i* pProfile = (const __m128i*)m_pByteProfile;
+
+    // Scores must stay below this value for the next column to be computed exactly
+    int limit = 255 - m_bias - m_maxScore;
+
+    __m128i* pBuffer = (__m128i*)_mm_malloc(sizeof(__m128i) * segLen * 4, sizeof(__m128i));
+    __m128i* pvHLoad = pBuffer;
+    __m128i* pvHStore = pBuffer + segLen;
+    __m128i* pvE = pBuffer + 2 * segLen;
+    __m128i* pvHMax = pBuffer + 3 * segLen;
+
+    __m128i vZero = _mm_setzero_si128();
+    for(int k = 0; k < segLen * 4; ++k)
+        pBuffer[k] = vZero;
+
+    __m128i vGapOE = _mm_set1_epi8(m_gapOpenExtend);
+    __m128i vGapE = _mm_set1_epi8(m_gapExtend);
+    __m128i vBias = _mm_set1_epi8(m_bias);
+
+    bool overflow = false;
+    int best = 0;
+    int bestColumn = 0;
+    for(int j = 0; j < queryLen; ++j)
+    {
+        const __m128i* pColProfile = pProfile + pQuery[j] * segLen;
+        __m128i vF = vZero;
+        __m128i vMaxColumn = vZero;
+
+        // The diagonal cell of the first segment is the last segment of the previous column, shifted by one lane
+        __m128i vH = _mm_slli_si128(pvHLoad[segLen - 1], 1);
+
+        for(int k = 0; k < segLen; ++k)
+        {
+            // Calculate E from the cell to the left
+            __m128i vHLeft = pvHLoad[k];
+            __m128i vHLeftGap = _mm_subs_epu8(vHLeft, vGapOE);
+            __m128i vE = _mm_max_epu8(_mm_subs_epu8(pvE[k], vGapE), vHLeftGap);
+            vE = _mm_andnot_si128(_mm_cmpeq_epi8(vHLeftGap, vZero), vE);
+            pvE[k] = vE;
+
+            vH = _mm_subs_epu8(_mm_adds_epu8(vH, pColProfile[k]), vBias);
+            vH = _mm_max_epu8(vH, vE);
+            vH = _mm_max_epu8(vH, vF);
+            vMaxColumn = _mm_max_epu8(vMaxColumn, vH);
+            pvHStore[k] = vH;
+
+            vF = _mm_max_epu8(_mm_subs_epu8(vF, vGapE), _mm_subs_epu8(vH, vGapOE));
+            vH = vHLeft;
+        }
+
+        // Lazy-F loop, propagate F across the segment boundaries until it can no longer change H.
+        // The gap opened from the H values was already propagated by the loop above so
+        // only the extension of the incoming gap needs to be followed.
+        int k = 0;
+        vF = _mm_slli_si128(vF, 1);
+        while(1)
+        {
+            vH = pvHStore[k];
+            __m128i vHGap = _mm_subs_epu8(vH, vGapOE);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(vF, vHGap), vZero)) == 0xFFFF)
+                break;
+            vH = _mm_max_epu8(vH, vF);
+            vMaxColumn = _mm_max_epu8(vMaxColumn, vH);
+            pvHStore[k] = vH;
+            vF = _mm_subs_epu8(vF, vGapE);
+            if(++k == segLen)
+            {
+                k = 0;
+                vF = _mm_slli_si128(vF, 1);
+            }
+        }
+
+        int columnMax = maxByte(vMaxColumn);
+        if(columnMax > limit)
+        {
+            overflow = true;
+            break;
+        }
+
+        // Keep a copy of the first column to reach the best score
+        if(columnMax > best)
+        {
+            best = columnMax;
+            bestColumn = j + 1;
+            memcpy(pvHMax, pvHStore, sizeof(__m128i) * segLen);
+        }
+
+        __m128i* pTmp = pvHLoad;
+        pvHLoad = pvHStore;
+        pvHStore = pTmp;
+    }
+
+    if(!overflow)
+    {
+        // Find the first target position in the best column with the best score
+        score = best;
+        end_j = bestColumn;
+        end_i = 0;
+        const uint8_t* pScores = (const uint8_t*)pvHMax;
+        for(int pos = 0; best > 0 && pos < m_targetLen; ++pos)
+        {
+            if(pScores[(pos % segLen) * BYTE_LANES + pos / segLen] == best)
+            {
+                end_i = pos + 1;
+                break;
+            }
+        }
+    }
+
+    _mm_free(pBuffer);
+    return !overflow;
+}
+
+// 16-bit kernel using signed saturating arithmetic
+bool StripedLocalProfile::alignWord(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const
+{
+    int segLen = m_wordSegments;
+    const __m128i* pProfile = (const __m128i*)m_pWordProfile;
+
+    __m128i* pBuffer = (__m128i*)_mm_malloc(sizeof(__m128i) * segLen * 4, sizeof(__m128i));
+    __m128i* pvHLoad = pBuffer;
+    __m128i* pvHStore = pBuffer + segLen;
+    __m128i* pvE = pBuffer + 2 * segLen;
+    __m128i* pvHMax = pBuffer + 3 * segLen;
+
+    __m128i vZero = _mm_setzero_si128();
+    for(int k = 0; k < segLen * 4; ++k)
+        pBuffer[k] = vZero;
+
+    __m128i vGapOE = _mm_set1_epi16(m_gapOpenExtend);
+    __m128i vGapE = _mm_set1_epi16(m_gapExtend);
+
+    bool overflow = false;
+    int best = 0;
+    int bestColumn = 0;
+    for(int j = 0; j < queryLen; ++j)
+    {
+        const __m128i* pColProfile = pProfile + pQuery[j] * segLen;
+        __m128i vF = vZero;
+        __m128i vMaxColumn = vZero;
+        __m128i vH = _mm_slli_si128(pvHLoad[segLen - 1], 2);
+
+        for(int k = 0; k < segLen; ++k)
+        {
+            __m128i vHLeft = pvHLoad[k];
+            __m128i vE = _mm_max_epi16(_mm_subs_epi16(pvE[k], vGapE), _mm_subs_epi16(vHLeft, vGapOE));
+            vE = _mm_and_si128(_mm_cmpgt_epi16(vHLeft, vGapOE), vE);
+            pvE[k] = vE;
+
+            vH = _mm_max_epi16(_mm_adds_epi16(vH, pColProfile[k]), vZero);
+            vH = _mm_max_epi16(vH, vE);
+            vH = _mm_max_epi16(vH, vF);
+            vMaxColumn = _mm_max_epi16(vMaxColumn, vH);
+            pvHStore[k] = vH;
+
+            vF = _mm_max_epi16(_mm_subs_epi16(vF, vGapE), _mm_subs_epi16(vH, vGapOE));
+            vH = vHLeft;
+        }
+
+        int k = 0;
+        vF = _mm_slli_si128(vF, 2);
+        while(1)
+        {
+            vH = pvHStore[k];
+            __m128i vHGap = _mm_max_epi16(_mm_subs_epi16(vH, vGapOE), vZero);
+            if(_mm_movemask_epi8(_mm_cmpgt_epi16(vF, vHGap)) == 0)
+                break;
+            vH = _mm_max_epi16(vH, vF);
+            vMaxColumn = _mm_max_epi16(vMaxColumn, vH);
+            pvHStore[k] = vH;
+            vF = _mm_subs_epi16(vF, vGapE);
+            if(++k == segLen)
+            {
+                k = 0;
+                vF = _mm_slli_si128(vF, 2);
+            }
+        }
+
+        int columnMax = maxWord(vMaxColumn);
+        if(columnMax > STRIPED_MAX_LOCAL_SCORE)
+        {
+            overflow = true;
+            break;
+        }
+
+        if(columnMax > best)
+        {
+            best = columnMax;
+            bestColumn = j + 1;
+            memcpy(pvHMax, pvHStore, sizeof(__m128i) * segLen);
+        }
+
+        __m128i* pTmp = pvHLoad;
+        pvHLoad = pvHStore;
+        pvHStore = pTmp;
+    }
+
+    if(!overflow)
+    {
+        score = best;
+        end_j = bestColumn;
+        end_i = 0;
+        const int16_t* pScores = (const int16_t*)pvHMax;
+        for(int pos = 0; best > 0 && pos < m_targetLen; ++pos)
+        {
+            if(pScores[(pos % segLen) * WORD_LANES + pos / segLen] == best)
+            {
+                end_i = pos + 1;
+                break;
+            }
+        }
+    }
+
+    _mm_free(pBuffer);
+    return !overflow;
+}
+
+#else // no SSE2, always use aln_local_core
+
+//
+StripedLocalProfile::StripedLocalProfile(const uint8_t* /*pTarget*/, int targetLen, const AlnParam& /*par*/) : m_targetLen(targetLen),
+                                                                                                                   m_pByteProfile(NULL),
+                                                                                                                   m_pWordProfile(NULL)
+{
+
+}
+
+//
+StripedLocalProfile::~StripedLocalProfile()
+{
+
+}
+
+//
+bool StripedLocalProfile::findBestEnd(const uint8_t* /*pQuery*/, int /*queryLen*/, int& /*score*/, int& /*end_i*/, int& /*end_j*/) const
+{
+    return false;
+}
+
+#endif
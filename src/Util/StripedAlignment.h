@@ -0,0 +1,60 @@
+//-----------------------------------------------
+// Copyright 2026 The SGA contributors
+// Released under the GPL
+//-----------------------------------------------
+//
+// StripedAlignment - SIMD computation of the forward
+// pass of the stdaln local alignment using the
+// striped layout of Farrar (2007). The score profile
+// of the target is built once and can be reused to
+// align any number of queries. Scores are first computed
+// in 8-bit lanes and recomputed in 16-bit lanes if they
+// saturate.
+//
+#ifndef STRIPEDALIGNMENT_H
+#define STRIPEDALIGNMENT_H
+
+#include <stdint.h>
+#include "stdaln.h"
+
+class StripedLocalProfile
+{
+    public:
+
+        // pTarget is the packed target sequence. The scoring
+        // parameters are copied from par.
+        StripedLocalProfile(const uint8_t* pTarget, int targetLen, const AlnParam& par);
+        ~StripedLocalProfile();
+
+        // Calculate the best local alignment score between the target and the packed query
+        // and the 1-based coordinates of the cell it ends in. The cell is the same
+        // one aln_local_core would choose. Returns false if the profile cannot be used
+        // for this query, in which case the caller should use aln_local_core.
+        bool findBestEnd(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const;
+
+    private:
+
+        // Not copyable
+        StripedLocalProfile(const StripedLocalProfile&);
+        StripedLocalProfile& operator=(const StripedLocalProfile&);
+
+        // Kernels for the two lane widths. Return false if the scores overflow.
+        bool alignByte(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const;
+        bool alignWord(const uint8_t* pQuery, int queryLen, int& score, int& end_i, int& end_j) const;
+
+        //
+        int m_targetLen;
+        int m_numSymbols;
+        int m_gapOpenExtend;
+        int m_gapExtend;
+        int m_maxScore;
+        int m_bias; // added to the byte profile to make the scores non-negative
+
+        // Profiles, one row of segments per query symbol
+        int m_byteSegments;
+        int m_wordSegments;
+        void* m_pByteProfile;
+        void* m_pWordProfile;
+};
+
+#endif
@@ -21,8 +21,16 @@
 #include <stdio.h>
 #include <time.h>
 #include <queue>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+#include "config.h"
 #include "MkqsThread.h"
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #define mkqs_swap(a, b) { T tmp = x[a]; x[a] = x[b]; x[b] = tmp; }
 
 // Swap [i..i+n] and [j..j+n] in x
@@ -142,96 +150,139 @@ void mkqs2(T* a, int n, int depth, const PrimarySorter& primarySorter, const Fin
         mkqs2(a + n-r, r, depth, primarySorter, finalSorter);
 }
 
-// Parallel multikey quicksort. It performs mkqs but will
-// subdivide the array to sort into sub jobs which can be sorted using threads.
+// Parallel multikey quicksort. 
+// The array is first partitioned in parallel by the radix bucket of each
+// element's prefix, using the bucket function of the primary sorter
+// (getBucket/getNumBuckets/getBucketLen/isBucketDegenerate). Each bucket
+// becomes a sort job and the jobs are dealt out to per-thread deques.
+// Threads subdivide large jobs with mkqs partitioning steps and steal
+// work from each other when their own deque runs dry.
+// If pScratch is not NULL it must point to n free elements that
+// are used as the target of the radix partition, otherwise a 
+// temporary buffer is allocated.
 template<typename T, typename PrimarySorter, typename FinalSorter>
-void parallel_mkqs(T* pData, int n, int numThreads, const PrimarySorter& primarySorter, const FinalSorter& finalSorter)
+void parallel_mkqs(T* pData, int n, int numThreads, const PrimarySorter& primarySorter, const FinalSorter& finalSorter, T* pScratch = NULL)
 {
     typedef MkqsJob<T> Job;
-    typedef std::queue<Job> JobQueue;
-    Job initialJob(pData, n, 0);
-    JobQueue queue;
-    queue.push(initialJob);
-    
-    // Create the mutex that guards the queue
-    pthread_mutex_t queue_mutex;
-    int ret = pthread_mutex_init(&queue_mutex, NULL);
-    if(ret != 0)
+    typedef MkqsJobDeque<T> JobDeque;
+
+    // Small inputs are not worth distributing
+    if(numThreads <= 1 || n < numThreads * 1024)
     {
-        std::cerr << "Mutex initialization failed with error " << ret << ", aborting" << std::endl;
-        exit(EXIT_FAILURE);
+        mkqs2(pData, n, 0, primarySorter, finalSorter);
+        return;
     }
 
-    // Calculate the threshold size for performing serial continuation of the sort. Once the chunks 
-    // are below this size, it is better to not subdivide the problem into smaller chunks
-    // to avoid the overhead of locking, adding to the queue, etc. 
-    int threshold_size = n / numThreads;
+    //
+    // Radix partition. Each thread counts the buckets of a contiguous chunk
+    // of the input, then scatters its chunk to its slice of each bucket.
+    //
+    int num_buckets = primarySorter.getNumBuckets();
+    std::vector<int64_t> chunk_counts((int64_t)numThreads * num_buckets, 0);
+
+    T* pBuffer = pScratch;
+    if(pBuffer == NULL)
+        pBuffer = new T[n];
 
-    // Create the semaphore used to signal that data is ready to be processed
-    // Initial value is 1 as there is one item on the queue to start
-    sem_t queue_sem;
-    ret = sem_init( &queue_sem, PTHREAD_PROCESS_PRIVATE, 1 );
-    if(ret != 0)
+#if HAVE_OPENMP
+    omp_set_num_threads(numThreads);
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int t = 0; t < numThreads; ++t)
     {
-        std::cerr << "Semaphore initialization failed with error " << ret << "\n";
-        std::cerr << "You are probably running on OSX which does not provide unnamed semaphores\n";
-        exit(EXIT_FAILURE);
+        int64_t* counts = &chunk_counts[(int64_t)t * num_buckets];
+        int64_t start = (int64_t)n * t / numThreads;
+        int64_t end = (int64_t)n * (t + 1) / numThreads;
+        for(int64_t i = start; i < end; ++i)
+            counts[primarySorter.getBucket(pData[i])] += 1;
     }
 
-    // Create the semaphore indicating a thread is finished working.
-    // This semaphore is incremented by the threads in their run loop
-    // before waiting for queue items. If the thread takes an item,
-    // this semaphore is decremented. The main thread checks
-    // this semaphore after confirming the queue is empty. If this 
-    // semaphore value equals the total number of threads, 
-    // no more work can remain the the threads are cleaned up
-    sem_t done_sem;
-    ret = sem_init( &done_sem, PTHREAD_PROCESS_PRIVATE, 0 );
-    if(ret != 0)
+    // Convert the counts to the position each chunk writes its first element of the bucket to
+    std::vector<int64_t> bucket_starts(num_buckets + 1, 0);
+    int64_t offset = 0;
+    for(int b = 0; b < num_buckets; ++b)
     {
-        std::cerr << "Semaphore initialization failed with error " << ret << "\n";
-        std::cerr << "You are probably running on OSX which does not provide unnamed semaphores\n";
-        exit(EXIT_FAILURE);
+        bucket_starts[b] = offset;
+        for(int t = 0; t < numThreads; ++t)
+        {
+            int64_t& c = chunk_counts[(int64_t)t * num_buckets + b];
+            int64_t tmp = c;
+            c = offset;
+            offset += tmp;
+        }
     }
+    bucket_starts[num_buckets] = offset;
+    assert(offset == n);
 
-    // Create and start the threads
-    MkqsThread<T, PrimarySorter, FinalSorter>* threads[numThreads];
-    for(int i = 0; i < numThreads; ++i)
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int t = 0; t < numThreads; ++t)
     {
-        threads[i] = new MkqsThread<T, PrimarySorter, FinalSorter>(i, &queue, &queue_mutex, &queue_sem, &done_sem, threshold_size, &primarySorter, &finalSorter);   
-        threads[i]->start();
+        int64_t* positions = &chunk_counts[(int64_t)t * num_buckets];
+        int64_t start = (int64_t)n * t / numThreads;
+        int64_t end = (int64_t)n * (t + 1) / numThreads;
+        for(int64_t i = start; i < end; ++i)
+            pBuffer[positions[primarySorter.getBucket(pData[i])]++] = pData[i];
     }
 
-    // Check for the end condition
-    bool done = false;
-    while(!done)
+#if HAVE_OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for(int t = 0; t < numThreads; ++t)
     {
-        sleep(1);
+        int64_t start = (int64_t)n * t / numThreads;
+        int64_t end = (int64_t)n * (t + 1) / numThreads;
+        std::copy(pBuffer + start, pBuffer + end, pData + start);
+    }
 
-        // Check if the queue is empty
-        // If it is and all threads are finished working (all have posted to
-        // the done semaphore), then the threads can be cleaned up.
-        pthread_mutex_lock(&queue_mutex);
-        if(queue.empty())
-        {
-            int semval;
-            sem_getvalue(&done_sem, &semval);
-            if(semval == numThreads)
-                done = true;
-        }
-        pthread_mutex_unlock(&queue_mutex);
+    if(pScratch == NULL)
+        delete [] pBuffer;
+
+    //
+    // Create a job for each bucket. The elements of a bucket share a prefix
+    // of getBucketLen() symbols so the sort continues at that depth. 
+    // Degenerate buckets contain suffixes that end within the prefix and 
+    // only need the final sort.
+    //
+    std::vector<Job> initial_jobs;
+    for(int b = 0; b < num_buckets; ++b)
+    {
+        int count = bucket_starts[b + 1] - bucket_starts[b];
+        if(count == 0)
+            continue;
+        T* pBucket = pData + bucket_starts[b];
+        if(primarySorter.isBucketDegenerate(b))
+            initial_jobs.push_back(Job(pBucket, count, 0, true));
+        else if(count > 1)
+            initial_jobs.push_back(Job(pBucket, count, primarySorter.getBucketLen()));
     }
 
-    // Signal all the threads to stop, then post to the semaphore they are waiting on
-    // All threads will pick up the stop request after the posts and call pthread exit
+    // Deal the jobs out to the threads, largest first, to the least loaded thread
+    std::sort(initial_jobs.begin(), initial_jobs.end(), MkqsJobSizeCompare<T>());
+    std::vector<JobDeque*> deques(numThreads);
+    std::vector<int64_t> loads(numThreads, 0);
     for(int i = 0; i < numThreads; ++i)
+        deques[i] = new JobDeque;
+
+    for(size_t i = 0; i < initial_jobs.size(); ++i)
     {
-        threads[i]->stop();
+        int min_idx = std::min_element(loads.begin(), loads.end()) - loads.begin();
+        deques[min_idx]->push(initial_jobs[i]);
+        loads[min_idx] += initial_jobs[i].n;
     }
 
+    // Jobs larger than the threshold are split by one partitioning
+    // step so that threads have work to steal
+    int threshold_size = std::max(n / (numThreads * 64), 1024);
+    volatile int num_pending_jobs = initial_jobs.size();
+
+    // Create and start the threads
+    std::vector<MkqsThread<T, PrimarySorter, FinalSorter>*> threads(numThreads);
     for(int i = 0; i < numThreads; ++i)
     {
-        sem_post(&queue_sem);
+        threads[i] = new MkqsThread<T, PrimarySorter, FinalSorter>(i, &deques, &num_pending_jobs, threshold_size, &primarySorter, &finalSorter);   
+        threads[i]->start();
     }
 
     // Join and destroy the threads
@@ -239,31 +290,20 @@ void parallel_mkqs(T* pData, int n, int numThreads, const PrimarySorter& primary
     {
         threads[i]->join();
         delete threads[i];
+        delete deques[i];
     }
-
-    // Destroy the semaphore
-    sem_destroy(&queue_sem);
-    sem_destroy(&done_sem);
-
-    // Destroy the queue mutex
-    ret = pthread_mutex_destroy(&queue_mutex);
-    if(ret != 0)
-    {
-        std::cerr << "Mutex destruction failed with error " << ret << ", aborting" << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    assert(num_pending_jobs == 0);
 }
 
 //
 // Perform a partial sort of the data using the mkqs algorithm
-// Iterative sort jobs are created and added to pQueue which is
-// protected by pQueueMutex. After addition, pQueueSem is updated.
+// The subjobs created are counted in pNumPendingJobs and then 
+// added to the back of pDeque, which is owned by the calling thread.
 //
 template<typename T, class PrimarySorter, class FinalSorter>
 void parallel_mkqs_process(MkqsJob<T>& job, 
-                           std::queue<MkqsJob<T> >* pQueue, 
-                           pthread_mutex_t* pQueueMutex, 
-                           sem_t* pQueueSem,
+                           MkqsJobDeque<T>* pDeque, 
+                           volatile int* pNumPendingJobs,
                            const PrimarySorter& primarySorter, 
                            const FinalSorter& finalSorter)
 {
@@ -311,22 +351,16 @@ void parallel_mkqs_process(MkqsJob<T>& job,
     r = std::min(pa-a, pb-pa);    vecswap2(a,  pb-r, r);
     r = std::min(pd-pc, pn-pd-1); vecswap2(pb, pn-r, r);
 
-    // Lock the queue and push new items if necessary
-    // If new items are added to the queue, the semaphore is posted to
-    pthread_mutex_lock(pQueueMutex);
+    // Collect the subjobs
+    MkqsJob<T> subjobs[3];
+    int num_subjobs = 0;
 
     if ((r = pb-pa) > 1)
-    {
-        MkqsJob<T> job(a, r, depth);
-        pQueue->push(job);
-        sem_post(pQueueSem);
-    }
+        subjobs[num_subjobs++] = MkqsJob<T>(a, r, depth);
     
     if (ptr2char(a + r) != 0)
     {
-        MkqsJob<T> job(a + r, pa-a + pn-pd-1, depth + 1);
-        pQueue->push(job);
-        sem_post(pQueueSem);
+        subjobs[num_subjobs++] = MkqsJob<T>(a + r, pa-a + pn-pd-1, depth + 1);
     }
     else
     {
@@ -336,14 +370,11 @@ void parallel_mkqs_process(MkqsJob<T>& job,
     }
 
     if ((r = pd-pc) > 1)
-    {
-        MkqsJob<T> job(a + n-r, r, depth);
-        pQueue->push(job);
-        sem_post(pQueueSem);
-    }
+        subjobs[num_subjobs++] = MkqsJob<T>(a + n-r, r, depth);
 
-    // Unlock the mutex
-    pthread_mutex_unlock(pQueueMutex);
+    // Count the new jobs before they become visible to other threads
+    __sync_add_and_fetch(pNumPendingJobs, num_subjobs);
+    for(int i = 0; i < num_subjobs; ++i)
+        pDeque->push(subjobs[i]);
 }
 #endif
-